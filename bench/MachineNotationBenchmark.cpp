@@ -0,0 +1,131 @@
+#include "parser/MachineNotation.h"
+#include "parser/CodeParser.h"
+#include "project/Project.h"
+#include "project/ProjectManager.h"
+#include "model/TuringMachine.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFile>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Measures importing a corpus of random machines in the standard busy beaver
+// notation (100k 5-state 2-symbol machines by default) in machines per second:
+// straight into a machine, through generated code and CodeParser, and as a
+// project collection. Exporting each machine must give back its notation.
+
+namespace {
+
+std::string randomMachine(std::mt19937& random, int stateCount, int symbolCount)
+{
+    std::string text;
+    for (int state = 0; state < stateCount; ++state) {
+        if (state > 0) {
+            text += '_';
+        }
+        for (int symbol = 0; symbol < symbolCount; ++symbol) {
+            // One undefined transition in about every twenty
+            if (random() % 20 == 0) {
+                text += "---";
+                continue;
+            }
+            text += static_cast<char>('0' + random() % symbolCount);
+            text += random() % 2 ? 'R' : 'L';
+            text += static_cast<char>('A' + random() % stateCount);
+        }
+    }
+    return text;
+}
+
+double perSecond(size_t count, qint64 milliseconds)
+{
+    return count * 1000.0 / std::max<qint64>(1, milliseconds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int machineCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int stateCount = argc > 2 ? std::atoi(argv[2]) : 5;
+    int symbolCount = argc > 3 ? std::atoi(argv[3]) : 2;
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::fprintf(stderr, "Cannot create a temporary directory\n");
+        return 1;
+    }
+    QString corpusPath = directory.filePath("corpus.txt");
+
+    std::mt19937 random(1);
+    std::vector<std::string> machines;
+    std::string corpus;
+    for (int i = 0; i < machineCount; ++i) {
+        machines.push_back(randomMachine(random, stateCount, symbolCount));
+        corpus += std::to_string(i) + " " + machines.back() + "\n";
+    }
+
+    QFile file(corpusPath);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(corpus.data(), static_cast<qint64>(corpus.size())) != static_cast<qint64>(corpus.size())) {
+        std::fprintf(stderr, "Cannot write the corpus\n");
+        return 1;
+    }
+    file.close();
+
+    QElapsedTimer timer;
+    TuringMachine machine;
+
+    timer.start();
+    for (const std::string& text : machines) {
+        MachineNotation::parseStandard(text, machine);
+    }
+    qint64 direct = timer.elapsed();
+
+    // The same machines the way imported code used to reach them
+    std::vector<std::string> codes;
+    for (const std::string& text : machines) {
+        MachineNotation::parseStandard(text, machine);
+        codes.push_back(MachineNotation::toCode(machine));
+    }
+    timer.start();
+    for (const std::string& code : codes) {
+        machine.clear();
+        CodeParser().parseAndUpdateMachine(&machine, code);
+    }
+    qint64 parsed = timer.elapsed();
+
+    timer.start();
+    size_t skipped = 0;
+    std::vector<Project*> projects = ProjectManager::getInstance().importCorpus(corpusPath.toStdString(), &skipped);
+    qint64 imported = timer.elapsed();
+
+    size_t mismatches = 0;
+    timer.start();
+    for (size_t i = 0; i < projects.size(); ++i) {
+        std::string text;
+        if (!MachineNotation::writeStandard(*projects[i]->getMachine(), text) || text != machines[i]) {
+            mismatches++;
+        }
+    }
+    qint64 exported = timer.elapsed();
+
+    std::printf("%-20s %10s %14s\n", "Import", "ms", "Machines/s");
+    std::printf("%-20s %10lld %14.0f\n", "Notation", direct, perSecond(machines.size(), direct));
+    std::printf("%-20s %10lld %14.0f\n", "Code and parser", parsed, perSecond(machines.size(), parsed));
+    std::printf("%-20s %10lld %14.0f\n", "Corpus to projects", imported, perSecond(projects.size(), imported));
+    std::printf("%-20s %10lld %14.0f\n", "Export", exported, perSecond(projects.size(), exported));
+
+    if (skipped > 0 || projects.size() != machines.size() || mismatches > 0) {
+        std::fprintf(stderr, "%zu machines skipped, %zu exported differently\n", skipped, mismatches);
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "project/Project.h"
+#include "project/MachineCache.h"
+#include "project/ProjectJournal.h"
+#include "project/ProjectSaver.h"
+#include "document/CodeDocument.h"
+#include "document/TapeDocument.h"
+#include "model/TuringMachine.h"
+#include "model/Tape.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cstdio>
+#include <string>
+
+// Compares saving and loading a project in the binary and JSON formats
+// for a machine with stateCount * symbolCount transitions (1M by default),
+// and an incremental save of a one cell edit to the project's journal
+
+namespace {
+
+std::string generateCode(int stateCount, int symbolCount)
+{
+    std::string code = "s(q0, Start)\n";
+    for (int state = 0; state < stateCount; ++state) {
+        std::string from = "q" + std::to_string(state);
+        std::string to = "q" + std::to_string((state + 1) % stateCount);
+        for (int symbol = 0; symbol < symbolCount; ++symbol) {
+            std::string read = std::to_string(symbol);
+            code += "f(" + from + ", " + read + ") -> (" + to + ", " + read + ", R)\n";
+        }
+    }
+    return code;
+}
+
+double fileSizeMiB(const QString& path)
+{
+    return QFileInfo(path).size() / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int stateCount = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int symbolCount = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::fprintf(stderr, "Cannot create a temporary directory\n");
+        return 1;
+    }
+    QString binaryPath = directory.filePath("benchmark.tmproj");
+    QString jsonPath = directory.filePath("benchmark.json");
+
+    QElapsedTimer timer;
+
+    Project project("Benchmark");
+    std::string code = generateCode(stateCount, symbolCount);
+
+    timer.start();
+    project.getCodeDocument()->setCode(code);
+    std::printf("Compiled %zu transitions in %lld ms\n",
+                project.getMachine()->getAllTransitions().size(), timer.elapsed());
+
+    timer.start();
+    project.saveToFile(binaryPath.toStdString());
+    qint64 binarySave = timer.elapsed();
+
+    // Saving to the same file again only journals the change
+    project.getAllTapes().front()->getTape()->setCell(0, "1");
+    project.setModified(true);
+    timer.start();
+    project.getSaver()->save(binaryPath.toStdString());
+    project.getSaver()->waitForAllSaves();
+    qint64 journalSave = timer.elapsed();
+    QString journalPath = QString::fromStdString(ProjectJournal::pathFor(binaryPath.toStdString()));
+    std::printf("Journaled a one cell edit in %lld ms, %lld bytes\n", journalSave, QFileInfo(journalPath).size());
+
+    timer.start();
+    project.exportToJson(jsonPath.toStdString());
+    qint64 jsonSave = timer.elapsed();
+
+    timer.start();
+    auto binaryProject = Project::loadFromFile(binaryPath.toStdString());
+    qint64 binaryLoad = timer.elapsed();
+
+    // Measure the JSON path without help from the compiled machine cache
+    QFile::remove(QString::fromStdString(MachineCache::getInstance().getCacheDirectory() + "/" +
+                                         MachineCache::hashCode(code) + ".tmc"));
+
+    timer.start();
+    auto jsonProject = Project::loadFromFile(jsonPath.toStdString());
+    qint64 jsonLoad = timer.elapsed();
+
+    bool loaded = binaryProject && jsonProject &&
+                  binaryProject->getMachine()->getAllTransitions().size() ==
+                  jsonProject->getMachine()->getAllTransitions().size();
+
+    std::printf("%-8s %10s %10s %10s\n", "Format", "Save ms", "Load ms", "Size MiB");
+    std::printf("%-8s %10lld %10lld %10.1f\n", "Binary", binarySave, binaryLoad, fileSizeMiB(binaryPath));
+    std::printf("%-8s %10lld %10lld %10.1f\n", "JSON", jsonSave, jsonLoad, fileSizeMiB(jsonPath));
+
+    if (!loaded) {
+        std::fprintf(stderr, "Loaded projects do not match\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
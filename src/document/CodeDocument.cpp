@@ -1,16 +1,14 @@
 #include "CodeDocument.h"
 #include "../project/Project.h"
 #include "../model/TuringMachine.h"
-#include "../parser/CodeParser.h"
+#include "../parser/SourceFile.h"
+#include <QFileInfo>
+#include <QDir>
 #include <QDebug>
 
 CodeDocument::CodeDocument(Project* project, const std::string& name)
     : Document(project, DocumentType::CODE, name)
 {
-    // Initialize with the machine's code if available
-    if (project && project->getMachine()) {
-        m_code = project->getMachine()->getOriginalCode();
-    }
 }
 
 CodeDocument::~CodeDocument()
@@ -19,31 +17,102 @@ CodeDocument::~CodeDocument()
 
 std::string CodeDocument::getCode() const
 {
-    return m_code;
+    // The machine holds the text, so it is stored once however large it is
+    if (getProject() && getProject()->getMachine()) {
+        return getProject()->getMachine()->getOriginalCode();
+    }
+    return std::string();
 }
 
 void CodeDocument::setCode(const std::string& code)
 {
-    if (m_code != code) {
-        m_code = code;
+    if (!getProject() || !getProject()->getMachine()) {
+        return;
+    }
+
+    if (getProject()->getMachine()->getOriginalCode() != code) {
+        // Parse the code, link its modules and replace the machine
+        if (!compile(code)) {
+            qWarning() << "Failed to parse code";
+        }
 
-        // Update the machine with the new code
-        if (getProject() && getProject()->getMachine()) {
-            // Parse the code and update the machine
-            CodeParser parser;
-            bool success = parser.parseAndUpdateMachine(getProject()->getMachine(), code);
+        // Store the original code in the machine
+        TuringMachine* machine = getProject()->getMachine();
+        machine->setOriginalCode(code);
 
-            if (!success) {
-                qWarning() << "Failed to parse code";
-            }
+        // Mark the project as modified
+        getProject()->setModified(true);
 
-            // Store the original code in the machine
-            getProject()->getMachine()->setOriginalCode(code);
+        emit codeChanged(machine->getOriginalCode());
+    }
+}
 
-            // Mark the project as modified
-            getProject()->setModified(true);
-        }
+void CodeDocument::restoreCode(const std::string& code, const std::string& moduleHash)
+{
+    m_moduleHash = moduleHash;
+    m_diagnostics.clear();
+
+    TuringMachine* machine = getProject()->getMachine();
+    machine->setOriginalCode(code);
+
+    emit codeChanged(machine->getOriginalCode());
+}
+
+bool CodeDocument::loadFromFile(const std::string& path)
+{
+    if (!getProject() || !getProject()->getMachine()) {
+        return false;
+    }
+
+    SourceFile source;
+    if (!source.open(path)) {
+        return false;
+    }
+
+    // Modules declared by the file are relative to the file itself
+    m_sourceDirectory = QFileInfo(QString::fromStdString(path)).absolutePath().toStdString();
+
+    // Parse directly from the mapped file so no intermediate copy is made
+    if (!compile(source.getContents())) {
+        qWarning() << "Failed to parse code file:" << QString::fromStdString(path);
+        return false;
+    }
+
+    // The editor and the saved project still need the text, the machine keeps its only copy
+    TuringMachine* machine = getProject()->getMachine();
+    machine->setOriginalCode(std::string(source.getContents()));
+    getProject()->setModified(true);
+
+    emit codeChanged(machine->getOriginalCode());
+    return true;
+}
+
+std::string CodeDocument::getBaseDirectory() const
+{
+    if (!m_sourceDirectory.empty()) {
+        return m_sourceDirectory;
+    }
 
-        emit codeChanged(m_code);
+    // Otherwise modules live next to the project file
+    if (getProject() && !getProject()->getFilePath().empty()) {
+        return QFileInfo(QString::fromStdString(getProject()->getFilePath())).absolutePath().toStdString();
     }
+
+    return QDir::currentPath().toStdString();
+}
+
+bool CodeDocument::compile(std::string_view code)
+{
+    // A background save may be reading the current machine, so it is left
+    // as it is and a new one continues its run
+    TuringMachine* previous = getProject()->getMachine();
+    auto machine = std::make_shared<TuringMachine>(previous->getName(), previous->getType());
+
+    bool success = m_linker.linkAndUpdateMachine(machine.get(), code, getBaseDirectory());
+    m_diagnostics = m_linker.getDiagnostics();
+    m_moduleHash = m_linker.getModuleHash();
+
+    machine->takeOver(*previous);
+    getProject()->replaceMachine(std::move(machine));
+    return success;
 }
\ No newline at end of file
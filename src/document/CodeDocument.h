@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Document.h"
+#include "../parser/MachineLinker.h"
 #include <string>
+#include <vector>
 
 /**
  * Document representing the code for a Turing machine
@@ -18,9 +20,31 @@ public:
     std::string getCode() const;
     void setCode(const std::string& code);
 
+    // Set code the machine has already been compiled from, without reparsing
+    void restoreCode(const std::string& code, const std::string& moduleHash = "");
+
+    // Load code from a file on disk, parsing it straight from a memory mapping
+    bool loadFromFile(const std::string& path);
+
+    // Problems reported by the last parse, such as conflicting transitions
+    const std::vector<ParseDiagnostic>& getDiagnostics() const { return m_diagnostics; }
+
+    // Directory that module paths in m(name, path) are relative to
+    std::string getBaseDirectory() const;
+
+    // Hash of the module files the machine was linked with, empty without modules
+    std::string getModuleHash() const { return m_moduleHash; }
+
     signals:
         void codeChanged(const std::string& newCode);
 
 private:
-    std::string m_code;
+    std::vector<ParseDiagnostic> m_diagnostics;
+    std::string m_sourceDirectory;   // Set when the code was imported from a file
+    std::string m_moduleHash;
+
+    // Kept between applies so unchanged modules are not recompiled
+    MachineLinker m_linker;
+
+    bool compile(std::string_view code);
 };
\ No newline at end of file
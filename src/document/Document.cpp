@@ -2,8 +2,8 @@
 #include "../project/Project.h"
 #include <QUuid>
 
-Document::Document(Project* project, DocumentType type, const std::string& name)
-    : m_project(project), m_type(type), m_id(generateUniqueId()), m_name(name)
+Document::Document(Project* project, DocumentType type, const std::string& name, const std::string& id)
+    : m_project(project), m_type(type), m_id(id.empty() ? generateUniqueId() : id), m_name(name)
 {
 }
 
@@ -19,7 +19,9 @@ public:
         TAPE        // Tape visualization
     };
 
-    Document(Project* project, DocumentType type, const std::string& name = "Untitled");
+    // An empty id generates a unique one; documents restored from a file keep theirs
+    Document(Project* project, DocumentType type, const std::string& name = "Untitled",
+             const std::string& id = std::string());
     virtual ~Document();
 
     // Document properties
@@ -0,0 +1,87 @@
+#include "ExecutionNotifier.h"
+#include "../model/Tape.h"
+#include "../model/TuringMachine.h"
+#include <algorithm>
+
+ExecutionNotifier::ExecutionNotifier(const Tape* tape, QObject* parent)
+    : QObject(parent), m_tape(tape), m_machine(nullptr), m_pending(false)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &ExecutionNotifier::flush);
+}
+
+ExecutionNotifier::~ExecutionNotifier()
+{
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+}
+
+void ExecutionNotifier::attach(TuringMachine* machine)
+{
+    if (machine == m_machine) return;
+
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+    m_machine = machine;
+    m_machine->addObserver(this);
+}
+
+void ExecutionNotifier::changed()
+{
+    if (!m_pending) {
+        schedule();
+    }
+}
+
+void ExecutionNotifier::flush()
+{
+    m_timer.stop();
+    if (!m_pending) return;
+
+    const ExecutionDelta delta = m_delta;
+    m_delta = ExecutionDelta();
+    m_pending = false;
+    m_lastUpdate.start();
+    emit updated(delta);
+}
+
+void ExecutionNotifier::onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                               const Transition& transition)
+{
+    Q_UNUSED(readSymbol);
+    Q_UNUSED(transition);
+    if (machine.getTape() != m_tape) return;
+
+    m_delta.stepsTaken++;
+    m_delta.firstChangedCell = std::min(m_delta.firstChangedCell, position);
+    m_delta.lastChangedCell = std::max(m_delta.lastChangedCell, position);
+    if (!m_pending) {
+        schedule();
+    }
+}
+
+void ExecutionNotifier::onJump(const TuringMachine& machine)
+{
+    if (machine.getTape() != m_tape) return;
+
+    m_delta.jumped = true;
+    if (!m_pending) {
+        schedule();
+    }
+}
+
+void ExecutionNotifier::onReplaced(TuringMachine& replacement)
+{
+    m_machine = &replacement;
+}
+
+void ExecutionNotifier::schedule()
+{
+    // Right away after a quiet frame, else when the frame is over
+    m_pending = true;
+    const qint64 since = m_lastUpdate.isValid() ? m_lastUpdate.elapsed() : FrameInterval;
+    m_timer.start(static_cast<int>(std::max<qint64>(0, FrameInterval - since)));
+}
\ No newline at end of file
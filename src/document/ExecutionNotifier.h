@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <climits>
+#include <cstdint>
+
+#include "../model/ExecutionObserver.h"
+
+class Tape;
+
+// What the machine did on a tape since the last notification
+struct ExecutionDelta {
+    uint64_t stepsTaken = 0;
+    bool jumped = false;             // Reset, stepped back or moved along the timeline
+    int firstChangedCell = INT_MAX;  // Cells the steps wrote, first > last for none
+    int lastChangedCell = INT_MIN;
+
+    bool hasChangedCells() const { return firstChangedCell <= lastChangedCell; }
+};
+
+/**
+ * Collects what the machine does on one tape and reports it at most once
+ * per display frame, however many steps, jumps and status changes come in
+ * between. A step only widens the pending delta, so a fast run costs the
+ * views one update per frame rather than one per step. The first change
+ * after a quiet frame is reported as soon as the event loop gets to it.
+ */
+class ExecutionNotifier : public QObject, public ExecutionObserver
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FrameInterval = 16;
+
+    explicit ExecutionNotifier(const Tape* tape, QObject* parent = nullptr);
+    ~ExecutionNotifier() override;
+
+    void attach(TuringMachine* machine);
+
+    // Something the steps don't tell changed, e.g. the machine's status
+    void changed();
+
+    // Report what is pending now rather than with the next frame
+    void flush();
+
+    // ExecutionObserver
+    void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                const Transition& transition) override;
+    void onJump(const TuringMachine& machine) override;
+    void onReplaced(TuringMachine& replacement) override;
+
+signals:
+    void updated(const ExecutionDelta& delta);
+
+private:
+    const Tape* m_tape;
+    TuringMachine* m_machine;
+    ExecutionDelta m_delta;
+    bool m_pending;
+    QTimer m_timer;
+    QElapsedTimer m_lastUpdate;
+
+    void schedule();
+};
\ No newline at end of file
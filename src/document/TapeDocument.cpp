@@ -1,25 +1,103 @@
 #include "TapeDocument.h"
 #include "../project/Project.h"
+#include "../project/ProjectFile.h"
+#include "../project/ProjectSaver.h"
 #include "../model/TuringMachine.h"
 #include "../model/Tape.h"
+#include "../model/TapeHeatmap.h"
+#include "../model/RunTimeline.h"
+#include "../trace/TraceRecorder.h"
+#include <QByteArray>
 #include <QDebug>
 
 TapeDocument::TapeDocument(Project* project, const std::string& id, const std::string& name)
-    : Document(project, DocumentType::TAPE, name),
-      m_initialHeadPosition(0)
+    : Document(project, DocumentType::TAPE, name, id),
+      m_storedCellCount(0), m_initialHeadPosition(0)
 {
     // Create a new tape
     m_tape = std::make_unique<Tape>();
+    m_heatmap = std::make_unique<TapeHeatmap>();
+    m_timeline = std::make_unique<RunTimeline>(m_tape.get(), m_heatmap.get());
+
+    // Steps are reported in batches, not one signal each
+    m_notifier = std::make_unique<ExecutionNotifier>(m_tape.get());
+    connect(m_notifier.get(), &ExecutionNotifier::updated, this, &TapeDocument::executionStateChanged);
 }
 
 TapeDocument::~TapeDocument()
 {
+    stopTrace();
+}
+
+Tape* TapeDocument::getTape() const
+{
+    if (m_source) {
+        // A save replaces the tape's file only as it finishes, then relocates
+        // the tape, so a read that fails meanwhile is tried once more after it
+        QByteArray data;
+        bool read = ProjectFile::readTapeData(*m_source, data);
+        if (!read && getProject() && getProject()->getSaver()->isSaving()) {
+            getProject()->getSaver()->waitForCurrentSave();
+            read = ProjectFile::readTapeData(*m_source, data);
+        }
+
+        // Failing leaves the tape blank, so the project can still be saved
+        std::shared_ptr<const TapeSource> source = std::move(m_source);
+        m_source.reset();
+        if (!read || !ProjectFile::decodeTape(data, *m_tape)) {
+            qWarning() << "Failed to load tape" << QString::fromStdString(getName())
+                       << "from" << QString::fromStdString(source->path);
+        }
+    }
+
+    return m_tape.get();
+}
+
+void TapeDocument::setStoredTape(std::shared_ptr<const TapeSource> source, int headPosition, uint32_t cellCount)
+{
+    m_source = std::move(source);
+    m_storedCellCount = cellCount;
+    m_tape->setHeadPosition(headPosition);
+}
+
+uint32_t TapeDocument::getCellCount() const
+{
+    if (m_source) {
+        return m_storedCellCount;
+    }
+
+    uint32_t count = 0;
+    m_tape->forEachRun([&count](int, int length, const std::string&) {
+        count += static_cast<uint32_t>(length);
+    });
+    return count;
+}
+
+int TapeDocument::getHeadPosition() const
+{
+    // Known from the index, so stored tapes need not be read
+    return m_tape->getHeadPosition();
+}
+
+void TapeDocument::setHeadPosition(int position)
+{
+    m_tape->setHeadPosition(position);
+}
+
+void TapeDocument::relocate(std::shared_ptr<const TapeSource> source)
+{
+    if (m_source) {
+        m_source = std::move(source);
+    }
 }
 
 void TapeDocument::setInitialContent(const std::string& content)
 {
     m_initialContent = content;
+    m_source.reset();  // Replaced, so a stored tape need not be read
     m_tape->setInitialContent(content);
+    m_heatmap->clear();
+    m_timeline->clear();
 
     qDebug() << "Setting tape content to:" << &m_tape << " " << content;
 
@@ -33,7 +111,8 @@ void TapeDocument::setInitialContent(const std::string& content)
 void TapeDocument::setInitialHeadPosition(int position)
 {
     m_initialHeadPosition = position;
-    m_tape->setHeadPosition(position);
+    getTape()->setHeadPosition(position);
+    m_timeline->clear();
 
     if (getProject()) {
         getProject()->setModified(true);
@@ -51,10 +130,12 @@ bool TapeDocument::step()
 
     // Set the active tape in the machine
     TuringMachine* machine = getProject()->getMachine();
-    Tape* tape = m_tape.get();
+    Tape* tape = getTape();
 
     // Create a temporary link to our tape
-    machine->setTape(tape);
+    machine->setTape(tape, m_heatmap.get());
+    m_timeline->attach(machine);
+    m_notifier->attach(machine);
 
     // Execute a step
     bool success = machine->step();
@@ -64,10 +145,35 @@ bool TapeDocument::step()
         machine->pause();
     }
 
-    emit executionStateChanged();
+    // The tape and run state are saved with the project
+    if (success) {
+        getProject()->setModified(true);
+    }
+
+    m_notifier->changed();
     return success;
 }
 
+uint64_t TapeDocument::runSteps(uint64_t count)
+{
+    if (!getProject() || !getProject()->getMachine()) {
+        return 0;
+    }
+
+    TuringMachine* machine = getProject()->getMachine();
+    machine->setTape(getTape(), m_heatmap.get());
+    m_timeline->attach(machine);
+    m_notifier->attach(machine);
+
+    uint64_t taken = machine->runSteps(count);
+    if (taken > 0) {
+        getProject()->setModified(true);
+    }
+
+    m_notifier->changed();
+    return taken;
+}
+
 void TapeDocument::reset()
 {
     if (!getProject() || !getProject()->getMachine()) {
@@ -77,12 +183,15 @@ void TapeDocument::reset()
     TuringMachine* machine = getProject()->getMachine();
 
     // Set the active tape in the machine
-    machine->setTape(m_tape.get());
+    machine->setTape(getTape(), m_heatmap.get());
 
-    // Reset the machine
+    // Reset the machine, which starts the timeline over
+    m_timeline->attach(machine);
+    m_notifier->attach(machine);
     machine->reset();
+    getProject()->setModified(true);
 
-    emit executionStateChanged();
+    m_notifier->changed();
 }
 
 void TapeDocument::run()
@@ -94,12 +203,12 @@ void TapeDocument::run()
     TuringMachine* machine = getProject()->getMachine();
 
     // Set the active tape in the machine
-    machine->setTape(m_tape.get());
+    machine->setTape(getTape(), m_heatmap.get());
 
     // Set the status to running
     machine->run();
 
-    emit executionStateChanged();
+    m_notifier->changed();
 }
 
 void TapeDocument::pause()
@@ -111,12 +220,12 @@ void TapeDocument::pause()
     TuringMachine* machine = getProject()->getMachine();
 
     // Set the active tape in the machine
-    machine->setTape(m_tape.get());
+    machine->setTape(getTape(), m_heatmap.get());
 
     // Pause the machine
     machine->pause();
 
-    emit executionStateChanged();
+    m_notifier->changed();
 }
 
 bool TapeDocument::canStepBackward() const
@@ -125,7 +234,11 @@ bool TapeDocument::canStepBackward() const
         return false;
     }
 
-    return getProject()->getMachine()->canStepBackward();
+    // The machine may be on another tape, the timeline only follows this one
+    const TuringMachine* machine = getProject()->getMachine();
+    return machine->getTape() == m_tape.get() &&
+           (machine->canStepBackward() ||
+            (!m_timeline->isEmpty() && machine->getStepCount() > m_timeline->getFirstStep()));
 }
 
 bool TapeDocument::stepBackward()
@@ -137,11 +250,73 @@ bool TapeDocument::stepBackward()
     TuringMachine* machine = getProject()->getMachine();
 
     // Set the active tape in the machine
-    machine->setTape(m_tape.get());
+    machine->setTape(getTape(), m_heatmap.get());
+    m_timeline->attach(machine);
+    m_notifier->attach(machine);
+
+    // Step backward, from a keyframe once the undo history runs out
+    bool success = false;
+    if (machine->canStepBackward()) {
+        success = machine->stepBackward();
+    } else if (machine->getStepCount() > 0) {
+        success = m_timeline->seek(machine->getStepCount() - 1);
+    }
+    if (success) {
+        getProject()->setModified(true);
+    }
 
-    // Step backward
-    bool success = machine->stepBackward();
+    m_notifier->changed();
+    return success;
+}
 
-    emit executionStateChanged();
+bool TapeDocument::seek(uint64_t step)
+{
+    if (!getProject() || !getProject()->getMachine()) {
+        return false;
+    }
+
+    TuringMachine* machine = getProject()->getMachine();
+    machine->setTape(getTape(), m_heatmap.get());
+    m_timeline->attach(machine);
+    m_notifier->attach(machine);
+
+    bool success = m_timeline->seek(step);
+    if (success) {
+        getProject()->setModified(true);
+    }
+
+    m_notifier->changed();
     return success;
+}
+
+bool TapeDocument::startTrace(const std::string& path)
+{
+    if (!getProject() || !getProject()->getMachine()) {
+        return false;
+    }
+
+    TuringMachine* machine = getProject()->getMachine();
+
+    // The trace starts from this tape's current configuration
+    machine->setTape(getTape(), m_heatmap.get());
+
+    if (!m_traceRecorder) {
+        m_traceRecorder = std::make_unique<TraceRecorder>();
+    }
+    return m_traceRecorder->start(path, *machine, *getTape());
+}
+
+bool TapeDocument::stopTrace()
+{
+    return m_traceRecorder && m_traceRecorder->isRecording() && m_traceRecorder->finish();
+}
+
+bool TapeDocument::isTracing() const
+{
+    return m_traceRecorder && m_traceRecorder->isRecording();
+}
+
+uint64_t TapeDocument::getTracedStepCount() const
+{
+    return m_traceRecorder ? m_traceRecorder->getStepCount() : 0;
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #pragma once
 
 #include "Document.h"
+#include "ExecutionNotifier.h"
+#include <cstdint>
 #include <memory>
 #include <string>
 
 class Tape;
+class TapeHeatmap;
+class RunTimeline;
+class TraceRecorder;
+struct TapeSource;
 
 /**
  * Document representing a tape for visualization and simulation
@@ -17,8 +23,26 @@ public:
     TapeDocument(Project* project, const std::string& id, const std::string& name = "Tape");
     ~TapeDocument() override;
 
-    // Tape access
-    Tape* getTape() const { return m_tape.get(); }
+    // Tape access, reads a stored tape from the project file on first use
+    Tape* getTape() const;
+
+    // Tapes of an opened project stay in the file until they are used
+    void setStoredTape(std::shared_ptr<const TapeSource> source, int headPosition, uint32_t cellCount);
+    bool isLoaded() const { return !m_source; }
+    const std::shared_ptr<const TapeSource>& getSource() const { return m_source; }
+    uint32_t getCellCount() const;
+    int getHeadPosition() const;
+    void setHeadPosition(int position);  // Leaves a stored tape in the file
+
+    // Follow a stored tape to the copy of it in a newly written file
+    void relocate(std::shared_ptr<const TapeSource> source);
+
+    // Visits and writes of each cell during the current run
+    const TapeHeatmap* getHeatmap() const { return m_heatmap.get(); }
+
+    // Keyframes of the run on this tape, for previewing and seeking its steps
+    RunTimeline* getTimeline() { return m_timeline.get(); }
+    const RunTimeline* getTimeline() const { return m_timeline.get(); }
 
     // Tape configuration
     void setInitialContent(const std::string& content);
@@ -26,18 +50,32 @@ public:
 
     // Execution methods
     bool step();
+    uint64_t runSteps(uint64_t count);  // Many steps with a single notification, returns the steps taken
     void reset();
     void run();
     void pause();
     bool canStepBackward() const;
     bool stepBackward();
+    bool seek(uint64_t step);  // To any step of the run, see RunTimeline
+
+    // Record every step taken on this tape to a trace file
+    bool startTrace(const std::string& path);
+    bool stopTrace();
+    bool isTracing() const;
+    uint64_t getTracedStepCount() const;
 
     signals:
         void tapeContentChanged();
-    void executionStateChanged();
+    void executionStateChanged(const ExecutionDelta& delta);  // At most once per frame, see ExecutionNotifier
 
 private:
     std::unique_ptr<Tape> m_tape;
+    std::unique_ptr<TapeHeatmap> m_heatmap;
+    std::unique_ptr<RunTimeline> m_timeline;
+    std::unique_ptr<ExecutionNotifier> m_notifier;
+    mutable std::shared_ptr<const TapeSource> m_source;
+    uint32_t m_storedCellCount;
     std::string m_initialContent;
     int m_initialHeadPosition;
+    std::unique_ptr<TraceRecorder> m_traceRecorder;
 };
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+class TuringMachine;
+class Transition;
+
+/**
+ * Receives execution events from a TuringMachine, e.g. to record a trace.
+ * Observers are not owned by the machine and are called on its thread.
+ */
+class ExecutionObserver {
+public:
+    virtual ~ExecutionObserver() = default;
+
+    // A transition was taken after reading readSymbol at position, the cell
+    // it wrote; the tape, head and current state already reflect the step
+    virtual void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                        const Transition& transition) = 0;
+
+    // The configuration changed other than by a step: reset, step backward,
+    // a different tape or a restored state
+    virtual void onJump(const TuringMachine& machine) = 0;
+
+    // The machine was replaced by one compiled from new code, which has
+    // taken over its run and observers; see TuringMachine::takeOver
+    virtual void onReplaced(TuringMachine& replacement) = 0;
+};
\ No newline at end of file
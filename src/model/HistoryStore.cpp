@@ -0,0 +1,323 @@
+#include "HistoryStore.h"
+
+#include <algorithm>
+#include <QTemporaryFile>
+#include <qdebug.h>
+
+using BinaryIO::appendVarint;
+using BinaryIO::zigzagDecode;
+using BinaryIO::zigzagEncode;
+
+namespace {
+
+// Dead space at the start of the spill file is reclaimed once it is at
+// least this large and larger than what is still in use
+constexpr size_t MinCompactionSize = 1 << 20;
+
+} // namespace
+
+HistoryStore::HistoryStore(size_t capacity)
+    : m_capacity(capacity), m_size(0), m_segmentBytes(0), m_spilled(0), m_diskBytes(0),
+      m_memoryLimit(DefaultMemoryLimit), m_diskLimit(DefaultDiskLimit)
+{
+}
+
+HistoryStore::~HistoryStore() = default;
+
+HistoryStore::HistoryStore(HistoryStore&& other) noexcept = default;
+HistoryStore& HistoryStore::operator=(HistoryStore&& other) noexcept = default;
+
+void HistoryStore::push(const HistoryStep& step)
+{
+    m_hot.push_back(Record{step.headPosition, m_strings.add(step.symbols), m_strings.add(step.state)});
+    m_size++;
+
+    // Keep at least a segment's worth uncompressed so stepping back and
+    // forth around the current step never has to unpack anything
+    if (m_hot.size() >= 2 * SegmentSize) {
+        compressOldest();
+        enforceLimits();
+    }
+
+    trim();
+}
+
+bool HistoryStore::pop(HistoryStep& step)
+{
+    if (m_hot.empty() && !decompressNewest()) {
+        return false;
+    }
+
+    const Record& record = m_hot.back();
+    const std::vector<std::string>& strings = m_strings.strings();
+    step.headPosition = record.headPosition;
+    step.symbols = strings[record.symbols];
+    step.state = strings[record.state];
+
+    m_hot.pop_back();
+    m_size--;
+    return true;
+}
+
+void HistoryStore::truncate(size_t count)
+{
+    if (count >= m_size) {
+        clear();
+        return;
+    }
+
+    while (count > 0) {
+        if (!m_hot.empty()) {
+            const size_t dropped = std::min(count, m_hot.size());
+            m_hot.erase(m_hot.end() - static_cast<std::ptrdiff_t>(dropped), m_hot.end());
+            m_size -= dropped;
+            count -= dropped;
+            continue;
+        }
+
+        Segment& newest = m_segments.back();
+        if (newest.count > count) {
+            // Only part of it goes, the rest is unpacked to stay
+            if (!decompressNewest()) {
+                return;
+            }
+            continue;
+        }
+
+        count -= newest.count;
+        m_size -= newest.count;
+        if (newest.offset < 0) {
+            m_segmentBytes -= newest.size;
+        } else {
+            m_diskBytes -= newest.size;
+            m_spilled--;
+        }
+        m_segments.pop_back();
+
+        if (m_spilled == 0) {
+            m_spill.reset();
+        } else if (m_segments.size() == m_spilled) {
+            m_spill->resize(m_segments.back().offset + m_segments.back().size);
+        }
+    }
+}
+
+void HistoryStore::clear()
+{
+    m_hot.clear();
+    m_segments.clear();
+    m_segmentBytes = 0;
+    m_size = 0;
+    m_strings = BinaryIO::StringTableBuilder();
+
+    m_spill.reset();
+    m_spilled = 0;
+    m_diskBytes = 0;
+}
+
+void HistoryStore::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    trim();
+}
+
+void HistoryStore::setLimits(size_t memoryBytes, size_t diskBytes)
+{
+    m_memoryLimit = memoryBytes;
+    m_diskLimit = diskBytes;
+    enforceLimits();
+}
+
+size_t HistoryStore::byteSize() const
+{
+    size_t bytes = m_hot.size() * sizeof(Record) + m_segments.size() * sizeof(Segment) + m_segmentBytes;
+    for (const std::string& text : m_strings.strings()) {
+        bytes += sizeof(std::string) + text.capacity();
+    }
+    return bytes;
+}
+
+void HistoryStore::compressOldest()
+{
+    // Heads move a cell at a time, so the deltas mostly fit in one byte
+    // before zlib even sees them
+    QByteArray encoded;
+    encoded.reserve(static_cast<int>(SegmentSize * 3));
+    int previousHead = 0;
+    for (size_t i = 0; i < SegmentSize; ++i) {
+        const Record& record = m_hot[i];
+        appendVarint(encoded, zigzagEncode(static_cast<int64_t>(record.headPosition) - previousHead));
+        appendVarint(encoded, record.symbols);
+        appendVarint(encoded, record.state);
+        previousHead = record.headPosition;
+    }
+
+    Segment segment;
+    segment.data = qCompress(encoded);
+    segment.count = static_cast<uint32_t>(SegmentSize);
+    segment.size = static_cast<uint32_t>(segment.data.size());
+    segment.offset = -1;
+
+    m_segmentBytes += segment.size;
+    m_segments.push_back(std::move(segment));
+    m_hot.erase(m_hot.begin(), m_hot.begin() + SegmentSize);
+}
+
+bool HistoryStore::decompressNewest()
+{
+    if (m_segments.empty()) {
+        return false;
+    }
+
+    // Once every segment in memory is used up, the newest spilled one is next
+    if (m_segments.size() == m_spilled && !readBack(m_segments.back())) {
+        qWarning() << "Discarding history that could not be read back from disk";
+        clear();
+        return false;
+    }
+
+    Segment segment = std::move(m_segments.back());
+    m_segments.pop_back();
+    m_segmentBytes -= segment.size;
+
+    QByteArray encoded = qUncompress(segment.data);
+    BinaryIO::BinaryReader reader(encoded.constData(), encoded.size());
+    const size_t stringCount = m_strings.strings().size();
+    int64_t head = 0;
+    for (uint32_t i = 0; i < segment.count && reader.ok(); ++i) {
+        head += zigzagDecode(reader.readVarint());
+        uint64_t symbols = reader.readVarint();
+        uint64_t state = reader.readVarint();
+        if (symbols >= stringCount || state >= stringCount) {
+            break;
+        }
+        m_hot.push_back(Record{static_cast<int>(head), static_cast<uint32_t>(symbols), static_cast<uint32_t>(state)});
+    }
+
+    if (m_hot.size() != segment.count || !reader.ok()) {
+        // Older steps can't be undone without the ones in between
+        qWarning() << "Discarding history that could not be decompressed";
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void HistoryStore::trim()
+{
+    while (m_size > m_capacity) {
+        if (m_segments.empty()) {
+            m_hot.pop_front();
+            m_size--;
+        } else if (m_size - m_segments.front().count >= m_capacity) {
+            dropOldest();
+        } else {
+            break;
+        }
+    }
+}
+
+void HistoryStore::enforceLimits()
+{
+    // Spill the oldest segments still in memory, or lose them if they can't be
+    while (m_hot.size() * sizeof(Record) + m_segmentBytes > m_memoryLimit && m_spilled < m_segments.size()) {
+        if (m_diskBytes + m_segments[m_spilled].size > m_diskLimit || !spill(m_segments[m_spilled])) {
+            dropOldest();
+        }
+    }
+
+    while (m_diskBytes > m_diskLimit && m_spilled > 0) {
+        dropOldest();
+    }
+}
+
+bool HistoryStore::spill(Segment& segment)
+{
+    if (!m_spill) {
+        m_spill = std::make_unique<QTemporaryFile>();
+        if (!m_spill->open()) {
+            qWarning() << "Cannot create a file for the execution history";
+            m_spill.reset();
+            return false;
+        }
+    }
+
+    int64_t offset = m_spilled > 0 ? m_segments[m_spilled - 1].offset + m_segments[m_spilled - 1].size : 0;
+    if (!m_spill->seek(offset) || m_spill->write(segment.data) != static_cast<qint64>(segment.size)) {
+        qWarning() << "Cannot write the execution history to" << m_spill->fileName();
+        return false;
+    }
+
+    m_segmentBytes -= segment.size;
+    m_diskBytes += segment.size;
+    segment.data = QByteArray();
+    segment.offset = offset;
+    m_spilled++;
+    return true;
+}
+
+bool HistoryStore::readBack(Segment& segment)
+{
+    if (!m_spill || !m_spill->seek(segment.offset)) {
+        return false;
+    }
+
+    segment.data = m_spill->read(segment.size);
+    if (segment.data.size() != segment.size) {
+        return false;
+    }
+
+    m_segmentBytes += segment.size;
+    m_diskBytes -= segment.size;
+    segment.offset = -1;
+    m_spilled--;
+
+    if (m_spilled == 0) {
+        m_spill.reset();
+    } else {
+        m_spill->resize(m_segments[m_spilled - 1].offset + m_segments[m_spilled - 1].size);
+    }
+    return true;
+}
+
+void HistoryStore::dropOldest()
+{
+    Segment& oldest = m_segments.front();
+    m_size -= oldest.count;
+    if (oldest.offset < 0) {
+        m_segmentBytes -= oldest.size;
+    } else {
+        m_diskBytes -= oldest.size;
+        m_spilled--;
+    }
+    m_segments.pop_front();
+
+    if (m_spilled == 0) {
+        m_spill.reset();
+    } else if (static_cast<size_t>(m_segments.front().offset) >= std::max(m_diskBytes, MinCompactionSize)) {
+        compactSpill();
+    }
+}
+
+void HistoryStore::compactSpill()
+{
+    // Move what is still in use to the start of the file. The space before it
+    // is at least as large, so nothing is overwritten before it was moved.
+    const int64_t start = m_segments.front().offset;
+    const int64_t chunk = 1 << 20;
+    for (int64_t moved = 0; moved < static_cast<int64_t>(m_diskBytes); moved += chunk) {
+        if (!m_spill->seek(start + moved)) {
+            return;
+        }
+        QByteArray data = m_spill->read(chunk);
+        if (!m_spill->seek(moved) || m_spill->write(data) != data.size()) {
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < m_spilled; ++i) {
+        m_segments[i].offset -= start;
+    }
+    m_spill->resize(static_cast<qint64>(m_diskBytes));
+}
\ No newline at end of file
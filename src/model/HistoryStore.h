@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <QByteArray>
+#include "../project/BinaryIO.h"
+
+class QTemporaryFile;
+
+// What a step changed, enough to undo it: where the head was, the symbols it
+// read there and the state it was in
+struct HistoryStep {
+    int headPosition = 0;
+    std::string symbols;
+    std::string state;
+};
+
+/**
+ * Undo history of a running machine, one small record per step instead of a
+ * copy of the tape, kept in three tiers. The newest steps are kept as they
+ * are, older ones are packed into segments compressed with qCompress, and
+ * once those outgrow the memory limit the oldest segments are spilled to a
+ * temporary file. Stepping backward unpacks or reads a segment back only
+ * when it reaches it. Steps beyond the capacity or the disk limit are
+ * dropped, the oldest segment as a whole once it is entirely beyond them.
+ */
+class HistoryStore
+{
+public:
+    // Steps per compressed segment
+    static constexpr size_t SegmentSize = 4096;
+
+    // Until the preferences set others
+    static constexpr size_t DefaultMemoryLimit = size_t(64) << 20;
+    static constexpr size_t DefaultDiskLimit = size_t(1) << 30;
+
+    explicit HistoryStore(size_t capacity = 0);
+    ~HistoryStore();
+
+    HistoryStore(HistoryStore&& other) noexcept;
+    HistoryStore& operator=(HistoryStore&& other) noexcept;
+
+    void push(const HistoryStep& step);
+    bool pop(HistoryStep& step);  // Newest step, false when empty
+    void truncate(size_t count);  // Drop the newest steps, whole segments without unpacking them
+    void clear();
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    size_t capacity() const { return m_capacity; }
+    void setCapacity(size_t capacity);
+
+    // Bytes held in memory, beyond which segments are spilled, and bytes
+    // spilled to disk, beyond which the oldest steps are dropped
+    void setLimits(size_t memoryBytes, size_t diskBytes);
+    size_t memoryLimit() const { return m_memoryLimit; }
+    size_t diskLimit() const { return m_diskLimit; }
+
+    // Approximate memory held, compressed segments at their compressed size
+    size_t byteSize() const;
+    size_t diskSize() const { return m_diskBytes; }
+
+private:
+    struct Record {
+        int headPosition;
+        uint32_t symbols;  // Indices into m_strings
+        uint32_t state;
+    };
+
+    struct Segment {
+        QByteArray data;  // qCompress of the varint encoded records, empty once spilled
+        uint32_t count;
+        uint32_t size;    // Of the compressed data
+        int64_t offset;   // In the spill file, -1 while in memory
+    };
+
+    size_t m_capacity;
+    size_t m_size;
+    std::deque<Record> m_hot;       // Newest steps, oldest first
+    std::deque<Segment> m_segments; // Older steps, oldest segment first
+    size_t m_segmentBytes;          // Compressed segments still in memory
+
+    // Spilled segments are always the oldest ones and lie in the file in
+    // order, so the file is only ever appended to or cut at either end
+    std::unique_ptr<QTemporaryFile> m_spill;
+    size_t m_spilled;      // Leading segments that are on disk
+    size_t m_diskBytes;    // From the first spilled segment to the end of the file
+    size_t m_memoryLimit;
+    size_t m_diskLimit;
+
+    // Symbols and state names, shared by all records
+    BinaryIO::StringTableBuilder m_strings;
+
+    void compressOldest();
+    bool decompressNewest();
+    void trim();
+
+    void enforceLimits();
+    bool spill(Segment& segment);
+    bool readBack(Segment& segment);
+    void dropOldest();
+    void compactSpill();
+};
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "RunTimeline.h"
+#include "TuringMachine.h"
+
+#include <algorithm>
+
+RunTimeline::RunTimeline(Tape* tape, TapeHeatmap* heatmap)
+    : m_machine(nullptr), m_tape(tape), m_heatmap(heatmap), m_interval(InitialInterval),
+      m_end(0), m_position(0), m_seeking(false), m_previewStep(0), m_previewValid(false)
+{
+}
+
+RunTimeline::~RunTimeline()
+{
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+}
+
+void RunTimeline::attach(TuringMachine* machine)
+{
+    if (machine != m_machine) {
+        if (m_machine) {
+            m_machine->removeObserver(this);
+        }
+        m_machine = machine;
+        m_machine->addObserver(this);
+        clear();
+    }
+
+    if (m_keyframes.empty() && m_machine->getTape() == m_tape) {
+        start(*m_machine);
+    }
+}
+
+void RunTimeline::clear()
+{
+    m_keyframes.clear();
+    m_events.clear();
+    m_interval = InitialInterval;
+    m_end = 0;
+    m_position = 0;
+    m_previewValid = false;
+}
+
+void RunTimeline::setMarkedStates(const std::set<std::string>& states)
+{
+    m_markedStates = states;
+    m_events.erase(std::remove_if(m_events.begin(), m_events.end(),
+                                  [](const Event& event) { return event.type == EventType::MARKED; }),
+                   m_events.end());
+    if (m_markedStates.empty() || m_keyframes.empty()) {
+        return;
+    }
+
+    // Entries before the marks were set were never looked at
+    Tape tape = m_keyframes.front().tape;
+    std::string state = m_keyframes.front().state;
+    std::string previous = state;
+    for (uint64_t step = m_keyframes.front().step; step < m_end && m_events.size() < MaxEvents; ++step) {
+        if (m_machine->replay(tape, nullptr, state, 1) == 0) {
+            break;
+        }
+        if (state != previous) {
+            if (m_markedStates.count(state)) {
+                m_events.push_back(Event{step + 1, EventType::MARKED});
+            }
+            previous = state;
+        }
+    }
+
+    std::stable_sort(m_events.begin(), m_events.end(),
+                     [](const Event& a, const Event& b) { return a.step < b.step; });
+}
+
+bool RunTimeline::preview(uint64_t step)
+{
+    if (m_keyframes.empty() || step < getFirstStep() || step > m_end) {
+        return false;
+    }
+
+    // Moving forward continues from the last preview, unless a keyframe is closer
+    const Keyframe& key = keyframeBefore(step);
+    if (!m_previewValid || m_previewStep > step || m_previewStep < key.step) {
+        m_previewTape = key.tape;
+        m_previewHeatmap = key.heatmap;
+        m_previewState = key.state;
+        m_previewStep = key.step;
+    }
+
+    m_previewStep += m_machine->replay(m_previewTape, &m_previewHeatmap, m_previewState, step - m_previewStep);
+    m_previewValid = true;
+    return m_previewStep == step;
+}
+
+bool RunTimeline::seek(uint64_t step)
+{
+    if (!m_machine || m_machine->getTape() != m_tape || m_keyframes.empty() ||
+        step < getFirstStep() || step > m_end) {
+        return false;
+    }
+
+    const uint64_t current = m_machine->getStepCount();
+    if (step == current) {
+        return true;
+    }
+
+    // From the current configuration when it is on the way, so undo history is kept
+    m_seeking = true;
+    const Keyframe& key = keyframeBefore(step);
+    if (step < current || key.step > current) {
+        *m_tape = key.tape;
+        if (m_heatmap) {
+            *m_heatmap = key.heatmap;
+        }
+        m_machine->jumpTo(key.step, key.state);
+    }
+
+    m_position = m_machine->getStepCount();
+    m_lastState = m_machine->getCurrentState();
+    m_machine->runSteps(step - m_position);
+    m_seeking = false;
+
+    return m_position == step;
+}
+
+void RunTimeline::onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                         const Transition& transition)
+{
+    if (&machine != m_machine || machine.getTape() != m_tape || m_keyframes.empty()) {
+        return;
+    }
+
+    const uint64_t step = machine.getStepCount();
+    if (step != m_position + 1) {
+        start(machine);
+        return;
+    }
+    m_position = step;
+
+    const std::string state = machine.getCurrentState();
+    const uint64_t offset = step - m_keyframes.front().step;
+    if (offset % m_interval == 0 && offset / m_interval < m_keyframes.size()) {
+        // Going over the run again, it should still be the same one
+        const Keyframe& key = m_keyframes[static_cast<size_t>(offset / m_interval)];
+        if (key.state != state || key.tape.getHeadPosition() != m_tape->getHeadPosition()) {
+            cut(step - 1);
+        }
+    }
+
+    if (step > m_end) {
+        m_end = step;
+        if (state != m_lastState) {
+            addEvent(machine, step, state);
+        }
+        if (offset % m_interval == 0) {
+            addKeyframe(step, state);
+        }
+    }
+
+    if (state != m_lastState) {
+        m_lastState = state;
+    }
+}
+
+void RunTimeline::onJump(const TuringMachine& machine)
+{
+    if (m_seeking || &machine != m_machine || machine.getTape() != m_tape || m_keyframes.empty()) {
+        return;
+    }
+
+    // A step back along the run keeps what is after it
+    const uint64_t step = machine.getStepCount();
+    if (step + 1 == m_position && step >= getFirstStep()) {
+        m_position = step;
+        m_lastState = machine.getCurrentState();
+        return;
+    }
+
+    start(machine);
+}
+
+void RunTimeline::onReplaced(TuringMachine& replacement)
+{
+    // The run goes on in the replacement, so its keyframes still hold
+    m_machine = &replacement;
+}
+
+void RunTimeline::start(const TuringMachine& machine)
+{
+    clear();
+    m_end = m_position = machine.getStepCount();
+    m_lastState = machine.getCurrentState();
+    addKeyframe(m_end, m_lastState);
+}
+
+void RunTimeline::cut(uint64_t step)
+{
+    while (m_keyframes.size() > 1 && m_keyframes.back().step > step) {
+        m_keyframes.pop_back();
+    }
+    m_events.erase(std::find_if(m_events.begin(), m_events.end(),
+                                [step](const Event& event) { return event.step > step; }),
+                   m_events.end());
+    m_end = std::min(m_end, step);
+    m_previewValid = false;
+}
+
+void RunTimeline::thin()
+{
+    // Keep the first keyframe and every other one after it
+    std::deque<Keyframe> kept;
+    for (size_t i = 0; i < m_keyframes.size(); i += 2) {
+        kept.push_back(std::move(m_keyframes[i]));
+    }
+    m_keyframes.swap(kept);
+    m_interval *= 2;
+    m_previewValid = false;
+}
+
+void RunTimeline::addKeyframe(uint64_t step, const std::string& state)
+{
+    m_keyframes.push_back(Keyframe{step, state, *m_tape, m_heatmap ? *m_heatmap : TapeHeatmap()});
+    if (m_keyframes.size() > MaxKeyframes) {
+        thin();
+    }
+}
+
+void RunTimeline::addEvent(const TuringMachine& machine, uint64_t step, const std::string& state)
+{
+    const State* entered = machine.getState(state);
+    if (entered && entered->isAcceptState()) {
+        m_events.push_back(Event{step, EventType::ACCEPT});
+    } else if (entered && entered->isRejectState()) {
+        m_events.push_back(Event{step, EventType::REJECT});
+    } else if (!m_markedStates.empty() && m_markedStates.count(state) && m_events.size() < MaxEvents) {
+        m_events.push_back(Event{step, EventType::MARKED});
+    }
+}
+
+const RunTimeline::Keyframe& RunTimeline::keyframeBefore(uint64_t step) const
+{
+    const uint64_t index = (step - m_keyframes.front().step) / m_interval;
+    return m_keyframes[static_cast<size_t>(std::min<uint64_t>(index, m_keyframes.size() - 1))];
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ExecutionObserver.h"
+#include "Tape.h"
+#include "TapeHeatmap.h"
+
+class TuringMachine;
+
+/**
+ * Keyframes of the run on one tape, so that any step of it can be shown or
+ * returned to without undoing the steps after it one at a time. Every
+ * interval steps the tape, its heatmap and the state are kept; copies share
+ * the blocks of cells they have in common, so a keyframe costs about the
+ * blocks written since the one before. A step is reached from the keyframe
+ * before it by replaying less than an interval of steps. Past MaxKeyframes
+ * every other keyframe is dropped and the interval doubles.
+ *
+ * The run ends at the furthest step reached. Stepping back keeps the steps
+ * after it, so the timeline can move forward again. Any other jump starts
+ * the run over, and a step that reaches a keyframe in another configuration
+ * cuts the run there.
+ */
+class RunTimeline : public ExecutionObserver
+{
+public:
+    static constexpr uint64_t InitialInterval = 4096;
+    static constexpr size_t MaxKeyframes = 512;
+    static constexpr size_t MaxEvents = size_t(1) << 20;  // Entries of marked states beyond are not kept
+
+    enum class EventType {
+        ACCEPT,
+        REJECT,
+        MARKED
+    };
+
+    // A step that entered an accept, reject or marked state
+    struct Event {
+        uint64_t step;
+        EventType type;
+    };
+
+    // The tape and heatmap are the document's, seeks put them back
+    RunTimeline(Tape* tape, TapeHeatmap* heatmap);
+    ~RunTimeline() override;
+
+    // Follow the machine's steps on the tape, starting the run at its
+    // configuration if there is none yet
+    void attach(TuringMachine* machine);
+    void clear();  // Forget the run, e.g. when the tape was edited
+
+    bool isEmpty() const { return m_keyframes.empty(); }
+    uint64_t getFirstStep() const { return m_keyframes.empty() ? 0 : m_keyframes.front().step; }
+    uint64_t getLastStep() const { return m_end; }
+    uint64_t getPosition() const { return m_position; }  // The machine's step
+    uint64_t getInterval() const { return m_interval; }
+
+    const std::vector<Event>& getEvents() const { return m_events; }  // In step order
+
+    // Entering these states is marked too, the whole run is replayed to find them
+    const std::set<std::string>& getMarkedStates() const { return m_markedStates; }
+    void setMarkedStates(const std::set<std::string>& states);
+
+    // Build the configuration at a step of the run on the timeline's own
+    // tape and heatmap, for showing while scrubbing; the machine stays
+    bool preview(uint64_t step);
+    Tape* getPreviewTape() { return &m_previewTape; }  // To show, not to edit
+    const TapeHeatmap* getPreviewHeatmap() const { return &m_previewHeatmap; }
+
+    // Move the machine and the tape to a step of the run
+    bool seek(uint64_t step);
+
+    // ExecutionObserver
+    void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                const Transition& transition) override;
+    void onJump(const TuringMachine& machine) override;
+    void onReplaced(TuringMachine& replacement) override;
+
+private:
+    struct Keyframe {
+        uint64_t step;
+        std::string state;
+        Tape tape;
+        TapeHeatmap heatmap;
+    };
+
+    TuringMachine* m_machine;
+    Tape* m_tape;
+    TapeHeatmap* m_heatmap;
+
+    std::deque<Keyframe> m_keyframes;  // At the first step and every m_interval steps after it
+    uint64_t m_interval;
+    uint64_t m_end;
+    uint64_t m_position;
+    std::string m_lastState;  // Entered by the last step, events are taken when it changes
+    bool m_seeking;
+
+    std::vector<Event> m_events;
+    std::set<std::string> m_markedStates;
+
+    Tape m_previewTape;
+    TapeHeatmap m_previewHeatmap;
+    std::string m_previewState;
+    uint64_t m_previewStep;
+    bool m_previewValid;
+
+    void start(const TuringMachine& machine);
+    void cut(uint64_t step);
+    void thin();
+    void addKeyframe(uint64_t step, const std::string& state);
+    void addEvent(const TuringMachine& machine, uint64_t step, const std::string& state);
+    const Keyframe& keyframeBefore(uint64_t step) const;
+};
\ No newline at end of file
@@ -13,21 +13,16 @@ Tape::~Tape()
 
 std::string Tape::read() const
 {
-    auto it = cells.find(headPosition);
-    if (it != cells.end()) {
-        return it->second;
+    const std::string* cell = findCell(headPosition);
+    if (cell) {
+        return *cell;
     }
     return std::string(1, blankSymbol);
 }
 
 void Tape::write(const std::string& symbols)
 {
-    if (symbols.empty() || symbols == std::string(1, blankSymbol)) {
-        cells.erase(headPosition);
-    } else {
-        cells[headPosition] = symbols;
-    }
-
+    writeCell(headPosition, symbols);
     updateBounds(headPosition);
 }
 
@@ -43,7 +38,7 @@ void Tape::moveRight()
 
 void Tape::reset()
 {
-    cells.clear();
+    blocks.clear();
     headPosition = 0;
     leftmostUsed = 0;
     rightmostUsed = 0;
@@ -75,7 +70,7 @@ void Tape::setInitialContent(const std::string& content)
 
     for (size_t i = 0; i < content.length(); ++i) {
         if (content[i] != blankSymbol) {
-            cells[i] = std::string(1, content[i]);
+            writeCell(static_cast<int>(i), std::string(1, content[i]));
             updateBounds(i);
         }
     }
@@ -88,9 +83,9 @@ std::string Tape::getCurrentContent(int windowSize) const
 
     std::string result;
     for (int i = start; i <= end; ++i) {
-        auto it = cells.find(i);
-        if (it != cells.end()) {
-            result += it->second;
+        const std::string* cell = findCell(i);
+        if (cell) {
+            result += *cell;
         } else {
             result += blankSymbol;
         }
@@ -99,15 +94,50 @@ std::string Tape::getCurrentContent(int windowSize) const
     return result;
 }
 
+void Tape::setCell(int position, const std::string& symbols)
+{
+    writeCell(position, symbols);
+    updateBounds(position);
+}
+
+void Tape::clearRange(int64_t start, int64_t end)
+{
+    if (start >= end) {
+        return;
+    }
+
+    auto it = blocks.lower_bound(blockIndex(static_cast<int>(start)));
+    const int lastBlock = blockIndex(static_cast<int>(end - 1));
+    while (it != blocks.end() && it->first <= lastBlock) {
+        Block& block = *it->second;
+        auto first = block.lower_bound(static_cast<int>(start));
+        auto last = end > INT_MAX ? block.end() : block.lower_bound(static_cast<int>(end));
+        if (first == block.begin() && last == block.end()) {
+            it = blocks.erase(it);
+            continue;
+        }
+        if (first != last) {
+            // A block still shared with a copy is copied before it changes
+            if (it->second.use_count() > 1) {
+                it->second = std::make_shared<Block>(block);
+            }
+            Block& owned = *it->second;
+            owned.erase(owned.lower_bound(static_cast<int>(start)),
+                        end > INT_MAX ? owned.end() : owned.lower_bound(static_cast<int>(end)));
+        }
+        ++it;
+    }
+}
+
 std::vector<std::pair<int, std::string>> Tape::getVisiblePortion(int firstCellIndex, int count) const
 {
     std::vector<std::pair<int, std::string>> result;
 
     for (int i = 0; i < count; ++i) {
         int cellIndex = firstCellIndex + i;
-        auto it = cells.find(cellIndex);
-        if (it != cells.end()) {
-            result.push_back(std::make_pair(cellIndex, it->second));
+        const std::string* cell = findCell(cellIndex);
+        if (cell) {
+            result.push_back(std::make_pair(cellIndex, *cell));
         } else {
             result.push_back(std::make_pair(cellIndex, std::string(1, blankSymbol)));
         }
@@ -128,11 +158,49 @@ int Tape::getRightmostUsedPosition() const
 
 void Tape::updateBounds(int position)
 {
-    auto it = cells.find(position);
-    if (it == cells.end()) {
+    if (!findCell(position)) {
         return;
     }
 
     leftmostUsed = std::min(leftmostUsed, position);
     rightmostUsed = std::max(rightmostUsed, position);
+}
+
+const std::string* Tape::findCell(int position) const
+{
+    auto block = blocks.find(blockIndex(position));
+    if (block == blocks.end()) {
+        return nullptr;
+    }
+
+    auto cell = block->second->find(position);
+    return cell != block->second->end() ? &cell->second : nullptr;
+}
+
+void Tape::writeCell(int position, const std::string& symbols)
+{
+    bool blank = symbols.empty() || symbols == std::string(1, blankSymbol);
+    auto it = blocks.find(blockIndex(position));
+
+    if (blank) {
+        if (it == blocks.end() || !it->second->count(position)) {
+            return;
+        }
+    } else if (it == blocks.end()) {
+        it = blocks.emplace(blockIndex(position), std::make_shared<Block>()).first;
+    }
+
+    // A block still shared with a copy is copied before it changes
+    if (it->second.use_count() > 1) {
+        it->second = std::make_shared<Block>(*it->second);
+    }
+
+    if (blank) {
+        it->second->erase(position);
+        if (it->second->empty()) {
+            blocks.erase(it);
+        }
+    } else {
+        (*it->second)[position] = symbols;
+    }
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <climits>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -10,6 +13,11 @@ public:
     Tape(char blankSymbol = '_');
     ~Tape();
 
+    // Copies share blocks of cells and a block is only copied when written,
+    // so copying a tape is a cheap consistent snapshot for another thread
+    Tape(const Tape& other) = default;
+    Tape& operator=(const Tape& other) = default;
+
     // Core operations
     std::string read() const;  // Changed to return string instead of char
     void write(const std::string& symbols);  // Changed to accept string instead of char
@@ -27,17 +35,102 @@ public:
     void setInitialContent(const std::string& content);
     std::string getCurrentContent(int windowSize = 20) const;
 
+    // Visit runs of identical written cells as (start, length, symbols) in position order
+    template<typename Visitor>
+    void forEachRun(Visitor visit) const
+    {
+        forEachRunInRange(INT_MIN, static_cast<int64_t>(INT_MAX) + 1, visit);
+    }
+
+    // Same, limited to cells in [start, end)
+    template<typename Visitor>
+    void forEachRunInRange(int64_t start, int64_t end, Visitor visit) const
+    {
+        const std::string* runSymbols = nullptr;
+        int runStart = 0;
+        int runLength = 0;
+
+        if (start >= end) {
+            return;
+        }
+
+        auto block = blocks.lower_bound(blockIndex(static_cast<int>(start)));
+        const int lastBlock = blockIndex(static_cast<int>(end - 1));
+        for (; block != blocks.end() && block->first <= lastBlock; ++block) {
+            for (auto cell = block->second->lower_bound(static_cast<int>(start));
+                 cell != block->second->end() && cell->first < end; ++cell) {
+                if (runSymbols && cell->first == runStart + runLength && cell->second == *runSymbols) {
+                    ++runLength;
+                    continue;
+                }
+
+                if (runSymbols) {
+                    visit(runStart, runLength, *runSymbols);
+                }
+                runSymbols = &cell->second;
+                runStart = cell->first;
+                runLength = 1;
+            }
+        }
+
+        if (runSymbols) {
+            visit(runStart, runLength, *runSymbols);
+        }
+    }
+
+    // Visit the [start, end) ranges of cell blocks that differ from those of
+    // another tape. Blocks still shared with a copy are skipped unread, so
+    // finding what changed since a copy was taken costs only the changes.
+    template<typename Visitor>
+    void forEachChangedRange(const Tape& other, Visitor visit) const
+    {
+        auto visitBlock = [&visit](int index) {
+            int64_t start = static_cast<int64_t>(index) << BlockBits;
+            visit(start, start + (int64_t(1) << BlockBits));
+        };
+
+        auto mine = blocks.begin();
+        auto theirs = other.blocks.begin();
+        while (mine != blocks.end() || theirs != other.blocks.end()) {
+            if (theirs == other.blocks.end() || (mine != blocks.end() && mine->first < theirs->first)) {
+                visitBlock((mine++)->first);
+            } else if (mine == blocks.end() || theirs->first < mine->first) {
+                visitBlock((theirs++)->first);
+            } else {
+                if (mine->second != theirs->second && *mine->second != *theirs->second) {
+                    visitBlock(mine->first);
+                }
+                ++mine;
+                ++theirs;
+            }
+        }
+    }
+
+    // Erase written cells in [start, end)
+    void clearRange(int64_t start, int64_t end);
+
+    // Write a single cell without moving the head, used when loading projects
+    void setCell(int position, const std::string& symbols);
+
     // Visualization support
     std::vector<std::pair<int, std::string>> getVisiblePortion(int firstCellIndex, int count) const;
     int getLeftmostUsedPosition() const;
     int getRightmostUsedPosition() const;
 
 private:
-    std::map<int, std::string> cells;  // Changed from char to string
+    // Written cells grouped by position into blocks of 2^BlockBits cells
+    using Block = std::map<int, std::string>;
+    static constexpr int BlockBits = 10;
+
+    std::map<int, std::shared_ptr<Block>> blocks;  // Shared with copies until written
     int headPosition;
     char blankSymbol;
     int leftmostUsed;
     int rightmostUsed;
 
     void updateBounds(int position);
+    const std::string* findCell(int position) const;
+    void writeCell(int position, const std::string& symbols);
+
+    static int blockIndex(int position) { return position >> BlockBits; }
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "TapeHeatmap.h"
+
+#include <algorithm>
+
+TapeHeatmap::TapeHeatmap()
+    : m_firstBlock(0), m_maxVisits(0), m_maxWrites(0), m_lastBlock(nullptr), m_lastIndex(0)
+{
+}
+
+TapeHeatmap::TapeHeatmap(const TapeHeatmap& other)
+    : m_blocks(other.m_blocks), m_firstBlock(other.m_firstBlock), m_maxVisits(other.m_maxVisits),
+      m_maxWrites(other.m_maxWrites), m_lastBlock(nullptr), m_lastIndex(0)
+{
+    other.m_lastBlock = nullptr;
+}
+
+TapeHeatmap& TapeHeatmap::operator=(const TapeHeatmap& other)
+{
+    if (this != &other) {
+        m_blocks = other.m_blocks;
+        m_firstBlock = other.m_firstBlock;
+        m_maxVisits = other.m_maxVisits;
+        m_maxWrites = other.m_maxWrites;
+        m_lastBlock = nullptr;
+        other.m_lastBlock = nullptr;
+    }
+    return *this;
+}
+
+void TapeHeatmap::unrecord(int position, bool changed)
+{
+    Block& block = blockFor(position);
+    const int cell = position & CellMask;
+    if (block.visits[cell] > 0) {
+        --block.visits[cell];
+    }
+    if (changed && block.writes[cell] > 0) {
+        --block.writes[cell];
+    }
+}
+
+void TapeHeatmap::clear()
+{
+    m_blocks.clear();
+    m_firstBlock = 0;
+    m_maxVisits = 0;
+    m_maxWrites = 0;
+    m_lastBlock = nullptr;
+    m_lastIndex = 0;
+}
+
+uint32_t TapeHeatmap::get(int position, Count count) const
+{
+    const Block* block = find(position >> BlockBits);
+    if (!block) {
+        return 0;
+    }
+
+    const int cell = position & CellMask;
+    return count == Count::VISITS ? block->visits[cell] : block->writes[cell];
+}
+
+TapeHeatmap::Block& TapeHeatmap::allocate(int index)
+{
+    if (m_blocks.empty()) {
+        m_firstBlock = index;
+        m_blocks.resize(1);
+    } else if (index < m_firstBlock) {
+        // Moves the blocks after it along, once per block the head reaches to the left
+        const size_t added = static_cast<size_t>(m_firstBlock - index);
+        std::vector<std::shared_ptr<Block>> blocks(added + m_blocks.size());
+        std::move(m_blocks.begin(), m_blocks.end(), blocks.begin() + added);
+        m_blocks.swap(blocks);
+        m_firstBlock = index;
+    } else if (static_cast<size_t>(index - m_firstBlock) >= m_blocks.size()) {
+        m_blocks.resize(static_cast<size_t>(index - m_firstBlock) + 1);
+    }
+
+    std::shared_ptr<Block>& block = m_blocks[static_cast<size_t>(index - m_firstBlock)];
+    if (!block) {
+        block = std::make_shared<Block>();  // Zeroed
+    } else if (block.use_count() > 1) {
+        block = std::make_shared<Block>(*block);
+    }
+    return *block;
+}
+
+const TapeHeatmap::Block* TapeHeatmap::find(int index) const
+{
+    if (index < m_firstBlock || static_cast<size_t>(index - m_firstBlock) >= m_blocks.size()) {
+        return nullptr;
+    }
+    return m_blocks[static_cast<size_t>(index - m_firstBlock)].get();
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * How often each cell of a tape was visited by the head, and written with
+ * a symbol other than the one it held, during the current run. Counters
+ * are kept in blocks of 2^BlockBits cells, like the tape's own cells, and
+ * allocated when the head first reaches a block. The block the head was
+ * last in is remembered, so counting a step is an increment in an array
+ * it is almost always already in. Copies share blocks until either counts
+ * a step in one, like tape copies, so keeping a copy per keyframe is cheap.
+ */
+class TapeHeatmap
+{
+public:
+    enum class Count {
+        VISITS,
+        WRITES
+    };
+
+    static constexpr int BlockBits = 10;
+
+    TapeHeatmap();
+    TapeHeatmap(const TapeHeatmap& other);
+    TapeHeatmap& operator=(const TapeHeatmap& other);
+
+    // A step was taken at this cell; changed when it wrote another symbol
+    void record(int position, bool changed)
+    {
+        Block& block = blockFor(position);
+        const int cell = position & CellMask;
+        if (++block.visits[cell] > m_maxVisits) {
+            m_maxVisits = block.visits[cell];
+        }
+        if (changed && ++block.writes[cell] > m_maxWrites) {
+            m_maxWrites = block.writes[cell];
+        }
+    }
+
+    // The step taken at this cell was undone
+    void unrecord(int position, bool changed);
+
+    void clear();
+    bool isEmpty() const { return m_maxVisits == 0; }
+
+    uint32_t get(int position, Count count) const;
+
+    // At least the largest count; undone steps do not lower it
+    uint32_t getMax(Count count) const { return count == Count::VISITS ? m_maxVisits : m_maxWrites; }
+
+    // Visit visited cells as (position, visits, writes) in position order
+    template<typename Visitor>
+    void forEachCell(Visitor visit) const
+    {
+        for (size_t i = 0; i < m_blocks.size(); ++i) {
+            if (!m_blocks[i]) continue;
+
+            const int64_t first = (m_firstBlock + static_cast<int64_t>(i)) << BlockBits;
+            const Block& block = *m_blocks[i];
+            for (int cell = 0; cell <= CellMask; ++cell) {
+                if (block.visits[cell] != 0) {
+                    visit(static_cast<int>(first + cell), block.visits[cell], block.writes[cell]);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int CellMask = (1 << BlockBits) - 1;
+
+    struct Block {
+        uint32_t visits[1 << BlockBits];
+        uint32_t writes[1 << BlockBits];
+    };
+
+    std::vector<std::shared_ptr<Block>> m_blocks;  // Null until visited, shared with copies
+    int m_firstBlock;                              // Index of m_blocks[0]
+    uint32_t m_maxVisits;
+    uint32_t m_maxWrites;
+
+    // The block of the last step, owned by this heatmap alone. Copying
+    // forgets it in the original too, the block is shared from then on.
+    mutable Block* m_lastBlock;
+    mutable int m_lastIndex;
+
+    Block& blockFor(int position)
+    {
+        const int index = position >> BlockBits;
+        if (index != m_lastIndex || !m_lastBlock) {
+            m_lastBlock = &allocate(index);
+            m_lastIndex = index;
+        }
+        return *m_lastBlock;
+    }
+
+    Block& allocate(int index);
+    const Block* find(int index) const;
+};
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "TapeSummary.h"
+#include "Tape.h"
+
+#include <algorithm>
+
+TapeSummary::TapeSummary()
+    : m_origin(0), m_leaves(0)
+{
+}
+
+void TapeSummary::rebuild(const Tape& tape)
+{
+    clear();
+    cover(tape.getLeftmostUsedPosition() >> BucketBits, tape.getRightmostUsedPosition() >> BucketBits);
+
+    // Fill the leaves run by run, the inner nodes once at the end
+    tape.forEachRun([this](int start, int length, const std::string&) {
+        const int64_t end = static_cast<int64_t>(start) + length;
+        cover(start >> BucketBits, (end - 1) >> BucketBits);
+
+        for (int64_t position = start; position < end;) {
+            const int64_t bucket = position >> BucketBits;
+            const int64_t bucketEnd = std::min(end, (bucket + 1) << BucketBits);
+            m_tree[m_leaves + static_cast<size_t>(bucket - m_origin)] += static_cast<uint32_t>(bucketEnd - position);
+            position = bucketEnd;
+        }
+    });
+
+    buildInnerNodes();
+}
+
+void TapeSummary::clear()
+{
+    m_origin = 0;
+    m_leaves = 0;
+    m_tree.clear();
+}
+
+void TapeSummary::cellChanged(int position, bool wasWritten, bool isWritten)
+{
+    if (wasWritten == isWritten) {
+        return;
+    }
+
+    const int64_t bucket = position >> BucketBits;
+    cover(bucket, bucket);
+
+    for (size_t node = m_leaves + static_cast<size_t>(bucket - m_origin); node >= 1; node /= 2) {
+        if (isWritten) {
+            m_tree[node]++;
+        } else {
+            m_tree[node]--;
+        }
+    }
+}
+
+double TapeSummary::count(int64_t start, int64_t end) const
+{
+    if (end <= start || m_tree.empty()) {
+        return 0.0;
+    }
+
+    const double bucketSize = static_cast<double>(int64_t(1) << BucketBits);
+    const int64_t first = start >> BucketBits;
+    const int64_t last = (end - 1) >> BucketBits;
+    if (first == last) {
+        return leaf(first) * (end - start) / bucketSize;
+    }
+
+    double result = leaf(first) * (((first + 1) << BucketBits) - start) / bucketSize +
+                    leaf(last) * (end - (last << BucketBits)) / bucketSize;
+    if (last - first > 1) {
+        result += static_cast<double>(sum(first + 1, last - 1));
+    }
+    return result;
+}
+
+void TapeSummary::cover(int64_t first, int64_t last)
+{
+    if (m_leaves == 0) {
+        m_origin = first;
+        m_leaves = 1;
+        while (static_cast<int64_t>(m_leaves) <= last - first) {
+            m_leaves *= 2;
+        }
+        m_tree.assign(2 * m_leaves, 0);
+        return;
+    }
+
+    int64_t origin = m_origin;
+    size_t leaves = m_leaves;
+    while (first < origin || last >= origin + static_cast<int64_t>(leaves)) {
+        if (first < origin) {
+            origin -= static_cast<int64_t>(leaves);
+        }
+        leaves *= 2;
+    }
+
+    if (leaves == m_leaves) {
+        return;
+    }
+
+    std::vector<uint32_t> tree(2 * leaves, 0);
+    std::copy(m_tree.begin() + static_cast<std::ptrdiff_t>(m_leaves), m_tree.end(),
+              tree.begin() + static_cast<std::ptrdiff_t>(leaves + static_cast<size_t>(m_origin - origin)));
+    m_tree = std::move(tree);
+    m_origin = origin;
+    m_leaves = leaves;
+    buildInnerNodes();
+}
+
+uint32_t TapeSummary::leaf(int64_t bucket) const
+{
+    if (bucket < m_origin || bucket >= m_origin + static_cast<int64_t>(m_leaves)) {
+        return 0;
+    }
+    return m_tree[m_leaves + static_cast<size_t>(bucket - m_origin)];
+}
+
+uint64_t TapeSummary::sum(int64_t first, int64_t last) const
+{
+    first = std::max(first, m_origin);
+    last = std::min(last, m_origin + static_cast<int64_t>(m_leaves) - 1);
+    if (first > last) {
+        return 0;
+    }
+
+    uint64_t result = 0;
+    size_t left = m_leaves + static_cast<size_t>(first - m_origin);
+    size_t right = m_leaves + static_cast<size_t>(last - m_origin) + 1;
+    while (left < right) {
+        if (left & 1) {
+            result += m_tree[left++];
+        }
+        if (right & 1) {
+            result += m_tree[--right];
+        }
+        left /= 2;
+        right /= 2;
+    }
+    return result;
+}
+
+void TapeSummary::buildInnerNodes()
+{
+    for (size_t node = m_leaves - 1; node >= 1; --node) {
+        m_tree[node] = m_tree[2 * node] + m_tree[2 * node + 1];
+    }
+}
\ No newline at end of file
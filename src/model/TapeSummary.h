@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Tape;
+
+/**
+ * Counts of written cells over ranges of a tape, for overviews of tapes too
+ * long to scan. Cells are counted in buckets of 2^BucketBits in a segment
+ * tree, so a write and a range query each cost O(log n) in the number of
+ * buckets. The tree doubles its span when a write falls outside of it.
+ */
+class TapeSummary
+{
+public:
+    static constexpr int BucketBits = 6;
+
+    TapeSummary();
+
+    // Count a tape's cells from scratch, after changes that were not reported
+    void rebuild(const Tape& tape);
+    void clear();
+
+    // One cell became written or blank
+    void cellChanged(int position, bool wasWritten, bool isWritten);
+
+    // Written cells in [start, end); buckets partly inside count in proportion
+    double count(int64_t start, int64_t end) const;
+    uint64_t total() const { return m_tree.empty() ? 0 : m_tree[1]; }
+
+private:
+    int64_t m_origin;              // First bucket the tree spans
+    size_t m_leaves;               // Buckets it spans, a power of two
+    std::vector<uint32_t> m_tree;  // Implicit tree, node i has children 2i and 2i + 1, leaves from m_leaves
+
+    void cover(int64_t first, int64_t last);  // Grow to span these buckets
+    uint32_t leaf(int64_t bucket) const;
+    uint64_t sum(int64_t first, int64_t last) const;  // Buckets [first, last]
+    void buildInnerNodes();
+};
\ No newline at end of file
@@ -7,10 +7,31 @@
 
 using json = nlohmann::json;
 
+namespace {
+
+// Move the nodes of a sorted map into another one, each right after the one
+// before it, which is constant time as long as that is where it belongs
+template<typename Map>
+void adoptNodes(Map& target, Map& built)
+{
+    if (target.empty()) {
+        target.swap(built);
+        return;
+    }
+
+    auto hint = target.end();
+    while (!built.empty()) {
+        auto position = target.insert(hint, built.extract(built.begin()));
+        hint = std::next(position);
+    }
+}
+
+} // namespace
+
 // Constructor & destructor
 TuringMachine::TuringMachine(const std::string& name, MachineType type)
-    : name(name), type(type), activeTape(nullptr), status(ExecutionStatus::READY),
-      stepCount(0), maxHistorySize(1000), historyPosition(-1)
+    : name(name), type(type), activeTape(nullptr), heatmap(nullptr), status(ExecutionStatus::READY),
+      stepCount(0), history(RunState().maxHistorySize), maxHistorySize(RunState().maxHistorySize)
 {
 }
 
@@ -90,6 +111,15 @@ State* TuringMachine::getState(const std::string& id)
     return nullptr;
 }
 
+const State* TuringMachine::getState(const std::string& id) const
+{
+    auto it = states.find(id);
+    if (it != states.end()) {
+        return it->second.get();
+    }
+    return nullptr;
+}
+
 std::vector<State*> TuringMachine::getAllStates() const
 {
     std::vector<State*> result;
@@ -127,6 +157,40 @@ void TuringMachine::setStartState(const std::string& id)
     }
 }
 
+void TuringMachine::clear()
+{
+    // Removing states one by one rescans every transition per state
+    transitions.clear();
+    states.clear();
+    currentState = "";
+}
+
+void TuringMachine::takeOver(TuringMachine& previous)
+{
+    name = previous.name;
+    type = previous.type;
+
+    activeTape = previous.activeTape;
+    heatmap = previous.heatmap;
+    previous.activeTape = nullptr;
+    previous.heatmap = nullptr;
+
+    status = previous.status;
+    stepCount = previous.stepCount;
+    history = std::move(previous.history);
+    maxHistorySize = previous.maxHistorySize;
+    previous.history.clear();
+
+    m_originalCode = std::move(previous.m_originalCode);
+    previous.m_originalCode.clear();
+
+    observers = std::move(previous.observers);
+    previous.observers.clear();
+    for (ExecutionObserver* observer : observers) {
+        observer->onReplaced(*this);
+    }
+}
+
 // Transition management
 void TuringMachine::addTransition(const std::string& fromState, const std::string& readSymbol,
                                const std::string& toState, const std::string& writeSymbol,
@@ -164,10 +228,26 @@ std::vector<Transition*> TuringMachine::getAllTransitions() const
     return result;
 }
 
+void TuringMachine::adoptStates(StateMap& built)
+{
+    adoptNodes(states, built);
+}
+
+void TuringMachine::adoptTransitions(TransitionMap& built)
+{
+    adoptNodes(transitions, built);
+}
+
 // Tape operations
-void TuringMachine::setTape(Tape* tape)
+void TuringMachine::setTape(Tape* tape, TapeHeatmap* tapeHeatmap)
 {
-    activeTape = tape;
+    heatmap = tapeHeatmap;
+    if (activeTape != tape) {
+        // Steps taken on another tape can't be undone on this one
+        activeTape = tape;
+        history.clear();
+        notifyJump();
+    }
 }
 
 // Code management
@@ -176,7 +256,12 @@ void TuringMachine::setOriginalCode(const std::string& code)
     m_originalCode = code;
 }
 
-std::string TuringMachine::getOriginalCode() const
+void TuringMachine::setOriginalCode(std::string&& code)
+{
+    m_originalCode = std::move(code);
+}
+
+const std::string& TuringMachine::getOriginalCode() const
 {
     return m_originalCode;
 }
@@ -195,12 +280,14 @@ void TuringMachine::reset()
     if (activeTape) {
         activeTape->reset();
     }
+    if (heatmap) {
+        heatmap->clear();
+    }
 
     status = ExecutionStatus::READY;
     stepCount = 0;
-    clearHistory();
-
-    addToHistory(createSnapshot());
+    history.clear();
+    notifyJump();
 }
 
 bool TuringMachine::step()
@@ -238,12 +325,7 @@ bool TuringMachine::step()
     }
 
     std::string symbol = activeTape->read();
-    Transition* transition = getTransition(currentState, symbol);
-
-    if (!transition) {
-        // Try with the blank symbol as a fallback
-        transition = getTransition(currentState, std::string(1, activeTape->getBlankSymbol()));
-    }
+    const Transition* transition = findTransition(currentState, symbol, activeTape->getBlankSymbol());
 
     if (!transition) {
         status = ExecutionStatus::ERROR;
@@ -252,8 +334,15 @@ bool TuringMachine::step()
         return false;
     }
 
+    const int position = activeTape->getHeadPosition();
+    history.push(HistoryStep{position, symbol, currentState});
+
     // Execute the transition
-    activeTape->write(transition->getWriteSymbol());
+    const std::string writeSymbol = transition->getWriteSymbol();
+    activeTape->write(writeSymbol);
+    if (heatmap) {
+        heatmap->record(position, writeSymbol != symbol);
+    }
 
     switch (transition->getDirection()) {
         case Direction::LEFT:
@@ -269,7 +358,10 @@ bool TuringMachine::step()
     currentState = transition->getToState();
 
     stepCount++;
-    addToHistory(createSnapshot());
+
+    for (ExecutionObserver* observer : observers) {
+        observer->onStep(*this, position, symbol, *transition);
+    }
 
     // Set back to PAUSED or original state after a single step
     if (oldStatus == ExecutionStatus::PAUSED || oldStatus == ExecutionStatus::READY) {
@@ -281,6 +373,26 @@ bool TuringMachine::step()
     return true;
 }
 
+const Transition* TuringMachine::findTransition(const std::string& state, const std::string& symbol,
+                                               char blankSymbol) const
+{
+    auto it = transitions.find(std::make_pair(state, symbol));
+    if (it == transitions.end()) {
+        // Try with the blank symbol as a fallback
+        it = transitions.find(std::make_pair(state, std::string(1, blankSymbol)));
+    }
+    return it != transitions.end() ? it->second.get() : nullptr;
+}
+
+uint64_t TuringMachine::runSteps(uint64_t count)
+{
+    uint64_t taken = 0;
+    while (taken < count && step()) {
+        taken++;
+    }
+    return taken;
+}
+
 void TuringMachine::run()
 {
     status = ExecutionStatus::RUNNING;
@@ -295,7 +407,7 @@ void TuringMachine::pause()
 
 bool TuringMachine::canStepBackward() const
 {
-    return historyPosition > 0;
+    return !history.empty();
 }
 
 bool TuringMachine::stepBackward()
@@ -309,11 +421,22 @@ bool TuringMachine::stepBackward()
         return false;
     }
 
-    historyPosition--;
-    restoreSnapshot(history[historyPosition]);
+    HistoryStep step;
+    if (!history.pop(step)) {
+        return false;
+    }
+
+    // Put back the symbols the step overwrote, the head and the state
+    activeTape->setHeadPosition(step.headPosition);
+    if (heatmap) {
+        heatmap->unrecord(step.headPosition, activeTape->read() != step.symbols);
+    }
+    activeTape->write(step.symbols);
+    currentState = step.state;
     stepCount--;
+    notifyJump();
 
-    if (historyPosition == 0) {
+    if (stepCount == 0) {
         status = ExecutionStatus::READY;
     } else {
         status = ExecutionStatus::PAUSED;
@@ -322,6 +445,58 @@ bool TuringMachine::stepBackward()
     return true;
 }
 
+void TuringMachine::jumpTo(uint64_t step, const std::string& state)
+{
+    if (step <= stepCount && stepCount - step <= history.size()) {
+        history.truncate(static_cast<size_t>(stepCount - step));
+    } else {
+        history.clear();
+    }
+
+    currentState = state;
+    stepCount = step;
+    status = step == 0 ? ExecutionStatus::READY : ExecutionStatus::PAUSED;
+    notifyJump();
+}
+
+uint64_t TuringMachine::replay(Tape& tape, TapeHeatmap* tapeHeatmap, std::string& state, uint64_t count) const
+{
+    uint64_t taken = 0;
+    for (; taken < count; ++taken) {
+        const State* current = getState(state);
+        if (!current || current->isAcceptState() || current->isRejectState()) {
+            break;
+        }
+
+        const std::string symbol = tape.read();
+        const Transition* transition = findTransition(state, symbol, tape.getBlankSymbol());
+        if (!transition) {
+            break;
+        }
+
+        const int position = tape.getHeadPosition();
+        const std::string writeSymbol = transition->getWriteSymbol();
+        tape.write(writeSymbol);
+        if (tapeHeatmap) {
+            tapeHeatmap->record(position, writeSymbol != symbol);
+        }
+
+        switch (transition->getDirection()) {
+            case Direction::LEFT:
+                tape.moveLeft();
+                break;
+            case Direction::RIGHT:
+                tape.moveRight();
+                break;
+            case Direction::STAY:
+                break;
+        }
+
+        state = transition->getToState();
+    }
+    return taken;
+}
+
 ExecutionStatus TuringMachine::getStatus() const
 {
     return status;
@@ -332,8 +507,51 @@ std::string TuringMachine::getCurrentState() const
     return currentState;
 }
 
+void TuringMachine::setCurrentState(const std::string& id)
+{
+    currentState = id;
+    notifyJump();
+}
+
+void TuringMachine::addObserver(ExecutionObserver* observer)
+{
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+        observers.push_back(observer);
+    }
+}
+
+void TuringMachine::removeObserver(ExecutionObserver* observer)
+{
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void TuringMachine::notifyJump()
+{
+    for (ExecutionObserver* observer : observers) {
+        observer->onJump(*this);
+    }
+}
+
+RunState TuringMachine::getRunState() const
+{
+    RunState state;
+    state.stepCount = stepCount;
+    state.status = status;
+    state.maxHistorySize = maxHistorySize;
+    return state;
+}
+
+void TuringMachine::restoreRunState(const RunState& state)
+{
+    setMaxHistorySize(state.maxHistorySize);
+    stepCount = state.stepCount;
+
+    // A run that was going when it was saved waits to be resumed
+    status = state.status == ExecutionStatus::RUNNING ? ExecutionStatus::PAUSED : state.status;
+}
+
 // Analysis and statistics
-int TuringMachine::getStepCount() const
+uint64_t TuringMachine::getStepCount() const
 {
     return stepCount;
 }
@@ -346,12 +564,12 @@ int TuringMachine::getMaxHistorySize() const
 void TuringMachine::setMaxHistorySize(int size)
 {
     maxHistorySize = size;
+    history.setCapacity(static_cast<size_t>(std::max(0, size)));
+}
 
-    if (history.size() > static_cast<size_t>(maxHistorySize)) {
-        int toRemove = history.size() - maxHistorySize;
-        history.erase(history.begin(), history.begin() + toRemove);
-        historyPosition -= toRemove;
-    }
+void TuringMachine::setHistoryLimits(size_t memoryBytes, size_t diskBytes)
+{
+    history.setLimits(memoryBytes, diskBytes);
 }
 
 // Serialization
@@ -394,6 +612,55 @@ std::string TuringMachine::toJson() const
     return j.dump(4);
 }
 
+void TuringMachine::restoreLayoutFromJson(const std::string& jsonStr)
+{
+    // Everything but the name and each state's id and position is dropped
+    // while parsing, transitions and code included
+    json::parser_callback_t keepLayout = [](int depth, json::parse_event_t event, json& parsed) {
+        if (event != json::parse_event_t::key) {
+            return true;
+        }
+        const std::string& key = parsed.get_ref<const std::string&>();
+        if (depth == 1) {
+            return key == "name" || key == "states";
+        }
+        return key == "id" || key == "posX" || key == "posY";
+    };
+
+    json j = json::object();
+    try {
+        if (!jsonStr.empty()) {
+            j = json::parse(jsonStr, keepLayout);
+        }
+    } catch (const std::exception& e) {
+        qWarning() << "Error reading machine layout:" << e.what();
+        return;
+    }
+
+    if (j.contains("name") && j["name"].is_string()) {
+        name = j["name"].get<std::string>();
+    }
+
+    for (auto& pair : states) {
+        pair.second->setPosition(Point2D());
+    }
+
+    if (!j.contains("states") || !j["states"].is_array()) {
+        return;
+    }
+    for (const auto& stateJson : j["states"]) {
+        if (!stateJson.is_object() || !stateJson.contains("id") || !stateJson["id"].is_string() ||
+            !stateJson.contains("posX") || !stateJson.contains("posY") ||
+            !stateJson["posX"].is_number() || !stateJson["posY"].is_number()) {
+            continue;
+        }
+        auto it = states.find(stateJson["id"].get<std::string>());
+        if (it != states.end()) {
+            it->second->setPosition(Point2D(stateJson["posX"].get<float>(), stateJson["posY"].get<float>()));
+        }
+    }
+}
+
 std::unique_ptr<TuringMachine> TuringMachine::fromJson(const std::string& jsonStr)
 {
     try {
@@ -404,7 +671,7 @@ std::unique_ptr<TuringMachine> TuringMachine::fromJson(const std::string& jsonSt
 
         // Load original code if present
         if (j.contains("originalCode")) {
-            machine->setOriginalCode(j["originalCode"]);
+            machine->setOriginalCode(j["originalCode"].get<std::string>());
         }
 
         // Load states
@@ -489,69 +756,4 @@ std::unique_ptr<TuringMachine> TuringMachine::fromJson(const std::string& jsonSt
         qCritical() << "Error in fromJson:" << e.what();
         throw;
     }
-}
-
-// Helper methods
-ExecutionSnapshot TuringMachine::createSnapshot() const
-{
-    if (!activeTape) {
-        // Return an empty snapshot if no tape is set
-        return ExecutionSnapshot{};
-    }
-
-    ExecutionSnapshot snapshot;
-    snapshot.currentState = currentState;
-    snapshot.headPosition = activeTape->getHeadPosition();
-
-    // Get the tape content
-    int left = activeTape->getLeftmostUsedPosition();
-    int right = activeTape->getRightmostUsedPosition();
-
-    auto visibleCells = activeTape->getVisiblePortion(left, right - left + 1);
-    for (const auto& cell : visibleCells) {
-        if (cell.second != std::string(1, activeTape->getBlankSymbol())) {
-            snapshot.tapeContent[cell.first] = cell.second;
-        }
-    }
-
-    return snapshot;
-}
-
-void TuringMachine::restoreSnapshot(const ExecutionSnapshot& snapshot)
-{
-    if (!activeTape) {
-        return;
-    }
-
-    currentState = snapshot.currentState;
-
-    activeTape->reset();
-
-    for (const auto& pair : snapshot.tapeContent) {
-        activeTape->setHeadPosition(pair.first);
-        activeTape->write(pair.second);
-    }
-
-    activeTape->setHeadPosition(snapshot.headPosition);
-}
-
-void TuringMachine::clearHistory()
-{
-    history.clear();
-    historyPosition = -1;
-}
-
-void TuringMachine::addToHistory(const ExecutionSnapshot& snapshot)
-{
-    if (historyPosition >= 0 && historyPosition < static_cast<int>(history.size()) - 1) {
-        history.resize(historyPosition + 1);
-    }
-
-    history.push_back(snapshot);
-    historyPosition = history.size() - 1;
-
-    if (history.size() > static_cast<size_t>(maxHistorySize)) {
-        history.erase(history.begin());
-        historyPosition--;
-    }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <climits>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -8,6 +10,9 @@
 #include "State.h"
 #include "Transition.h"
 #include "Tape.h"
+#include "ExecutionObserver.h"
+#include "HistoryStore.h"
+#include "TapeHeatmap.h"
 
 enum class MachineType {
     DETERMINISTIC,
@@ -23,24 +28,27 @@ enum class ExecutionStatus {
     ERROR
 };
 
-struct ExecutionSnapshot {
-    std::string currentState;
-    int headPosition;
-    std::map<int, std::string> tapeContent;  // Changed to store strings
+// Progress of a run and the options it runs with, saved with the project
+struct RunState {
+    uint64_t stepCount = 0;
+    ExecutionStatus status = ExecutionStatus::READY;
+    int maxHistorySize = INT_MAX;  // Steps that can be undone, within the history's byte limits
 
-    bool operator==(const ExecutionSnapshot& other) const {
-        return currentState == other.currentState &&
-               headPosition == other.headPosition &&
-               tapeContent == other.tapeContent;
+    bool operator==(const RunState& other) const {
+        return stepCount == other.stepCount && status == other.status &&
+               maxHistorySize == other.maxHistorySize;
     }
 
-    bool operator!=(const ExecutionSnapshot& other) const {
+    bool operator!=(const RunState& other) const {
         return !(*this == other);
     }
 };
 
 class TuringMachine {
 public:
+    using StateMap = std::map<std::string, std::unique_ptr<State>>;
+    using TransitionMap = std::map<std::pair<std::string, std::string>, std::unique_ptr<Transition>>;
+
     // Constructor & destructor
     TuringMachine(const std::string& name = "Untitled Machine",
                   MachineType type = MachineType::DETERMINISTIC);
@@ -57,9 +65,18 @@ public:
     void addState(const std::string& id, const std::string& name = "", StateType type = StateType::NORMAL);
     void removeState(const std::string& id);
     State* getState(const std::string& id);
+    const State* getState(const std::string& id) const;
     std::vector<State*> getAllStates() const;
+    size_t getStateCount() const { return states.size(); }
     std::string getStartState() const;
     void setStartState(const std::string& id);
+    void clear();  // Remove all states and transitions at once
+
+    // Continue the run of a machine this one was compiled to replace: its
+    // tape, history, run state, code and observers move over, its name and
+    // type are copied as it may still be read elsewhere, e.g. by a save.
+    // Observers are told through onReplaced.
+    void takeOver(TuringMachine& previous);
 
     // Transition management
     void addTransition(const std::string& fromState, const std::string& readSymbol,
@@ -68,55 +85,114 @@ public:
     void removeTransition(const std::string& fromState, const std::string& readSymbol);
     Transition* getTransition(const std::string& fromState, const std::string& readSymbol);
     std::vector<Transition*> getAllTransitions() const;
+    size_t getTransitionCount() const { return transitions.size(); }
+
+    // Take over states and transitions built apart from the machine, e.g. on
+    // the parser's worker threads, without copying them. Ids the machine
+    // already has keep theirs. Transitions must be between states the machine
+    // has; the current state is not changed. Maps that continue after the
+    // machine's last id are taken in linear time.
+    void adoptStates(StateMap& built);
+    void adoptTransitions(TransitionMap& built);
+
+    // Visit states in id order and transitions in (state, symbol) order,
+    // without collecting them first
+    template<typename Visitor>
+    void forEachState(Visitor visit) const
+    {
+        for (const auto& pair : states) {
+            visit(pair.second.get());
+        }
+    }
+
+    template<typename Visitor>
+    void forEachTransition(Visitor visit) const
+    {
+        for (const auto& pair : transitions) {
+            visit(pair.second.get());
+        }
+    }
 
     // Tape operations
-    void setTape(Tape* tape);  // Set a non-owned reference to an external tape for execution
+    // Set non-owned references to an external tape for execution, and to
+    // the counters of the tape's cells that steps taken on it update
+    void setTape(Tape* tape, TapeHeatmap* heatmap = nullptr);
+    const Tape* getTape() const { return activeTape; }
 
     // Code management
     void setOriginalCode(const std::string& code);
-    std::string getOriginalCode() const;
+    void setOriginalCode(std::string&& code);
+    const std::string& getOriginalCode() const;  // The only copy of the code the project keeps
 
     // Execution control
     void reset();
     bool step();
+    uint64_t runSteps(uint64_t count);  // Up to count steps, fewer if the machine stops; returns the steps taken
     void run();
     void pause();
     bool canStepBackward() const;
     bool stepBackward();
     ExecutionStatus getStatus() const;
     std::string getCurrentState() const;
+    void setCurrentState(const std::string& id);  // Used when restoring a saved machine
+
+    // Continue from an earlier or later configuration of the current run,
+    // which the caller has put the tape back to. Undo history is cut back to
+    // the step if it reaches that far and the step is not ahead, else cleared.
+    void jumpTo(uint64_t step, const std::string& state);
+
+    // Take up to count steps from a configuration on a tape of the caller's,
+    // leaving this machine's own run, history and observers alone; the
+    // heatmap, if any, counts them. Returns the steps taken.
+    uint64_t replay(Tape& tape, TapeHeatmap* tapeHeatmap, std::string& state, uint64_t count) const;
+
+    // Run state, restored after the state and tape when a saved run is resumed
+    RunState getRunState() const;
+    void restoreRunState(const RunState& state);
 
     // Analysis and statistics
-    int getStepCount() const;
+    uint64_t getStepCount() const;
     int getMaxHistorySize() const;
     void setMaxHistorySize(int size);
 
+    // Bytes of history kept in memory and spilled to disk, see HistoryStore
+    void setHistoryLimits(size_t memoryBytes, size_t diskBytes);
+
+    // Observers are notified of every step and every other configuration change
+    void addObserver(ExecutionObserver* observer);
+    void removeObserver(ExecutionObserver* observer);
+
     // Serialization
     std::string toJson() const;
     static std::unique_ptr<TuringMachine> fromJson(const std::string& json);
 
+    // Take only the name and state positions from JSON written by toJson,
+    // without building its states and transitions. States it doesn't have
+    // are left unplaced.
+    void restoreLayoutFromJson(const std::string& json);
+
 private:
     std::string name;
     MachineType type;
-    std::map<std::string, std::unique_ptr<State>> states;
-    std::map<std::pair<std::string, std::string>, std::unique_ptr<Transition>> transitions;
+    StateMap states;
+    TransitionMap transitions;
 
     Tape* activeTape;  // Non-owning reference to an external tape
+    TapeHeatmap* heatmap;  // Of the active tape, also not owned
 
     std::string currentState;
     ExecutionStatus status;
-    int stepCount;
+    uint64_t stepCount;
 
     std::string m_originalCode;
 
-    // Execution history
-    std::vector<ExecutionSnapshot> history;
+    // Execution history, what each step changed so it can be undone
+    HistoryStore history;
     int maxHistorySize;
-    int historyPosition;
+
+    std::vector<ExecutionObserver*> observers;
 
     // Helper methods
-    ExecutionSnapshot createSnapshot() const;
-    void restoreSnapshot(const ExecutionSnapshot& snapshot);
-    void clearHistory();
-    void addToHistory(const ExecutionSnapshot& snapshot);
+    const Transition* findTransition(const std::string& state, const std::string& symbol, char blankSymbol) const;
+    void notifyJump();
 };
\ No newline at end of file
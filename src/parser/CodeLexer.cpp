@@ -0,0 +1,117 @@
+#include "CodeLexer.h"
+
+CodeLexer::CodeLexer(std::string_view line)
+    : m_line(line), m_position(0), m_seenSignificant(false)
+{
+}
+
+bool CodeLexer::next(Token& token)
+{
+    if (m_position >= m_line.size()) {
+        return false;
+    }
+
+    size_t start = m_position;
+    char c = m_line[start];
+    TokenType type;
+
+    if (isWhitespace(c)) {
+        type = TokenType::Whitespace;
+        while (m_position < m_line.size() && isWhitespace(m_line[m_position])) {
+            m_position++;
+        }
+    } else if (c == '/' && start + 1 < m_line.size() && m_line[start + 1] == '/') {
+        type = TokenType::Comment;
+        m_position = m_line.size();
+    } else if (isIdentifierChar(c)) {
+        type = (!m_seenSignificant && isKeywordAt(start)) ? TokenType::Keyword : TokenType::Identifier;
+        while (m_position < m_line.size() && isIdentifierChar(m_line[m_position])) {
+            m_position++;
+        }
+    } else if (c == '(') {
+        type = TokenType::LeftParen;
+        m_position++;
+    } else if (c == ')') {
+        type = TokenType::RightParen;
+        m_position++;
+    } else if (c == ',') {
+        type = TokenType::Comma;
+        m_position++;
+    } else if (c == '=') {
+        type = TokenType::Arrow;
+        m_position++;
+    } else if (c == '-' && start + 1 < m_line.size() && m_line[start + 1] == '>') {
+        type = TokenType::Arrow;
+        m_position += 2;
+    } else {
+        type = TokenType::Text;
+        m_position++;
+        while (m_position < m_line.size() && !startsToken(m_position)) {
+            m_position++;
+        }
+    }
+
+    if (type != TokenType::Whitespace) {
+        m_seenSignificant = true;
+    }
+
+    token.type = type;
+    token.offset = start;
+    token.text = m_line.substr(start, m_position - start);
+    return true;
+}
+
+void CodeLexer::tokenize(std::string_view line, std::vector<Token>& tokens)
+{
+    tokens.clear();
+
+    CodeLexer lexer(line);
+    Token token;
+    while (lexer.next(token)) {
+        tokens.push_back(token);
+    }
+}
+
+bool CodeLexer::isIdentifierChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+bool CodeLexer::isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool CodeLexer::startsToken(size_t position) const
+{
+    char c = m_line[position];
+    if (isWhitespace(c) || isIdentifierChar(c) ||
+        c == '(' || c == ')' || c == ',' || c == '=') {
+        return true;
+    }
+
+    bool hasNext = position + 1 < m_line.size();
+    return (c == '-' && hasNext && m_line[position + 1] == '>') ||
+           (c == '/' && hasNext && m_line[position + 1] == '/');
+}
+
+bool CodeLexer::isKeywordAt(size_t position) const
+{
+    // A keyword is a single letter followed (after optional whitespace) by '('
+    char c = m_line[position];
+    if (c != 's' && c != 'a' && c != 'r' && c != 'q' && c != 'f' && c != 'm' && c != 'c') {
+        return false;
+    }
+
+    size_t next = position + 1;
+    if (next < m_line.size() && isIdentifierChar(m_line[next])) {
+        return false;
+    }
+
+    while (next < m_line.size() && isWhitespace(m_line[next])) {
+        next++;
+    }
+
+    return next < m_line.size() && m_line[next] == '(';
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+enum class TokenType {
+    Keyword,      // s, a, r, q, f, m or c at the start of a line, followed by '('
+    Identifier,   // [a-zA-Z0-9_]+
+    LeftParen,
+    RightParen,
+    Comma,
+    Arrow,        // -> or =
+    Comment,      // // up to the end of the line
+    Whitespace,
+    Text          // Anything else (symbols such as '#' or '*')
+};
+
+struct Token {
+    TokenType type;
+    size_t offset;           // Byte offset into the line
+    std::string_view text;   // Slice of the line, never owns memory
+};
+
+/**
+ * Tokenizer for a single line of Turing machine code, shared by the parser
+ * and the syntax highlighter. Tokens are views into the line passed in.
+ */
+class CodeLexer {
+public:
+    explicit CodeLexer(std::string_view line);
+
+    // Returns false once the end of the line has been reached
+    bool next(Token& token);
+
+    // Tokenize a whole line into the given vector (cleared first)
+    static void tokenize(std::string_view line, std::vector<Token>& tokens);
+
+    static bool isIdentifierChar(char c);
+    static bool isWhitespace(char c);
+
+private:
+    std::string_view m_line;
+    size_t m_position;
+    bool m_seenSignificant;
+
+    bool startsToken(size_t position) const;
+    bool isKeywordAt(size_t position) const;
+};
\ No newline at end of file
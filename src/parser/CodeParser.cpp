@@ -1,188 +1,730 @@
 #include "CodeParser.h"
+#include "SourceFile.h"
 #include "../model/TuringMachine.h"
 #include "../model/State.h"
 #include "../model/Transition.h"
 #include <QDebug>
-#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// Walks the tokens of a single line, skipping whitespace between them
+class TokenCursor {
+public:
+    explicit TokenCursor(const std::vector<Token>& tokens)
+        : m_tokens(tokens), m_index(0)
+    {
+        skipWhitespace();
+    }
 
-CodeParser::CodeParser()
-{
-    // Initialize regex patterns
+    bool atEnd() const
+    {
+        return m_index >= m_tokens.size();
+    }
 
-    // State patterns
-    // s(q0, Start State) - Start state
-    m_startStateRegex = std::regex(R"(s\s*\(\s*([a-zA-Z0-9_]+)\s*(?:,\s*([^)]*))?\s*\))");
+    // Consume the next token if it has the given type
+    const Token* take(TokenType type)
+    {
+        if (atEnd() || m_tokens[m_index].type != type) {
+            return nullptr;
+        }
 
-    // a(q1, Accept State) - Accept state
-    m_acceptStateRegex = std::regex(R"(a\s*\(\s*([a-zA-Z0-9_]+)\s*(?:,\s*([^)]*))?\s*\))");
+        const Token* token = &m_tokens[m_index++];
+        skipWhitespace();
+        return token;
+    }
 
-    // r(q2, Reject State) - Reject state
-    m_rejectStateRegex = std::regex(R"(r\s*\(\s*([a-zA-Z0-9_]+)\s*(?:,\s*([^)]*))?\s*\))");
+    // Slice the raw line text up to (not including) the next token of the given type
+    bool takeUntil(TokenType stop, std::string_view line, std::string_view& text)
+    {
+        size_t start = atEnd() ? line.size() : m_tokens[m_index].offset;
+
+        for (size_t i = m_index; i < m_tokens.size(); ++i) {
+            if (m_tokens[i].type == stop) {
+                text = line.substr(start, m_tokens[i].offset - start);
+                m_index = i;
+                return true;
+            }
+        }
 
-    // q(q3, Normal State) - Normal state (optional)
-    m_normalStateRegex = std::regex(R"(q\s*\(\s*([a-zA-Z0-9_]+)\s*(?:,\s*([^)]*))?\s*\))");
+        return false;
+    }
 
-    // Transition patterns
-    // f(q0, 0) -> (q1, 1, R) or f(q0, 0) = (q1, 1, R)
-    m_transitionRegex = std::regex(
-        R"(f\s*\(\s*([a-zA-Z0-9_]+)\s*,\s*([^)]*)\s*\)\s*(?:->|=)\s*\(\s*([a-zA-Z0-9_]+)\s*,\s*([^,]*)\s*,\s*([LRN])\s*\))"
-    );
+private:
+    const std::vector<Token>& m_tokens;
+    size_t m_index;
+
+    void skipWhitespace()
+    {
+        while (m_index < m_tokens.size() && m_tokens[m_index].type == TokenType::Whitespace) {
+            m_index++;
+        }
+    }
+};
+
+// Run work(0) to work(count - 1), all but the first on worker threads
+template<typename Work>
+void runInParallel(size_t count, Work work)
+{
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; ++i) {
+        workers.emplace_back(work, i);
+    }
+
+    work(0);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Hash of a (state, symbol) transition key
+struct KeyHash {
+    size_t operator()(const std::pair<std::string_view, std::string_view>& key) const
+    {
+        std::hash<std::string_view> hasher;
+        return hasher(key.first) * 31 + hasher(key.second);
+    }
+};
+
+} // namespace
+
+struct CodeParser::ParsedStatement {
+    enum class Kind {
+        STATE,
+        TRANSITION,
+        MODULE,
+        CALL
+    };
+
+    Kind kind;
+    size_t line;                     // Line number relative to the start of the chunk
+
+    // State declarations
+    StateType stateType;
+    std::string_view stateName;      // Slice of the source text
+
+    // The declared state, the source state of a transition or the calling state.
+    // Like every other field these are slices of the source text, which
+    // outlives the parse, so nothing is copied before the machine takes it.
+    std::string_view stateId;
+    size_t statePart;                // Part of the machine that builds it, see mergeChunks
+
+    // Transitions; toState is also the return state of a call
+    std::string_view readSymbol;
+    std::string_view toState;
+    size_t toPart;
+    std::string_view writeSymbol;
+    Direction direction;
+
+    // Module declarations and calls
+    std::string_view module;
+    std::string_view modulePath;
+};
+
+struct CodeParser::ParsedChunk {
+    std::vector<ParsedStatement> statements;
+    size_t lineCount = 0;
+};
+
+struct CodeParser::BuiltPart {
+    TuringMachine::StateMap states;
+    TuringMachine::TransitionMap transitions;
+    std::vector<ParseDiagnostic> diagnostics;
+
+    // Last start declaration, and last one that added its state, 0 for none
+    size_t startLine = 0;
+    std::string_view startState;
+    size_t addedStartLine = 0;
+    std::string_view addedStartState;
+};
+
+CodeParser::CodeParser()
+{
 }
 
 CodeParser::~CodeParser()
 {
 }
 
-bool CodeParser::parseAndUpdateMachine(TuringMachine* machine, const std::string& code)
+bool CodeParser::parseAndUpdateMachine(TuringMachine* machine, std::string_view code)
 {
     if (!machine) {
         qWarning() << "Null machine provided to parser";
         return false;
     }
 
+    m_diagnostics.clear();
+    m_modules.clear();
+    m_calls.clear();
+
+    // Lines are independent, so large inputs are parsed in parallel chunks
+    size_t workerCount = 1;
+    if (code.size() >= ParallelThreshold) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::string_view> ranges = splitIntoChunks(code, workerCount);
+    std::vector<ParsedChunk> chunks(ranges.size());
+    runInParallel(ranges.size(), [&ranges, &chunks](size_t i) { parseChunk(ranges[i], chunks[i]); });
+
     // Clear existing states and transitions
-    auto existingStates = machine->getAllStates();
-    for (auto state : existingStates) {
-        machine->removeState(state->getId());
+    machine->clear();
+
+    mergeChunks(machine, chunks);
+
+    if (!m_diagnostics.empty()) {
+        qWarning() << "Parsed code with" << m_diagnostics.size() << "conflicting definitions";
     }
 
-    // Process each line
-    std::istringstream stream(code);
-    std::string line;
-    bool foundStates = false;
-    bool foundTransitions = false;
+    return true;
+}
+
+bool CodeParser::parseFileAndUpdateMachine(TuringMachine* machine, const std::string& path)
+{
+    SourceFile source;
+    if (!source.open(path)) {
+        return false;
+    }
+
+    return parseAndUpdateMachine(machine, source.getContents());
+}
+
+void CodeParser::parseChunk(std::string_view code, ParsedChunk& chunk)
+{
+    // Process each line as a slice of the input, without copying it
+    std::vector<Token> tokens;
+    size_t lineStart = 0;
+
+    while (lineStart < code.size()) {
+        size_t lineEnd = code.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = code.size();
+        }
+
+        std::string_view line = trimString(code.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+        chunk.lineCount++;
 
-    while (std::getline(stream, line)) {
         // Skip empty lines and comments
-        line = trimString(line);
         if (line.empty() || line.substr(0, 2) == "//") {
             continue;
         }
 
-        // Try to parse as a state
-        if (parseStateDeclaration(line, machine)) {
-            foundStates = true;
+        CodeLexer::tokenize(line, tokens);
+
+        ParsedStatement statement;
+        statement.line = chunk.lineCount;
+
+        // Try to parse as a state, then as a transition, then as a module statement
+        if (parseStateDeclaration(line, tokens, statement) ||
+            parseTransition(line, tokens, statement) ||
+            parseModuleStatement(line, tokens, statement)) {
+            chunk.statements.push_back(statement);
+        }
+    }
+}
+
+std::vector<ModuleDeclaration> CodeParser::scanModules(std::string_view code)
+{
+    std::vector<ModuleDeclaration> modules;
+    std::vector<Token> tokens;
+    size_t lineStart = 0;
+    size_t lineNumber = 0;
+
+    while (lineStart < code.size()) {
+        size_t lineEnd = code.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = code.size();
+        }
+
+        std::string_view line = trimString(code.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+        lineNumber++;
+
+        // Only lexing lines that can declare a module keeps the scan cheap
+        if (line.empty() || line[0] != 'm') {
             continue;
         }
 
-        // Try to parse as a transition
-        if (parseTransition(line, machine)) {
+        CodeLexer::tokenize(line, tokens);
+
+        ParsedStatement statement;
+        if (parseModuleStatement(line, tokens, statement) &&
+            statement.kind == ParsedStatement::Kind::MODULE) {
+            modules.push_back({lineNumber, std::string(statement.module), std::string(statement.modulePath)});
+        }
+    }
+
+    return modules;
+}
+
+std::vector<std::string_view> CodeParser::splitIntoChunks(std::string_view code, size_t count)
+{
+    std::vector<std::string_view> chunks;
+    size_t start = 0;
+
+    for (size_t i = 1; i <= count && start < code.size(); ++i) {
+        size_t end = code.size();
+
+        if (i < count) {
+            // Extend the nominal boundary to the end of the line it falls in
+            size_t target = std::max(start, code.size() / count * i);
+            size_t newline = code.find('\n', target);
+            if (newline != std::string_view::npos) {
+                end = newline + 1;
+            }
+        }
+
+        chunks.push_back(code.substr(start, end - start));
+        start = end;
+    }
+
+    if (chunks.empty()) {
+        chunks.push_back(code);
+    }
+
+    return chunks;
+}
+
+void CodeParser::mergeChunks(TuringMachine* machine, std::vector<ParsedChunk>& chunks)
+{
+    std::vector<size_t> lineOffsets;
+    size_t lineOffset = 0;
+    for (const ParsedChunk& chunk : chunks) {
+        lineOffsets.push_back(lineOffset);
+        lineOffset += chunk.lineCount;
+    }
+
+    // Each part builds the states in one range of ids and the transitions
+    // from them, so the parts never touch the same state or key, and each
+    // part's states and transitions go into the machine after the last one's.
+    // The ranges are split where a sample of the ids says they are even.
+    const size_t partCount = chunks.size();
+    std::vector<std::string_view> sample;
+    for (const ParsedChunk& chunk : chunks) {
+        size_t stride = std::max<size_t>(1, chunk.statements.size() / SamplesPerChunk);
+        for (size_t i = 0; i < chunk.statements.size(); i += stride) {
+            if (chunk.statements[i].kind != ParsedStatement::Kind::MODULE) {
+                sample.push_back(chunk.statements[i].stateId);
+            }
+        }
+    }
+    std::sort(sample.begin(), sample.end());
+
+    std::vector<std::string_view> splitters;
+    for (size_t i = 1; i < partCount && !sample.empty(); ++i) {
+        splitters.push_back(sample[sample.size() * i / partCount]);
+    }
+
+    auto partOf = [&splitters](std::string_view id) -> size_t {
+        return std::upper_bound(splitters.begin(), splitters.end(), id) - splitters.begin();
+    };
+
+    runInParallel(chunks.size(), [&chunks, &partOf](size_t i) {
+        for (ParsedStatement& statement : chunks[i].statements) {
+            statement.statePart = partOf(statement.stateId);
+            statement.toPart = partOf(statement.toState);
+        }
+    });
+
+    std::vector<BuiltPart> parts(partCount);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < parts.size(); ++i) {
+        workers.emplace_back(&CodeParser::buildPart, std::cref(chunks), std::cref(lineOffsets), i, std::ref(parts[i]));
+    }
+
+    buildPart(chunks, lineOffsets, 0, parts[0]);
+
+    // Modules and calls are few, they are collected in source order meanwhile
+    bool foundStates = false;
+    bool foundTransitions = false;
+    std::string_view firstState;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        for (const ParsedStatement& statement : chunks[i].statements) {
+            size_t line = lineOffsets[i] + statement.line;
+
+            if (statement.kind == ParsedStatement::Kind::MODULE) {
+                m_modules.push_back({line, std::string(statement.module), std::string(statement.modulePath)});
+                continue;
+            }
+
+            if (firstState.empty()) {
+                firstState = statement.stateId;
+            }
+
+            if (statement.kind == ParsedStatement::Kind::STATE) {
+                foundStates = true;
+                continue;
+            }
+
             foundTransitions = true;
-            continue;
+
+            if (statement.kind == ParsedStatement::Kind::CALL) {
+                m_calls.push_back({line, std::string(statement.stateId), std::string(statement.module),
+                                   std::string(statement.toState)});
+            }
+        }
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // The machine starts in the first state the code mentions, or in the
+    // last start state that a declaration added, as when states are added
+    // one at a time; a start state is then chosen below when it is ready to run
+    const BuiltPart* start = nullptr;
+    const BuiltPart* addedStart = nullptr;
+    for (const BuiltPart& part : parts) {
+        if (part.startLine && (!start || part.startLine > start->startLine)) {
+            start = &part;
+        }
+        if (part.addedStartLine && (!addedStart || part.addedStartLine > addedStart->addedStartLine)) {
+            addedStart = &part;
         }
     }
 
+    auto addFirst = [&parts, &partOf](TuringMachine* machine, std::string_view id) {
+        const TuringMachine::StateMap& built = parts[partOf(id)].states;
+        auto it = built.find(std::string(id));
+        if (it != built.end()) {
+            machine->addState(it->first, it->second->getName(), it->second->getType());
+        }
+    };
+
+    if (!firstState.empty()) {
+        addFirst(machine, firstState);
+    }
+    if (addedStart) {
+        addFirst(machine, addedStart->addedStartState);
+    }
+
+    for (BuiltPart& part : parts) {
+        machine->adoptStates(part.states);
+    }
+    for (BuiltPart& part : parts) {
+        machine->adoptTransitions(part.transitions);
+        m_diagnostics.insert(m_diagnostics.end(), part.diagnostics.begin(), part.diagnostics.end());
+    }
+
+    // A key is redefined at most once per line, so this is source order
+    std::sort(m_diagnostics.begin(), m_diagnostics.end(),
+              [](const ParseDiagnostic& a, const ParseDiagnostic& b) { return a.line < b.line; });
+
+    // The last start declaration made the other start states normal ones,
+    // while a later declaration may still have changed its own type
+    if (start) {
+        State* startState = machine->getState(std::string(start->startState));
+        StateType type = startState->getType();
+        machine->setStartState(startState->getId());
+        startState->setType(type);
+    }
+
     // If we have transitions but no states, create a default start state
     if (foundTransitions && !foundStates) {
         machine->addState("q0", "Start State", StateType::START);
     }
+}
 
-    return true;
+void CodeParser::buildPart(const std::vector<ParsedChunk>& chunks, const std::vector<size_t>& lineOffsets,
+                           size_t part, BuiltPart& built)
+{
+    std::unordered_map<std::string_view, std::unique_ptr<State>> states;
+
+    // Last definition of each (state, symbol) key, only these become transitions
+    struct Definition {
+        size_t line;
+        const ParsedStatement* statement;
+    };
+    std::unordered_map<std::pair<std::string_view, std::string_view>, Definition, KeyHash> definitions;
+
+    // Add a state with no name and the normal type unless it is already there
+    auto mention = [&states](std::string_view id) -> std::pair<State*, bool> {
+        auto inserted = states.emplace(id, nullptr);
+        if (inserted.second) {
+            inserted.first->second = std::make_unique<State>(std::string(id));
+        }
+        return {inserted.first->second.get(), inserted.second};
+    };
+
+    // Replaying statements in source order keeps last-definition-wins semantics
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        for (const ParsedStatement& statement : chunks[i].statements) {
+            if (statement.kind == ParsedStatement::Kind::MODULE) {
+                continue;
+            }
+
+            const size_t line = lineOffsets[i] + statement.line;
+            const bool ownsState = statement.statePart == part;
+
+            if (statement.kind == ParsedStatement::Kind::STATE) {
+                if (!ownsState) {
+                    continue;
+                }
+
+                // Add or update the state
+                auto [state, added] = mention(statement.stateId);
+                state->setName(std::string(statement.stateName));
+                state->setType(statement.stateType);
+
+                if (statement.stateType == StateType::START) {
+                    built.startLine = line;
+                    built.startState = statement.stateId;
+                    if (added) {
+                        built.addedStartLine = line;
+                        built.addedStartState = statement.stateId;
+                    }
+                }
+                continue;
+            }
+
+            // Both ends of a transition or a call are states
+            if (ownsState) {
+                mention(statement.stateId);
+            }
+            if (statement.toPart == part) {
+                mention(statement.toState);
+            }
+
+            if (statement.kind == ParsedStatement::Kind::CALL || !ownsState) {
+                continue;
+            }
+
+            auto inserted = definitions.emplace(std::make_pair(statement.stateId, statement.readSymbol),
+                                                Definition{line, &statement});
+            if (!inserted.second) {
+                // Same key seen before: only a different right-hand side is a conflict
+                Definition& previous = inserted.first->second;
+                if (previous.statement->toState != statement.toState ||
+                    previous.statement->writeSymbol != statement.writeSymbol ||
+                    previous.statement->direction != statement.direction) {
+                    built.diagnostics.push_back({line,
+                        "Transition f(" + std::string(statement.stateId) + ", " + std::string(statement.readSymbol) +
+                        ") redefined, previous definition on line " + std::to_string(previous.line)});
+                }
+                previous = Definition{line, &statement};
+            }
+        }
+    }
+
+    // Sorted first, so each state and transition goes in after the one before
+    std::vector<std::string_view> ids;
+    ids.reserve(states.size());
+    for (const auto& pair : states) {
+        ids.push_back(pair.first);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    for (std::string_view id : ids) {
+        built.states.emplace_hint(built.states.end(), std::string(id), std::move(states[id]));
+    }
+
+    std::vector<const ParsedStatement*> definitionOrder;
+    definitionOrder.reserve(definitions.size());
+    for (const auto& pair : definitions) {
+        definitionOrder.push_back(pair.second.statement);
+    }
+    std::sort(definitionOrder.begin(), definitionOrder.end(), [](const ParsedStatement* a, const ParsedStatement* b) {
+        return std::make_pair(a->stateId, a->readSymbol) < std::make_pair(b->stateId, b->readSymbol);
+    });
+
+    for (const ParsedStatement* statement : definitionOrder) {
+        std::string fromState(statement->stateId);
+        std::string readSymbol(statement->readSymbol);
+        auto transition = std::make_unique<Transition>(fromState, readSymbol, std::string(statement->toState),
+                                                       std::string(statement->writeSymbol), statement->direction);
+        built.transitions.emplace_hint(built.transitions.end(), std::make_pair(std::move(fromState), std::move(readSymbol)),
+                                       std::move(transition));
+    }
 }
 
-bool CodeParser::parseStateDeclaration(const std::string& line, TuringMachine* machine)
+bool CodeParser::parseStateDeclaration(std::string_view line, const std::vector<Token>& tokens,
+                                       ParsedStatement& statement)
 {
-    std::smatch matches;
+    TokenCursor cursor(tokens);
+
+    const Token* keyword = cursor.take(TokenType::Keyword);
+    if (!keyword) {
+        return false;
+    }
+
     StateType stateType = StateType::NORMAL;
 
-    // Try to match against the different state patterns
-    if (std::regex_match(line, matches, m_startStateRegex)) {
-        stateType = StateType::START;
-    } else if (std::regex_match(line, matches, m_acceptStateRegex)) {
-        stateType = StateType::ACCEPT;
-    } else if (std::regex_match(line, matches, m_rejectStateRegex)) {
-        stateType = StateType::REJECT;
-    } else if (std::regex_match(line, matches, m_normalStateRegex)) {
-        stateType = StateType::NORMAL;
-    } else {
-        // Not a state declaration
+    // Determine the state type from the keyword
+    switch (keyword->text[0]) {
+        case 's':
+            stateType = StateType::START;
+            break;
+        case 'a':
+            stateType = StateType::ACCEPT;
+            break;
+        case 'r':
+            stateType = StateType::REJECT;
+            break;
+        case 'q':
+            stateType = StateType::NORMAL;
+            break;
+        default:
+            // Not a state declaration
+            return false;
+    }
+
+    // Extract state ID and optional name: s(state_id, [name])
+    const Token* idToken = nullptr;
+    std::string_view nameText;
+
+    if (!cursor.take(TokenType::LeftParen) || !(idToken = cursor.take(TokenType::Identifier))) {
+        return false;
+    }
+
+    if (cursor.take(TokenType::Comma) && !cursor.takeUntil(TokenType::RightParen, line, nameText)) {
+        return false;
+    }
+
+    if (!cursor.take(TokenType::RightParen) || !cursor.atEnd()) {
+        return false;
+    }
+
+    statement.kind = ParsedStatement::Kind::STATE;
+    statement.stateType = stateType;
+    statement.stateId = idToken->text;
+    statement.stateName = trimString(nameText);
+
+    return true;
+}
+
+bool CodeParser::parseTransition(std::string_view line, const std::vector<Token>& tokens,
+                                 ParsedStatement& statement)
+{
+    TokenCursor cursor(tokens);
+
+    // f(q0, 0) -> (q1, 1, R) or f(q0, 0) = (q1, 1, R)
+    const Token* keyword = cursor.take(TokenType::Keyword);
+    if (!keyword || keyword->text != "f" || !cursor.take(TokenType::LeftParen)) {
+        // Not a transition
+        return false;
+    }
+
+    const Token* fromToken = cursor.take(TokenType::Identifier);
+    std::string_view readText;
+    if (!fromToken || !cursor.take(TokenType::Comma) ||
+        !cursor.takeUntil(TokenType::RightParen, line, readText) ||
+        !cursor.take(TokenType::RightParen) || !cursor.take(TokenType::Arrow) ||
+        !cursor.take(TokenType::LeftParen)) {
         return false;
     }
 
-    // Extract state ID and name
-    std::string stateId = matches[1].str();
-    std::string stateName = matches.size() > 2 ? trimString(matches[2].str()) : "";
+    const Token* toToken = cursor.take(TokenType::Identifier);
+    std::string_view writeText;
+    if (!toToken || !cursor.take(TokenType::Comma) ||
+        !cursor.takeUntil(TokenType::Comma, line, writeText) ||
+        !cursor.take(TokenType::Comma)) {
+        return false;
+    }
+
+    const Token* dirToken = cursor.take(TokenType::Identifier);
+    if (!dirToken || !cursor.take(TokenType::RightParen) || !cursor.atEnd()) {
+        return false;
+    }
 
-    // Add or update the state in the machine
-    State* existingState = machine->getState(stateId);
-    if (existingState) {
-        existingState->setName(stateName);
-        existingState->setType(stateType);
+    // Parse direction
+    Direction direction;
+    if (dirToken->text == "L") {
+        direction = Direction::LEFT;
+    } else if (dirToken->text == "R") {
+        direction = Direction::RIGHT;
+    } else if (dirToken->text == "N") {
+        direction = Direction::STAY;
     } else {
-        machine->addState(stateId, stateName, stateType);
+        // Invalid direction
+        return false;
     }
 
-    // If this is a start state, ensure it's set as the machine's start state
-    if (stateType == StateType::START) {
-        machine->setStartState(stateId);
+    // Extract transition components
+    readText = trimString(readText);
+    writeText = trimString(writeText);
+
+    // Handle special "Blank" keyword
+    if (readText == "Blank" || readText == "blank") {
+        readText = "_";
+    }
+    if (writeText == "Blank" || writeText == "blank") {
+        writeText = "_";
     }
 
+    statement.kind = ParsedStatement::Kind::TRANSITION;
+    statement.stateId = fromToken->text;
+    statement.readSymbol = readText;
+    statement.toState = toToken->text;
+    statement.writeSymbol = writeText;
+    statement.direction = direction;
+
     return true;
 }
 
-bool CodeParser::parseTransition(const std::string& line, TuringMachine* machine)
+bool CodeParser::parseModuleStatement(std::string_view line, const std::vector<Token>& tokens,
+                                      ParsedStatement& statement)
 {
-    std::smatch matches;
-
-    if (std::regex_match(line, matches, m_transitionRegex)) {
-        // Extract transition components
-        std::string fromState = trimString(matches[1].str());
-        std::string readSymbol = trimString(matches[2].str());
-        std::string toState = trimString(matches[3].str());
-        std::string writeSymbol = trimString(matches[4].str());
-
-        // Handle special "Blank" keyword
-        if (readSymbol == "Blank" || readSymbol == "blank") {
-            readSymbol = "_";
-        }
-        if (writeSymbol == "Blank" || writeSymbol == "blank") {
-            writeSymbol = "_";
-        }
-
-        // Parse direction
-        std::string dirStr = trimString(matches[5].str());
-        Direction direction;
-        if (dirStr == "L") {
-            direction = Direction::LEFT;
-        } else if (dirStr == "R") {
-            direction = Direction::RIGHT;
-        } else if (dirStr == "N") {
-            direction = Direction::STAY;
-        } else {
-            // Invalid direction
-            return false;
-        }
+    TokenCursor cursor(tokens);
 
-        // Create states if they don't exist
-        if (!machine->getState(fromState)) {
-            machine->addState(fromState);
-        }
+    const Token* keyword = cursor.take(TokenType::Keyword);
+    if (!keyword || (keyword->text != "m" && keyword->text != "c") || !cursor.take(TokenType::LeftParen)) {
+        return false;
+    }
 
-        if (!machine->getState(toState)) {
-            machine->addState(toState);
+    if (keyword->text == "m") {
+        // m(name, path), the path runs up to the closing parenthesis
+        const Token* nameToken = cursor.take(TokenType::Identifier);
+        std::string_view pathText;
+        if (!nameToken || !cursor.take(TokenType::Comma) ||
+            !cursor.takeUntil(TokenType::RightParen, line, pathText) ||
+            !cursor.take(TokenType::RightParen) || !cursor.atEnd()) {
+            return false;
         }
 
-        // Add or update the transition
-        machine->addTransition(fromState, readSymbol, toState, writeSymbol, direction);
+        pathText = trimString(pathText);
+        if (pathText.empty()) {
+            return false;
+        }
 
+        statement.kind = ParsedStatement::Kind::MODULE;
+        statement.module = nameToken->text;
+        statement.modulePath = pathText;
         return true;
     }
 
-    // Not a transition
-    return false;
+    // c(state, module, return_state)
+    const Token* stateToken = cursor.take(TokenType::Identifier);
+    const Token* moduleToken = nullptr;
+    const Token* returnToken = nullptr;
+    if (!stateToken || !cursor.take(TokenType::Comma) ||
+        !(moduleToken = cursor.take(TokenType::Identifier)) || !cursor.take(TokenType::Comma) ||
+        !(returnToken = cursor.take(TokenType::Identifier)) ||
+        !cursor.take(TokenType::RightParen) || !cursor.atEnd()) {
+        return false;
+    }
+
+    statement.kind = ParsedStatement::Kind::CALL;
+    statement.stateId = stateToken->text;
+    statement.module = moduleToken->text;
+    statement.toState = returnToken->text;
+    return true;
 }
 
-std::string CodeParser::trimString(const std::string& str)
+std::string_view CodeParser::trimString(std::string_view str)
 {
     // Find first non-whitespace character
     size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) {
-        return "";  // String is all whitespace
+    if (start == std::string_view::npos) {
+        return std::string_view();  // String is all whitespace
     }
 
     // Find last non-whitespace character
     size_t end = str.find_last_not_of(" \t\n\r");
 
-    // Return the trimmed string
+    // Return the trimmed view
     return str.substr(start, end - start + 1);
 }
\ No newline at end of file
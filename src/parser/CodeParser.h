@@ -1,14 +1,44 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <regex>
 #include <memory>
 
+#include "CodeLexer.h"
+
 class TuringMachine;
 class State;
 class Transition;
 
+/**
+ * Problem found while parsing, e.g. a transition defined twice
+ */
+struct ParseDiagnostic {
+    size_t line;          // 1-based line number in the parsed code
+    std::string message;
+};
+
+/**
+ * m(name, path): a machine compiled from another code file
+ */
+struct ModuleDeclaration {
+    size_t line;
+    std::string name;
+    std::string path;         // Relative to the directory of the declaring code
+};
+
+/**
+ * c(state, module, return_state): run a module from state and continue in
+ * return_state once the module accepts
+ */
+struct ModuleCall {
+    size_t line;
+    std::string state;
+    std::string module;
+    std::string returnState;
+};
+
 /**
  * Parser for Turing machine code with special syntax
  */
@@ -18,24 +48,63 @@ public:
     ~CodeParser();
 
     // Parse code and update a machine
-    bool parseAndUpdateMachine(TuringMachine* machine, const std::string& code);
+    bool parseAndUpdateMachine(TuringMachine* machine, std::string_view code);
+
+    // Memory-map a source file and parse it in place without copying it
+    bool parseFileAndUpdateMachine(TuringMachine* machine, const std::string& path);
+
+    // Diagnostics collected by the last parse
+    const std::vector<ParseDiagnostic>& getDiagnostics() const { return m_diagnostics; }
+
+    // Modules and calls found by the last parse, resolved by MachineLinker
+    const std::vector<ModuleDeclaration>& getModules() const { return m_modules; }
+    const std::vector<ModuleCall>& getCalls() const { return m_calls; }
+
+    // Find module declarations without parsing the rest of the code
+    static std::vector<ModuleDeclaration> scanModules(std::string_view code);
+
+    // Inputs at least this large are split into chunks and parsed on worker threads
+    static constexpr size_t ParallelThreshold = 1 << 20;
+
+    // State ids taken from each chunk to split the machine into parts
+    static constexpr size_t SamplesPerChunk = 256;
 
 private:
-    // Regex patterns
-    std::regex m_startStateRegex;    // s(state_id, [name])
-    std::regex m_acceptStateRegex;   // a(state_id, [name])
-    std::regex m_rejectStateRegex;   // r(state_id, [name])
-    std::regex m_normalStateRegex;   // q(state_id, [name])
-    std::regex m_transitionRegex;    // f(q0, 0) -> (q1, 1, R)
+    struct ParsedStatement;
+    struct ParsedChunk;
+    struct BuiltPart;
+
+    std::vector<ParseDiagnostic> m_diagnostics;
+    std::vector<ModuleDeclaration> m_modules;
+    std::vector<ModuleCall> m_calls;
+
+    // Parse a run of complete lines into a chunk-local statement list
+    static void parseChunk(std::string_view code, ParsedChunk& chunk);
+
+    // Split the code at line boundaries into roughly equal parts
+    static std::vector<std::string_view> splitIntoChunks(std::string_view code, size_t count);
+
+    // Apply parsed statements to the machine as if in source order, building
+    // one part of its states and transitions per chunk on worker threads
+    void mergeChunks(TuringMachine* machine, std::vector<ParsedChunk>& chunks);
+
+    // Build the states in the part's range of ids, the transitions from them
+    // and the conflicts between their definitions
+    static void buildPart(const std::vector<ParsedChunk>& chunks, const std::vector<size_t>& lineOffsets,
+                          size_t part, BuiltPart& built);
+
+    // Parse state declarations: s(state_id, [name]), a(...), r(...), q(...)
+    static bool parseStateDeclaration(std::string_view line, const std::vector<Token>& tokens,
+                                      ParsedStatement& statement);
 
-    // Parse state declarations
-    bool parseStateDeclaration(const std::string& line,
-                              TuringMachine* machine);
+    // Parse transitions: f(q0, 0) -> (q1, 1, R)
+    static bool parseTransition(std::string_view line, const std::vector<Token>& tokens,
+                                ParsedStatement& statement);
 
-    // Parse transitions
-    bool parseTransition(const std::string& line,
-                        TuringMachine* machine);
+    // Parse module declarations and calls: m(name, path), c(state, module, return_state)
+    static bool parseModuleStatement(std::string_view line, const std::vector<Token>& tokens,
+                                     ParsedStatement& statement);
 
     // Helper methods
-    std::string trimString(const std::string& str);
+    static std::string_view trimString(std::string_view str);
 };
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "MachineLinker.h"
+#include "SourceFile.h"
+#include "../model/TuringMachine.h"
+#include "../model/State.h"
+#include "../model/Transition.h"
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+#include <unordered_set>
+
+MachineLinker::MachineLinker()
+{
+}
+
+MachineLinker::~MachineLinker()
+{
+}
+
+bool MachineLinker::linkAndUpdateMachine(TuringMachine* machine, std::string_view code,
+                                         const std::string& baseDirectory)
+{
+    m_diagnostics.clear();
+    m_moduleHash.clear();
+    m_moduleKeys.clear();
+
+    CodeParser parser;
+    if (!parser.parseAndUpdateMachine(machine, code)) {
+        return false;
+    }
+    m_diagnostics = parser.getDiagnostics();
+
+    // Plain machines need no linking
+    if (parser.getModules().empty() && parser.getCalls().empty()) {
+        return true;
+    }
+
+    std::string keys;
+    resolveCalls(machine, parser, baseDirectory, m_diagnostics, keys);
+    m_moduleHash = hashKeys(keys);
+
+    return true;
+}
+
+std::string MachineLinker::hashModules(std::string_view code, const std::string& baseDirectory)
+{
+    m_moduleKeys.clear();
+
+    std::vector<ModuleDeclaration> modules = CodeParser::scanModules(code);
+    if (modules.empty()) {
+        return std::string();
+    }
+
+    std::string keys;
+    for (const ModuleDeclaration& declaration : modules) {
+        std::string key;
+        std::string error;
+        std::string path = resolvePath(baseDirectory, declaration.path);
+        if (!path.empty() && moduleKey(path, key, error)) {
+            keys += key;
+        }
+    }
+
+    return hashKeys(keys);
+}
+
+void MachineLinker::clearCache()
+{
+    m_linkedModules.clear();
+    m_moduleKeys.clear();
+}
+
+bool MachineLinker::moduleKey(const std::string& path, std::string& key, std::string& error)
+{
+    auto known = m_moduleKeys.find(path);
+    if (known != m_moduleKeys.end()) {
+        key = known->second;
+        return true;
+    }
+
+    if (std::find(m_keyStack.begin(), m_keyStack.end(), path) != m_keyStack.end()) {
+        error = "module calls itself through " + path;
+        return false;
+    }
+
+    SourceFile source;
+    if (!source.open(path)) {
+        error = "cannot read " + path;
+        return false;
+    }
+
+    std::string_view code = source.getContents();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::fromRawData(code.data(), static_cast<int>(code.size())));
+
+    // Modules this one declares are part of its key, so editing any of them relinks it
+    std::string directory = QFileInfo(QString::fromStdString(path)).absolutePath().toStdString();
+    bool success = true;
+
+    m_keyStack.push_back(path);
+    for (const ModuleDeclaration& declaration : CodeParser::scanModules(code)) {
+        std::string childPath = resolvePath(directory, declaration.path);
+        if (childPath.empty()) {
+            error = "module " + declaration.name + " not found at " + declaration.path;
+            success = false;
+            break;
+        }
+
+        std::string childKey;
+        if (!moduleKey(childPath, childKey, error)) {
+            success = false;
+            break;
+        }
+        hash.addData(QByteArray::fromStdString(childKey));
+    }
+    m_keyStack.pop_back();
+
+    if (!success) {
+        return false;
+    }
+
+    key = hash.result().toHex().toStdString();
+    m_moduleKeys[path] = key;
+    return true;
+}
+
+std::shared_ptr<const TuringMachine> MachineLinker::linkModule(const std::string& path, std::string& key,
+                                                               std::string& error)
+{
+    if (!moduleKey(path, key, error)) {
+        return nullptr;
+    }
+
+    auto cached = m_linkedModules.find(key);
+    if (cached != m_linkedModules.end()) {
+        return cached->second;
+    }
+
+    SourceFile source;
+    if (!source.open(path)) {
+        error = "cannot read " + path;
+        return nullptr;
+    }
+
+    QFileInfo info(QString::fromStdString(path));
+    auto module = std::make_shared<TuringMachine>(info.completeBaseName().toStdString());
+
+    CodeParser parser;
+    parser.parseAndUpdateMachine(module.get(), source.getContents());
+
+    // Problems inside a module do not stop the caller from linking
+    std::vector<ParseDiagnostic> diagnostics = parser.getDiagnostics();
+    std::string keys;
+    resolveCalls(module.get(), parser, info.absolutePath().toStdString(), diagnostics, keys);
+
+    for (const ParseDiagnostic& diagnostic : diagnostics) {
+        qWarning() << QString::fromStdString(path) << "line" << diagnostic.line << ":"
+                   << QString::fromStdString(diagnostic.message);
+    }
+
+    m_linkedModules[key] = module;
+    return module;
+}
+
+void MachineLinker::resolveCalls(TuringMachine* machine, const CodeParser& parser, const std::string& baseDirectory,
+                                 std::vector<ParseDiagnostic>& diagnostics, std::string& keys)
+{
+    // Link each declared module once, however many states call it
+    std::unordered_map<std::string, std::shared_ptr<const TuringMachine>> modules;
+
+    for (const ModuleDeclaration& declaration : parser.getModules()) {
+        std::string path = resolvePath(baseDirectory, declaration.path);
+        if (path.empty()) {
+            diagnostics.push_back({declaration.line,
+                "Module " + declaration.name + " not found at " + declaration.path});
+            continue;
+        }
+
+        std::string key;
+        std::string error;
+        std::shared_ptr<const TuringMachine> module = linkModule(path, key, error);
+        if (!module) {
+            diagnostics.push_back({declaration.line,
+                "Module " + declaration.name + " could not be linked: " + error});
+            continue;
+        }
+
+        keys += key;
+        modules[declaration.name] = module;
+    }
+
+    for (const ModuleCall& call : parser.getCalls()) {
+        auto it = modules.find(call.module);
+        if (it == modules.end()) {
+            diagnostics.push_back({call.line, "Call to unknown module " + call.module});
+            continue;
+        }
+
+        inlineModule(machine, *it->second, call, diagnostics);
+    }
+}
+
+void MachineLinker::inlineModule(TuringMachine* machine, const TuringMachine& module, const ModuleCall& call,
+                                 std::vector<ParseDiagnostic>& diagnostics)
+{
+    std::vector<State*> moduleStates = module.getAllStates();
+    if (moduleStates.empty()) {
+        diagnostics.push_back({call.line, "Module " + call.module + " has no states"});
+        return;
+    }
+
+    // Without an explicit start state the module starts where reset() would put it
+    std::string startState = module.getStartState();
+    if (startState.empty()) {
+        startState = moduleStates.front()->getId();
+    }
+
+    // Every call gets its own copy, so states are prefixed with the call site
+    const std::string prefix = call.state + "__" + call.module + "__";
+
+    // A start state that accepts returns at once, so accept states come first
+    std::unordered_map<std::string, std::string> linkedIds;
+    std::unordered_set<std::string> acceptStates;
+    for (const State* state : moduleStates) {
+        std::string id = state->getId();
+
+        if (state->isAcceptState()) {
+            linkedIds[id] = call.returnState;
+            acceptStates.insert(id);
+        } else if (id == startState) {
+            linkedIds[id] = call.state;
+        } else {
+            linkedIds[id] = prefix + id;
+        }
+    }
+
+    // Prefixed states must not merge with states the caller already has
+    for (const State* state : moduleStates) {
+        const std::string& id = state->getId();
+        if (!acceptStates.count(id) && id != startState && machine->getState(linkedIds[id])) {
+            diagnostics.push_back({call.line,
+                "State " + linkedIds[id] + " of module " + call.module + " conflicts with an existing state"});
+            return;
+        }
+    }
+
+    for (const State* state : moduleStates) {
+        const std::string& id = state->getId();
+        if (!acceptStates.count(id) && id != startState) {
+            const std::string& linkedId = linkedIds[id];
+
+            // Rejecting inside a module rejects the whole machine
+            StateType type = state->isRejectState() ? StateType::REJECT : StateType::NORMAL;
+            machine->addState(linkedId, state->getName(), type);
+        }
+    }
+
+    for (const Transition* transition : module.getAllTransitions()) {
+        std::string fromState = transition->getFromState();
+
+        // The module halts in its accept states, the caller takes over from there
+        if (acceptStates.count(fromState)) {
+            continue;
+        }
+
+        std::string linkedFrom = linkedIds[fromState];
+        std::string readSymbol = transition->getReadSymbol();
+
+        if (machine->getTransition(linkedFrom, readSymbol)) {
+            diagnostics.push_back({call.line,
+                "Transition f(" + linkedFrom + ", " + readSymbol + ") of module " + call.module +
+                " conflicts with an existing definition"});
+            continue;
+        }
+
+        machine->addTransition(linkedFrom, readSymbol, linkedIds[transition->getToState()],
+                               transition->getWriteSymbol(), transition->getDirection());
+    }
+}
+
+std::string MachineLinker::resolvePath(const std::string& baseDirectory, const std::string& path)
+{
+    QDir directory(QString::fromStdString(baseDirectory));
+    QFileInfo info(directory.absoluteFilePath(QString::fromStdString(path)));
+    return info.canonicalFilePath().toStdString();
+}
+
+std::string MachineLinker::hashKeys(const std::string& keys)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::fromStdString(keys));
+    return hash.result().toHex().toStdString();
+}
\ No newline at end of file
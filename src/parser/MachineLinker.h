@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "CodeParser.h"
+
+class TuringMachine;
+
+/**
+ * Links machine code that calls other machines into one flat machine.
+ *
+ * Each c(state, module, return_state) call copies the module's states in
+ * under a per-call prefix. The module's start state becomes the calling
+ * state, and transitions into its accept states continue in return_state,
+ * so running the linked machine costs the same as a hand-written one.
+ * Linked modules are kept by a hash of their source and of every module
+ * they declare, so relinking only recompiles modules whose files changed.
+ */
+class MachineLinker {
+public:
+    MachineLinker();
+    ~MachineLinker();
+
+    // Parse code, resolve module paths against baseDirectory and link every call
+    bool linkAndUpdateMachine(TuringMachine* machine, std::string_view code, const std::string& baseDirectory);
+
+    // Problems reported by the last link, including the parser's own diagnostics
+    const std::vector<ParseDiagnostic>& getDiagnostics() const { return m_diagnostics; }
+
+    // Hash of every module pulled in by the last link, empty without modules
+    const std::string& getModuleHash() const { return m_moduleHash; }
+
+    // Hash of the modules code declares, without linking anything
+    std::string hashModules(std::string_view code, const std::string& baseDirectory);
+
+    // Drop every linked module kept from earlier links
+    void clearCache();
+
+private:
+    std::vector<ParseDiagnostic> m_diagnostics;
+    std::string m_moduleHash;
+
+    // Linked modules by module key, shared between every machine calling them
+    std::unordered_map<std::string, std::shared_ptr<const TuringMachine>> m_linkedModules;
+
+    // Module keys computed during the current link, by canonical file path
+    std::unordered_map<std::string, std::string> m_moduleKeys;
+
+    // Canonical paths of the modules whose keys are being computed, to detect cycles
+    std::vector<std::string> m_keyStack;
+
+    // Key of a module file: its source hash combined with the keys of the modules it declares
+    bool moduleKey(const std::string& path, std::string& key, std::string& error);
+
+    // Load a module from the cache, or parse and link it
+    std::shared_ptr<const TuringMachine> linkModule(const std::string& path, std::string& key, std::string& error);
+
+    // Link the modules a parsed machine declares and inline each of its calls
+    void resolveCalls(TuringMachine* machine, const CodeParser& parser, const std::string& baseDirectory,
+                      std::vector<ParseDiagnostic>& diagnostics, std::string& keys);
+
+    // Copy a linked module into the machine for a single call site
+    static void inlineModule(TuringMachine* machine, const TuringMachine& module, const ModuleCall& call,
+                             std::vector<ParseDiagnostic>& diagnostics);
+
+    // Canonical path of a module file, or empty if it does not exist
+    static std::string resolvePath(const std::string& baseDirectory, const std::string& path);
+
+    static std::string hashKeys(const std::string& keys);
+};
\ No newline at end of file
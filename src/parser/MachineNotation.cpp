@@ -0,0 +1,653 @@
+#include "MachineNotation.h"
+#include "SourceFile.h"
+#include "CodeLexer.h"
+#include "../model/TuringMachine.h"
+#include <QDebug>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t MaxStandardStates = 26;
+constexpr size_t MaxStandardSymbols = 10;
+
+// Halt target of "---" in the standard notation, a letter no state uses
+const std::string StandardHaltState = "Z";
+
+QString quoted(std::string_view text)
+{
+    return QString::fromStdString(std::string(text));
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view text)
+{
+    size_t start = 0;
+    while (start < text.size() && isSpace(text[start])) {
+        start++;
+    }
+    size_t end = text.size();
+    while (end > start && isSpace(text[end - 1])) {
+        end--;
+    }
+    return text.substr(start, end - start);
+}
+
+// Whitespace separated fields of a line, up to and excluding a ';' comment
+void splitFields(std::string_view line, std::vector<std::string_view>& fields)
+{
+    fields.clear();
+    size_t comment = line.find(';');
+    if (comment != std::string_view::npos) {
+        line = line.substr(0, comment);
+    }
+
+    size_t position = 0;
+    while (position < line.size()) {
+        while (position < line.size() && isSpace(line[position])) {
+            position++;
+        }
+        size_t start = position;
+        while (position < line.size() && !isSpace(line[position])) {
+            position++;
+        }
+        if (position > start) {
+            fields.push_back(line.substr(start, position - start));
+        }
+    }
+}
+
+// Call visit with each line and its 1-based number
+template <typename Visit>
+void forEachLine(std::string_view text, Visit visit)
+{
+    size_t number = 1;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        if (!visit(text.substr(start, end - start), number)) {
+            return;
+        }
+        start = end + 1;
+        number++;
+    }
+}
+
+const std::string& letterId(size_t index)
+{
+    static const std::vector<std::string> ids = [] {
+        std::vector<std::string> letters;
+        for (char letter = 'A'; letter <= 'Z'; ++letter) {
+            letters.emplace_back(1, letter);
+        }
+        return letters;
+    }();
+    return ids[index];
+}
+
+// Symbol 0 is the blank, the others are their digits
+const std::string& digitSymbol(size_t digit)
+{
+    static const std::vector<std::string> symbols = [] {
+        std::vector<std::string> digits{"_"};
+        for (char digit = '1'; digit <= '9'; ++digit) {
+            digits.emplace_back(1, digit);
+        }
+        return digits;
+    }();
+    return symbols[digit];
+}
+
+// Digit of a symbol in the standard notation, -1 if it has none
+int symbolDigit(const std::string& symbol)
+{
+    if (symbol == "_" || symbol.empty()) {
+        return 0;
+    }
+    if (symbol.size() == 1 && symbol[0] >= '0' && symbol[0] <= '9') {
+        return symbol[0] - '0';
+    }
+    return -1;
+}
+
+bool isHalting(const State* state)
+{
+    return state->isAcceptState() || state->isRejectState();
+}
+
+// Make a state reference unique among those already taken
+std::string uniqueName(const std::string& name, std::unordered_set<std::string>& taken,
+                       const char* separator)
+{
+    std::string unique = name;
+    for (int suffix = 2; !taken.insert(unique).second; ++suffix) {
+        unique = name + separator + std::to_string(suffix);
+    }
+    return unique;
+}
+
+// Running states in the order the notations number them, the start state first
+std::vector<const State*> orderStates(const TuringMachine& machine,
+                                      std::vector<const State*>* halting = nullptr)
+{
+    std::vector<const State*> running;
+    for (const State* state : machine.getAllStates()) {
+        if (isHalting(state)) {
+            if (halting) {
+                halting->push_back(state);
+            }
+        } else if (state->isStartState()) {
+            running.insert(running.begin(), state);
+        } else {
+            running.push_back(state);
+        }
+    }
+    return running;
+}
+
+} // namespace
+
+bool MachineNotation::parse(std::string_view text, Format format, TuringMachine& machine)
+{
+    switch (format) {
+        case Format::STANDARD:
+            return parseStandard(text, machine);
+        case Format::MORPHETT:
+            return parseMorphett(text, machine);
+    }
+    return false;
+}
+
+bool MachineNotation::parseStandard(std::string_view text, TuringMachine& machine)
+{
+    text = trim(text);
+
+    // Every state is the same number of three character transitions, separated by '_'
+    size_t stateCount = std::count(text.begin(), text.end(), '_') + 1;
+    size_t stateWidth = (text.size() + 1) / stateCount - 1;
+    size_t symbolCount = stateWidth / 3;
+    if (text.empty() || (text.size() + 1) % stateCount != 0 || stateWidth % 3 != 0 ||
+        symbolCount == 0 || symbolCount > MaxStandardSymbols || stateCount > MaxStandardStates) {
+        qWarning() << "Malformed machine:" << quoted(text);
+        return false;
+    }
+
+    // Check everything before touching the machine
+    bool haltsInPlace = false;
+    uint32_t haltLetters = 0;
+    for (size_t state = 0; state < stateCount; ++state) {
+        size_t offset = state * (stateWidth + 1);
+        if (offset + stateWidth < text.size() && text[offset + stateWidth] != '_') {
+            qWarning() << "Malformed machine:" << quoted(text);
+            return false;
+        }
+
+        for (size_t symbol = 0; symbol < symbolCount; ++symbol) {
+            std::string_view cell = text.substr(offset + symbol * 3, 3);
+            if (cell == "---") {
+                haltsInPlace = true;
+                continue;
+            }
+
+            size_t write = static_cast<size_t>(cell[0] - '0');
+            bool validMove = cell[1] == 'L' || cell[1] == 'R';
+            bool validNext = cell[2] >= 'A' && cell[2] <= 'Z';
+            if (cell[0] < '0' || write >= symbolCount || !validMove || !validNext) {
+                qWarning() << "Malformed transition" << quoted(cell)
+                           << "in machine:" << quoted(text);
+                return false;
+            }
+            if (static_cast<size_t>(cell[2] - 'A') >= stateCount) {
+                haltLetters |= 1u << (cell[2] - 'A');
+            }
+        }
+    }
+    if (haltsInPlace && stateCount == MaxStandardStates) {
+        qWarning() << "No letter left for the halt state of machine:"
+                   << quoted(text);
+        return false;
+    }
+
+    machine.clear();
+    for (size_t state = 0; state < stateCount; ++state) {
+        machine.addState(letterId(state), "", state == 0 ? StateType::START : StateType::NORMAL);
+    }
+    for (size_t letter = stateCount; letter < MaxStandardStates; ++letter) {
+        if (haltLetters & (1u << letter)) {
+            machine.addState(letterId(letter), "", StateType::ACCEPT);
+        }
+    }
+    if (haltsInPlace) {
+        machine.addState(StandardHaltState, "", StateType::ACCEPT);
+    }
+    machine.setStartState(letterId(0));
+
+    for (size_t state = 0; state < stateCount; ++state) {
+        size_t offset = state * (stateWidth + 1);
+        for (size_t symbol = 0; symbol < symbolCount; ++symbol) {
+            std::string_view cell = text.substr(offset + symbol * 3, 3);
+            const std::string& read = digitSymbol(symbol);
+            if (cell == "---") {
+                machine.addTransition(letterId(state), read, StandardHaltState, read, Direction::STAY);
+                continue;
+            }
+
+            machine.addTransition(letterId(state), read, letterId(cell[2] - 'A'),
+                                  digitSymbol(cell[0] - '0'),
+                                  cell[1] == 'L' ? Direction::LEFT : Direction::RIGHT);
+        }
+    }
+
+    return true;
+}
+
+bool MachineNotation::parseMorphett(std::string_view text, TuringMachine& machine)
+{
+    struct Rule {
+        std::string_view state;
+        std::string_view read;
+        std::string_view write;
+        Direction move;
+        std::string_view next;
+    };
+
+    std::vector<Rule> rules;
+    std::vector<std::string_view> fields;
+    bool valid = true;
+    forEachLine(text, [&](std::string_view line, size_t number) {
+        splitFields(line, fields);
+        if (fields.empty()) {
+            return true;
+        }
+
+        // An optional sixth column '!' is a breakpoint
+        Rule rule;
+        bool validShape = fields.size() == 5 || (fields.size() == 6 && fields[5] == "!");
+        if (validShape) {
+            std::string_view move = fields[3];
+            if (move == "l" || move == "L") {
+                rule.move = Direction::LEFT;
+            } else if (move == "r" || move == "R") {
+                rule.move = Direction::RIGHT;
+            } else if (move == "*" || move == "n" || move == "N") {
+                rule.move = Direction::STAY;
+            } else {
+                validShape = false;
+            }
+        }
+        if (!validShape || fields[0] == "*") {
+            qWarning() << "Malformed rule on line" << number << ":"
+                       << quoted(line);
+            valid = false;
+            return false;
+        }
+
+        rule.state = fields[0];
+        rule.read = fields[1];
+        rule.write = fields[2];
+        rule.next = fields[4];
+        rules.push_back(rule);
+        return true;
+    });
+    if (!valid) {
+        return false;
+    }
+    if (rules.empty()) {
+        qWarning() << "No rules in machine";
+        return false;
+    }
+
+    // State names become identifiers, the original name is kept where it differs
+    std::unordered_map<std::string_view, std::string> ids;
+    std::unordered_set<std::string> takenIds;
+    std::vector<std::string_view> order;
+    auto idFor = [&](std::string_view name) -> const std::string& {
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+
+        std::string id(name);
+        for (char& c : id) {
+            if (!CodeLexer::isIdentifierChar(c)) {
+                c = '_';
+            }
+        }
+        order.push_back(name);
+        return ids.emplace(name, uniqueName(id, takenIds, "_")).first->second;
+    };
+
+    std::vector<std::string_view> alphabet{"_"};
+    std::unordered_set<std::string_view> knownSymbols{"_"};
+    auto addSymbol = [&](std::string_view symbol) {
+        if (symbol != "*" && knownSymbols.insert(symbol).second) {
+            alphabet.push_back(symbol);
+        }
+    };
+
+    bool hasInitialState = false;
+    for (const Rule& rule : rules) {
+        idFor(rule.state);
+        if (rule.next != "*") {
+            idFor(rule.next);
+        }
+        addSymbol(rule.read);
+        addSymbol(rule.write);
+        hasInitialState = hasInitialState || rule.state == "0";
+    }
+
+    machine.clear();
+    std::string_view initialState = hasInitialState ? std::string_view("0") : rules.front().state;
+    for (std::string_view name : order) {
+        StateType type = StateType::NORMAL;
+        if (name.substr(0, 11) == "halt-reject") {
+            type = StateType::REJECT;
+        } else if (name.substr(0, 4) == "halt") {
+            type = StateType::ACCEPT;
+        } else if (name == initialState) {
+            type = StateType::START;
+        }
+
+        const std::string& id = ids[name];
+        machine.addState(id, id == name ? std::string() : std::string(name), type);
+    }
+    machine.setStartState(ids[initialState]);
+
+    // The first rule matching a symbol exactly wins, wildcard rules cover the rest of the alphabet
+    std::map<std::pair<std::string_view, std::string_view>, const Rule*> chosen;
+    for (const Rule& rule : rules) {
+        if (rule.read != "*") {
+            chosen.emplace(std::make_pair(rule.state, rule.read), &rule);
+        }
+    }
+    for (const Rule& rule : rules) {
+        if (rule.read == "*") {
+            for (std::string_view symbol : alphabet) {
+                chosen.emplace(std::make_pair(rule.state, symbol), &rule);
+            }
+        }
+    }
+
+    for (const auto& entry : chosen) {
+        const Rule& rule = *entry.second;
+        std::string_view read = entry.first.second;
+        std::string_view write = rule.write == "*" ? read : rule.write;
+        std::string_view next = rule.next == "*" ? rule.state : rule.next;
+        machine.addTransition(ids[rule.state], std::string(read), ids[next], std::string(write), rule.move);
+    }
+
+    return true;
+}
+
+bool MachineNotation::write(const TuringMachine& machine, Format format, std::string& text)
+{
+    switch (format) {
+        case Format::STANDARD:
+            return writeStandard(machine, text);
+        case Format::MORPHETT:
+            return writeMorphett(machine, text);
+    }
+    return false;
+}
+
+bool MachineNotation::writeStandard(const TuringMachine& machine, std::string& text)
+{
+    std::vector<const State*> halting;
+    std::vector<const State*> running = orderStates(machine, &halting);
+    if (running.empty() || running.size() > MaxStandardStates ||
+        (!halting.empty() && running.size() == MaxStandardStates)) {
+        qWarning() << "Machines in the standard notation have 1 to 26 states, this one has" << running.size();
+        return false;
+    }
+
+    // Running states are lettered from A, halt states keep a free letter of their own where they have one
+    std::unordered_map<std::string, char> letters;
+    uint32_t taken = 0;
+    for (size_t index = 0; index < running.size(); ++index) {
+        letters[running[index]->getId()] = static_cast<char>('A' + index);
+        taken |= 1u << index;
+    }
+    for (const State* state : halting) {
+        std::string id = state->getId();
+        if (id.size() == 1 && id[0] >= 'A' && id[0] <= 'Z' && !(taken & (1u << (id[0] - 'A')))) {
+            letters[id] = id[0];
+            taken |= 1u << (id[0] - 'A');
+        }
+    }
+    for (const State* state : halting) {
+        if (letters.count(state->getId())) {
+            continue;
+        }
+        // Several halt states share the last free letter when there are more of them than letters
+        int letter = MaxStandardStates - 1;
+        while (letter > 0 && (taken & (1u << letter))) {
+            letter--;
+        }
+        if (taken & (1u << letter)) {
+            letter = MaxStandardStates - 1;
+        }
+        letters[state->getId()] = static_cast<char>('A' + letter);
+        taken |= 1u << letter;
+    }
+
+    std::vector<std::string> cells(running.size() * MaxStandardSymbols, "---");
+    int symbolCount = 2;
+    bool usesBlank = false;
+    bool usesZero = false;
+    for (const Transition* transition : machine.getAllTransitions()) {
+        auto from = letters.find(transition->getFromState());
+        auto to = letters.find(transition->getToState());
+        if (from == letters.end() || to == letters.end() || from->second - 'A' >= static_cast<int>(running.size())) {
+            continue;  // Nothing runs after a halt state
+        }
+
+        std::string readSymbol = transition->getReadSymbol();
+        std::string writeSymbol = transition->getWriteSymbol();
+        int read = symbolDigit(readSymbol);
+        int write = symbolDigit(writeSymbol);
+        if (read < 0 || write < 0) {
+            qWarning() << "Symbols other than digits can't be written in the standard notation:"
+                       << QString::fromStdString(transition->toFunctionNotation());
+            return false;
+        }
+        for (const std::string* symbol : {&readSymbol, &writeSymbol}) {
+            usesBlank = usesBlank || *symbol == "_" || symbol->empty();
+            usesZero = usesZero || *symbol == "0";
+        }
+        symbolCount = std::max(symbolCount, std::max(read, write) + 1);
+
+        bool halts = to->second - 'A' >= static_cast<int>(running.size());
+        Direction move = transition->getDirection();
+        std::string& cell = cells[(from->second - 'A') * MaxStandardSymbols + read];
+        if (halts && move == Direction::STAY && read == write) {
+            cell = "---";
+        } else if (move == Direction::STAY) {
+            qWarning() << "Transitions that don't move can't be written in the standard notation:"
+                       << QString::fromStdString(transition->toFunctionNotation());
+            return false;
+        } else {
+            cell = {static_cast<char>('0' + write), move == Direction::LEFT ? 'L' : 'R', to->second};
+        }
+    }
+    if (usesBlank && usesZero) {
+        qWarning() << "The blank and symbol 0 are the same symbol in the standard notation";
+        return false;
+    }
+
+    text.clear();
+    text.reserve(running.size() * (symbolCount * 3 + 1));
+    for (size_t state = 0; state < running.size(); ++state) {
+        if (state > 0) {
+            text += '_';
+        }
+        for (int symbol = 0; symbol < symbolCount; ++symbol) {
+            text += cells[state * MaxStandardSymbols + symbol];
+        }
+    }
+    return true;
+}
+
+bool MachineNotation::writeMorphett(const TuringMachine& machine, std::string& text)
+{
+    auto isToken = [](const std::string& token) {
+        return !token.empty() && token != "*" &&
+               std::none_of(token.begin(), token.end(), [](char c) { return isSpace(c) || c == ';'; });
+    };
+
+    // The start state is 0 and only states named halt... halt, other states are renamed to fit
+    std::vector<const State*> halting;
+    std::vector<const State*> running = orderStates(machine, &halting);
+    std::unordered_map<std::string, std::string> names;
+    std::unordered_set<std::string> taken;
+    for (const State* state : running) {
+        std::string name = isToken(state->getName()) ? state->getName() : state->getId();
+        if (state->isStartState()) {
+            name = "0";
+        } else if (name == "0" || name.compare(0, 4, "halt") == 0) {
+            name = "_" + name;
+        }
+        names[state->getId()] = uniqueName(name, taken, "-");
+    }
+    for (const State* state : halting) {
+        std::string name = isToken(state->getName()) ? state->getName() : state->getId();
+        if (state->isRejectState() && name.compare(0, 11, "halt-reject") != 0) {
+            name = "halt-reject";
+        } else if (state->isAcceptState() && name.compare(0, 4, "halt") != 0) {
+            name = "halt-accept";
+        }
+        names[state->getId()] = uniqueName(name, taken, "-");
+    }
+
+    text.clear();
+    for (const Transition* transition : machine.getAllTransitions()) {
+        std::string read = transition->getReadSymbol();
+        std::string write = transition->getWriteSymbol();
+        for (const std::string* symbol : {&read, &write}) {
+            if (symbol->size() != 1 || !isToken(*symbol)) {
+                qWarning() << "Only single character symbols can be written in the Morphett notation:"
+                           << QString::fromStdString(transition->toFunctionNotation());
+                return false;
+            }
+        }
+
+        const char* move = "*";
+        if (transition->getDirection() == Direction::LEFT) {
+            move = "l";
+        } else if (transition->getDirection() == Direction::RIGHT) {
+            move = "r";
+        }
+
+        text += names[transition->getFromState()];
+        text += ' ';
+        text += read;
+        text += ' ';
+        text += write;
+        text += ' ';
+        text += move;
+        text += ' ';
+        text += names[transition->getToState()];
+        text += '\n';
+    }
+    return true;
+}
+
+std::string MachineNotation::toCode(const TuringMachine& machine)
+{
+    std::vector<const State*> halting;
+    std::vector<const State*> states = orderStates(machine, &halting);
+    states.insert(states.end(), halting.begin(), halting.end());
+
+    std::string code;
+    for (const State* state : states) {
+        char keyword = 'q';
+        if (state->isStartState()) {
+            keyword = 's';
+        } else if (state->isAcceptState()) {
+            keyword = 'a';
+        } else if (state->isRejectState()) {
+            keyword = 'r';
+        }
+
+        std::string name = state->getName();
+        code += keyword;
+        code += '(';
+        code += state->getId();
+        if (!name.empty() && name != state->getId()) {
+            code += ", ";
+            code += name;
+        }
+        code += ")\n";
+    }
+
+    for (const Transition* transition : machine.getAllTransitions()) {
+        code += transition->toFunctionNotation();
+        code += '\n';
+    }
+    return code;
+}
+
+MachineNotation::Format MachineNotation::detectFormat(std::string_view text)
+{
+    Format format = Format::STANDARD;
+    std::vector<std::string_view> fields;
+    forEachLine(text, [&](std::string_view line, size_t) {
+        splitFields(line, fields);
+        if (fields.empty()) {
+            return true;
+        }
+        if (fields.size() >= 5) {
+            format = Format::MORPHETT;
+        }
+        return false;
+    });
+    return format;
+}
+
+bool MachineNotation::readCorpus(const std::string& path,
+                                 const std::function<bool(std::string_view text, Format format, size_t line)>& visit)
+{
+    SourceFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    std::string_view contents = file.getContents();
+    if (detectFormat(contents) == Format::MORPHETT) {
+        visit(contents, Format::MORPHETT, 1);
+        return true;
+    }
+
+    // The machine is the longest column, next to ids, indices or results
+    forEachLine(contents, [&visit](std::string_view line, size_t number) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';' || line.substr(0, 2) == "//") {
+            return true;
+        }
+
+        std::string_view machine;
+        size_t position = 0;
+        while (position < line.size()) {
+            size_t end = line.find_first_of(" \t,", position);
+            if (end == std::string_view::npos) {
+                end = line.size();
+            }
+            if (end - position > machine.size()) {
+                machine = line.substr(position, end - position);
+            }
+            position = end + 1;
+        }
+        return visit(machine, Format::STANDARD, number);
+    });
+    return true;
+}
\ No newline at end of file
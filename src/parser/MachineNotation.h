@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+class TuringMachine;
+
+/**
+ * Converts machines to and from notations used by other simulators and
+ * machine corpora, filling the machine directly instead of going through
+ * CodeParser.
+ *
+ * Standard: the compact busy beaver text format, e.g. 1RB1LC_1RC1RB_...
+ * States are the letters A, B, ... starting at A, each state lists what
+ * it does for the symbols 0, 1, ... as write symbol, move and next state.
+ * A letter without a state of its own halts, "---" halts without moving.
+ * Symbol 0 is the blank.
+ *
+ * Morphett: one rule per line, "state read write move next" with ";"
+ * comments, "*" wildcards and states named halt... halting. The machine
+ * starts in state 0.
+ */
+class MachineNotation {
+public:
+    enum class Format {
+        STANDARD,
+        MORPHETT
+    };
+
+    // Replace the machine's states and transitions, false and a warning if the text is malformed
+    static bool parse(std::string_view text, Format format, TuringMachine& machine);
+    static bool parseStandard(std::string_view text, TuringMachine& machine);
+    static bool parseMorphett(std::string_view text, TuringMachine& machine);
+
+    // Write the machine in a notation, false and a warning if it can't be expressed there
+    static bool write(const TuringMachine& machine, Format format, std::string& text);
+    static bool writeStandard(const TuringMachine& machine, std::string& text);
+    static bool writeMorphett(const TuringMachine& machine, std::string& text);
+
+    // Code that compiles into the machine, shown in the code editor of imported machines.
+    // Symbols outside [A-Za-z0-9_] have no spelling in the code.
+    static std::string toCode(const TuringMachine& machine);
+
+    // Morphett if the first rule has the five columns of one, standard otherwise
+    static Format detectFormat(std::string_view text);
+
+    // Call visit with each machine of a corpus file and the 1-based line it starts on.
+    // Standard corpora hold one machine per line, optionally among other
+    // columns; a Morphett file is a single program. Stops when visit returns false.
+    static bool readCorpus(const std::string& path,
+                           const std::function<bool(std::string_view text, Format format, size_t line)>& visit);
+};
\ No newline at end of file
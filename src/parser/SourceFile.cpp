@@ -0,0 +1,68 @@
+#include "SourceFile.h"
+#include <QFile>
+#include <QDebug>
+
+SourceFile::SourceFile()
+    : m_mapped(nullptr), m_size(0)
+{
+}
+
+SourceFile::~SourceFile()
+{
+    close();
+}
+
+bool SourceFile::open(const std::string& path)
+{
+    close();
+
+    m_file = std::make_unique<QFile>(QString::fromStdString(path));
+    if (!m_file->open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open source file:" << QString::fromStdString(path);
+        m_file.reset();
+        return false;
+    }
+
+    m_size = m_file->size();
+    if (m_size == 0) {
+        return true;
+    }
+
+    m_mapped = m_file->map(0, m_size);
+    if (!m_mapped) {
+        // Fall back to a plain read, e.g. for pipes or exotic file systems
+        m_fallback = m_file->readAll();
+        m_size = m_fallback.size();
+    }
+
+    return true;
+}
+
+void SourceFile::close()
+{
+    if (m_file) {
+        if (m_mapped) {
+            m_file->unmap(m_mapped);
+        }
+        m_file->close();
+        m_file.reset();
+    }
+
+    m_mapped = nullptr;
+    m_size = 0;
+    m_fallback.clear();
+}
+
+bool SourceFile::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+std::string_view SourceFile::getContents() const
+{
+    if (m_mapped) {
+        return std::string_view(reinterpret_cast<const char*>(m_mapped), static_cast<size_t>(m_size));
+    }
+
+    return std::string_view(m_fallback.constData(), static_cast<size_t>(m_fallback.size()));
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <QByteArray>
+
+class QFile;
+
+/**
+ * Read-only view of a source file on disk. The file is memory-mapped when
+ * possible so that huge generated machines are parsed in place instead of
+ * being copied into a std::string first.
+ */
+class SourceFile {
+public:
+    SourceFile();
+    ~SourceFile();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const;
+    bool isMapped() const { return m_mapped != nullptr; }
+
+    // Valid until close() is called or the object is destroyed
+    std::string_view getContents() const;
+
+private:
+    std::unique_ptr<QFile> m_file;
+    uchar* m_mapped;
+    qint64 m_size;
+    QByteArray m_fallback;  // Used when the file system does not support mapping
+
+    // Prevent copying, the mapping belongs to a single owner
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+};
\ No newline at end of file
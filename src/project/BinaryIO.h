@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QByteArray>
+#include <QtEndian>
+
+/**
+ * Little-endian building blocks shared by the binary file formats
+ * (machine images, project files and execution traces)
+ */
+namespace BinaryIO {
+
+inline void appendU32(QByteArray& out, uint32_t value)
+{
+    uint32_t le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&le), sizeof(le));
+}
+
+// Pad with zero bytes up to the next multiple of four
+inline void alignTo4(QByteArray& out)
+{
+    int padding = (4 - (out.size() & 3)) & 3;
+    out.append(padding, '\0');
+}
+
+inline void appendU64(QByteArray& out, uint64_t value)
+{
+    uint64_t le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&le), sizeof(le));
+}
+
+// LEB128: seven bits per byte, small values take a single byte
+inline void appendVarint(QByteArray& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+// Signed values are zigzag encoded so small negative numbers stay small too
+inline uint64_t zigzagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// FNV-1a, a cheap checksum that tells a complete write from a torn one
+inline uint64_t fnv1a64(const char* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Builds a string table, giving each distinct string one index
+class StringTableBuilder {
+public:
+    uint32_t add(const std::string& str)
+    {
+        auto it = m_indices.find(str);
+        if (it != m_indices.end()) {
+            return it->second;
+        }
+
+        uint32_t index = static_cast<uint32_t>(m_strings.size());
+        m_strings.push_back(str);
+        m_indices.emplace(str, index);
+        return index;
+    }
+
+    const std::vector<std::string>& strings() const { return m_strings; }
+
+private:
+    std::vector<std::string> m_strings;
+    std::unordered_map<std::string, uint32_t> m_indices;
+};
+
+// Bounds-checked sequential reader over a byte range
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size) : m_data(data), m_size(size), m_pos(0), m_ok(true) {}
+
+    uint32_t readU32()
+    {
+        if (!require(sizeof(uint32_t))) {
+            return 0;
+        }
+        uint32_t value = qFromLittleEndian<uint32_t>(m_data + m_pos);
+        m_pos += sizeof(uint32_t);
+        return value;
+    }
+
+    uint64_t readU64()
+    {
+        if (!require(sizeof(uint64_t))) {
+            return 0;
+        }
+        uint64_t value = qFromLittleEndian<uint64_t>(m_data + m_pos);
+        m_pos += sizeof(uint64_t);
+        return value;
+    }
+
+    uint8_t readU8()
+    {
+        if (!require(1)) {
+            return 0;
+        }
+        return static_cast<uint8_t>(m_data[m_pos++]);
+    }
+
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!require(1)) {
+                return 0;
+            }
+            uint8_t byte = static_cast<uint8_t>(m_data[m_pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+
+        m_ok = false;
+        return 0;
+    }
+
+    // Read a u32 at an element index without advancing, for dense arrays
+    uint32_t u32At(size_t base, size_t index) const
+    {
+        return qFromLittleEndian<uint32_t>(m_data + base + index * sizeof(uint32_t));
+    }
+
+    const char* take(size_t bytes)
+    {
+        if (!require(bytes)) {
+            return nullptr;
+        }
+        const char* ptr = m_data + m_pos;
+        m_pos += bytes;
+        return ptr;
+    }
+
+    size_t position() const { return m_pos; }
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos >= m_size; }
+
+    // Jump to an absolute offset, e.g. one taken from an index. A reader
+    // that has failed stays failed.
+    bool seek(size_t position)
+    {
+        m_ok = m_ok && position <= m_size;
+        m_pos = m_ok ? position : m_size;
+        return m_ok;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;
+    bool m_ok;
+
+    bool require(size_t bytes)
+    {
+        if (!m_ok || m_size - m_pos < bytes) {
+            m_ok = false;
+        }
+        return m_ok;
+    }
+};
+
+} // namespace BinaryIO
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "MachineCache.h"
+#include "MachineImage.h"
+#include "../model/TuringMachine.h"
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+MachineCache& MachineCache::getInstance()
+{
+    static MachineCache instance;
+    return instance;
+}
+
+MachineCache::MachineCache()
+{
+    QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (base.isEmpty()) {
+        base = QDir::tempPath() + "/TuringMachineVisualizer";
+    }
+
+    QString directory = base + "/machines";
+    QDir().mkpath(directory);
+    m_directory = directory.toStdString();
+}
+
+MachineCache::~MachineCache()
+{
+}
+
+std::unique_ptr<TuringMachine> MachineCache::load(std::string_view code, std::string_view moduleHash) const
+{
+    QFile file(QString::fromStdString(entryPath(code, moduleHash)));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    qint64 size = file.size();
+    uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+
+    std::unique_ptr<TuringMachine> machine;
+    if (mapped) {
+        machine = MachineImage::decode(reinterpret_cast<const char*>(mapped), static_cast<size_t>(size));
+        file.unmap(mapped);
+    } else {
+        QByteArray data = file.readAll();
+        machine = MachineImage::decode(data.constData(), static_cast<size_t>(data.size()));
+    }
+
+    if (!machine) {
+        // Stale or corrupt entry, drop it so it gets rebuilt
+        file.close();
+        file.remove();
+    }
+
+    return machine;
+}
+
+bool MachineCache::store(std::string_view code, const TuringMachine& machine, std::string_view moduleHash)
+{
+    return store(code, machine, machine.getCurrentState(), moduleHash);
+}
+
+bool MachineCache::store(std::string_view code, const TuringMachine& machine, const std::string& currentState,
+                         std::string_view moduleHash)
+{
+    QSaveFile file(QString::fromStdString(entryPath(code, moduleHash)));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open machine cache entry for writing:" << file.fileName();
+        return false;
+    }
+
+    file.write(MachineImage::encode(machine, currentState));
+    return file.commit();
+}
+
+void MachineCache::restoreProjectFields(TuringMachine& cached, const TuringMachine& project)
+{
+    cached.setName(project.getName());
+
+    for (State* state : cached.getAllStates()) {
+        const State* own = project.getState(state->getId());
+        state->setPosition(own ? own->getPosition() : Point2D());
+    }
+
+    cached.reset();
+}
+
+void MachineCache::restoreProjectFields(TuringMachine& cached, const std::string& projectJson)
+{
+    cached.restoreLayoutFromJson(projectJson);
+    cached.reset();
+}
+
+std::string MachineCache::hashCode(std::string_view code, std::string_view moduleHash)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::fromRawData(code.data(), static_cast<int>(code.size())));
+
+    // Machines without modules keep the key they had before modules existed
+    if (!moduleHash.empty()) {
+        hash.addData(QByteArray::fromRawData(moduleHash.data(), static_cast<int>(moduleHash.size())));
+    }
+    return hash.result().toHex().toStdString();
+}
+
+std::string MachineCache::entryPath(std::string_view code, std::string_view moduleHash) const
+{
+    return m_directory + "/" + hashCode(code, moduleHash) + ".tmc";
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+class TuringMachine;
+
+/**
+ * On-disk cache of compiled machines in the user cache directory, keyed by
+ * a hash of the source code they were compiled from and of any modules
+ * linked into them
+ */
+class MachineCache
+{
+public:
+    static MachineCache& getInstance();
+
+    // Load the machine compiled from this code, or nullptr on a cache miss
+    std::unique_ptr<TuringMachine> load(std::string_view code, std::string_view moduleHash = {}) const;
+
+    // Store the compiled machine for this code, replacing any older entry
+    bool store(std::string_view code, const TuringMachine& machine, std::string_view moduleHash = {});
+
+    // Same, with the current state captured by the caller, for background saves
+    bool store(std::string_view code, const TuringMachine& machine, const std::string& currentState,
+               std::string_view moduleHash);
+
+    static std::string hashCode(std::string_view code, std::string_view moduleHash = {});
+
+    // An entry is shared by every project with the same code, so its machine
+    // name, state positions and current state are those of whichever project
+    // stored it. Take the name and positions from the project's own machine
+    // instead, leaving states it doesn't have unplaced, and start over from
+    // the start state.
+    static void restoreProjectFields(TuringMachine& cached, const TuringMachine& project);
+
+    // Same, from the project's machine saved as JSON, which is not rebuilt
+    static void restoreProjectFields(TuringMachine& cached, const std::string& projectJson);
+
+    std::string getCacheDirectory() const { return m_directory; }
+
+private:
+    MachineCache();
+    ~MachineCache();
+
+    // Prevent copying
+    MachineCache(const MachineCache&) = delete;
+    MachineCache& operator=(const MachineCache&) = delete;
+
+    std::string m_directory;
+
+    std::string entryPath(std::string_view code, std::string_view moduleHash) const;
+};
\ No newline at end of file
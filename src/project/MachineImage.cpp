@@ -0,0 +1,213 @@
+#include "MachineImage.h"
+#include "BinaryIO.h"
+#include "../model/TuringMachine.h"
+#include <QDebug>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using BinaryIO::StringTableBuilder;
+using BinaryIO::appendU32;
+using BinaryIO::BinaryReader;
+
+constexpr uint32_t ImageMagic = 0x49434D54;  // "TMCI" in little-endian
+constexpr size_t HeaderFields = 9;
+constexpr size_t StateFields = 5;
+constexpr size_t TransitionFields = 5;
+
+uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+QByteArray MachineImage::encode(const TuringMachine& machine)
+{
+    return encode(machine, machine.getCurrentState());
+}
+
+QByteArray MachineImage::encode(const TuringMachine& machine, const std::string& currentState)
+{
+    StringTableBuilder strings;
+
+    uint32_t nameIndex = strings.add(machine.getName());
+    uint32_t currentStateIndex = strings.add(currentState);
+
+    std::vector<State*> states = machine.getAllStates();
+    std::vector<Transition*> transitions = machine.getAllTransitions();
+
+    // Collect the records first so the string table is complete before writing
+    std::vector<uint32_t> stateRecords;
+    stateRecords.reserve(states.size() * StateFields);
+    for (const State* state : states) {
+        stateRecords.push_back(strings.add(state->getId()));
+        stateRecords.push_back(strings.add(state->getName()));
+        stateRecords.push_back(static_cast<uint32_t>(state->getType()));
+        stateRecords.push_back(floatBits(state->getPosition().x()));
+        stateRecords.push_back(floatBits(state->getPosition().y()));
+    }
+
+    std::vector<uint32_t> transitionRecords;
+    transitionRecords.reserve(transitions.size() * TransitionFields);
+    for (const Transition* transition : transitions) {
+        transitionRecords.push_back(strings.add(transition->getFromState()));
+        transitionRecords.push_back(strings.add(transition->getReadSymbol()));
+        transitionRecords.push_back(strings.add(transition->getToState()));
+        transitionRecords.push_back(strings.add(transition->getWriteSymbol()));
+        transitionRecords.push_back(static_cast<uint32_t>(transition->getDirection()));
+    }
+
+    const auto& table = strings.strings();
+    size_t blobSize = 0;
+    for (const auto& str : table) {
+        blobSize += str.size();
+    }
+    size_t paddedBlobSize = (blobSize + 3) & ~size_t(3);
+
+    QByteArray out;
+    out.reserve(static_cast<int>(HeaderFields * 4 + (table.size() + 1) * 4 + paddedBlobSize +
+                                 (stateRecords.size() + transitionRecords.size()) * 4));
+
+    // Header
+    appendU32(out, ImageMagic);
+    appendU32(out, Version);
+    appendU32(out, static_cast<uint32_t>(machine.getType()));
+    appendU32(out, nameIndex);
+    appendU32(out, currentStateIndex);
+    appendU32(out, static_cast<uint32_t>(table.size()));
+    appendU32(out, static_cast<uint32_t>(states.size()));
+    appendU32(out, static_cast<uint32_t>(transitions.size()));
+    appendU32(out, static_cast<uint32_t>(paddedBlobSize));
+
+    // String table: offsets, then the concatenated bytes
+    uint32_t offset = 0;
+    for (const auto& str : table) {
+        appendU32(out, offset);
+        offset += static_cast<uint32_t>(str.size());
+    }
+    appendU32(out, offset);
+
+    for (const auto& str : table) {
+        out.append(str.data(), static_cast<int>(str.size()));
+    }
+    out.append(static_cast<int>(paddedBlobSize - blobSize), '\0');
+
+    // Dense arrays
+    for (uint32_t value : stateRecords) {
+        appendU32(out, value);
+    }
+    for (uint32_t value : transitionRecords) {
+        appendU32(out, value);
+    }
+
+    return out;
+}
+
+bool MachineImage::isValid(const char* data, size_t size)
+{
+    BinaryReader reader(data, size);
+    uint32_t magic = reader.readU32();
+    uint32_t version = reader.readU32();
+    return reader.ok() && magic == ImageMagic && version == Version;
+}
+
+std::unique_ptr<TuringMachine> MachineImage::decode(const char* data, size_t size)
+{
+    if (!isValid(data, size)) {
+        qWarning() << "Invalid or outdated machine image";
+        return nullptr;
+    }
+
+    BinaryReader reader(data, size);
+    reader.readU32();  // Magic
+    reader.readU32();  // Version
+    uint32_t machineType = reader.readU32();
+    uint32_t nameIndex = reader.readU32();
+    uint32_t currentStateIndex = reader.readU32();
+    uint32_t stringCount = reader.readU32();
+    uint32_t stateCount = reader.readU32();
+    uint32_t transitionCount = reader.readU32();
+    uint32_t blobSize = reader.readU32();
+
+    size_t offsetsBase = reader.position();
+    const char* offsets = reader.take((static_cast<size_t>(stringCount) + 1) * sizeof(uint32_t));
+    const char* blob = reader.take(blobSize);
+    size_t statesBase = reader.position();
+    const char* stateArray = reader.take(static_cast<size_t>(stateCount) * StateFields * sizeof(uint32_t));
+    size_t transitionsBase = reader.position();
+    const char* transitionArray = reader.take(static_cast<size_t>(transitionCount) * TransitionFields * sizeof(uint32_t));
+
+    if (!reader.ok() || !offsets || !stateArray || !transitionArray) {
+        qWarning() << "Truncated machine image";
+        return nullptr;
+    }
+
+    // Resolve string indices to views into the image, validating each once
+    std::vector<std::string_view> strings(stringCount);
+    for (uint32_t i = 0; i < stringCount; ++i) {
+        uint32_t begin = reader.u32At(offsetsBase, i);
+        uint32_t end = reader.u32At(offsetsBase, i + 1);
+        if (begin > end || end > blobSize) {
+            qWarning() << "Corrupt string table in machine image";
+            return nullptr;
+        }
+        strings[i] = std::string_view(blob + begin, end - begin);
+    }
+
+    auto stringAt = [&strings](uint32_t index, bool& ok) -> std::string {
+        if (index >= strings.size()) {
+            ok = false;
+            return std::string();
+        }
+        return std::string(strings[index]);
+    };
+
+    bool ok = true;
+    auto machine = std::make_unique<TuringMachine>(stringAt(nameIndex, ok),
+                                                   static_cast<MachineType>(machineType));
+
+    for (uint32_t i = 0; i < stateCount && ok; ++i) {
+        size_t field = static_cast<size_t>(i) * StateFields;
+        std::string id = stringAt(reader.u32At(statesBase, field), ok);
+        std::string name = stringAt(reader.u32At(statesBase, field + 1), ok);
+        StateType type = static_cast<StateType>(reader.u32At(statesBase, field + 2));
+
+        machine->addState(id, name, type);
+        State* state = machine->getState(id);
+        if (state) {
+            state->setPosition(Point2D(bitsToFloat(reader.u32At(statesBase, field + 3)),
+                                       bitsToFloat(reader.u32At(statesBase, field + 4))));
+        }
+    }
+
+    for (uint32_t i = 0; i < transitionCount && ok; ++i) {
+        size_t field = static_cast<size_t>(i) * TransitionFields;
+        machine->addTransition(stringAt(reader.u32At(transitionsBase, field), ok),
+                               stringAt(reader.u32At(transitionsBase, field + 1), ok),
+                               stringAt(reader.u32At(transitionsBase, field + 2), ok),
+                               stringAt(reader.u32At(transitionsBase, field + 3), ok),
+                               static_cast<Direction>(reader.u32At(transitionsBase, field + 4)));
+    }
+
+    machine->setCurrentState(stringAt(currentStateIndex, ok));
+
+    if (!ok) {
+        qWarning() << "Machine image references missing strings";
+        return nullptr;
+    }
+
+    return machine;
+}
\ No newline at end of file
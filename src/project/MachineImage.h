@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <QByteArray>
+
+class TuringMachine;
+
+/**
+ * Compact binary image of a compiled TuringMachine: a string table followed
+ * by dense state and transition arrays that reference it by index. Images
+ * can be decoded straight from a memory-mapped file.
+ */
+class MachineImage {
+public:
+    static constexpr uint32_t Version = 1;
+
+    // Serialize the machine's states and transitions (not its source code)
+    static QByteArray encode(const TuringMachine& machine);
+
+    // Same, with the current state captured by the caller. Background saves
+    // use this so the worker never reads state the simulation is changing.
+    static QByteArray encode(const TuringMachine& machine, const std::string& currentState);
+
+    // Rebuild a machine from an image, returns nullptr if the data is invalid
+    static std::unique_ptr<TuringMachine> decode(const char* data, size_t size);
+
+    // Check the header without decoding the whole image
+    static bool isValid(const char* data, size_t size);
+};
\ No newline at end of file
@@ -2,18 +2,27 @@
 #include "../model/TuringMachine.h"
 #include "../document/CodeDocument.h"
 #include "../document/TapeDocument.h"
+#include "MachineCache.h"
+#include "ProjectFile.h"
+#include "ProjectSaver.h"
+#include "ProjectJournal.h"
+#include "../parser/MachineLinker.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QFile>
+#include <QStandardPaths>
 #include <QDebug>
 #include <QUuid>
 
 Project::Project(const std::string& name)
-    : m_name(name), m_isModified(false)
+    : m_name(name), m_isModified(false), m_revision(0), m_machineRevision(0),
+      m_autosaveId(QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString()), m_journalId(0)
 {
+    m_saver = std::make_unique<ProjectSaver>(this);
+
     // Create the Turing machine
-    m_machine = std::make_unique<TuringMachine>(name);
+    m_machine = std::make_shared<TuringMachine>(name);
     
     // Create the code document
     m_codeDocument = std::make_unique<CodeDocument>(this, "Code for " + name);
@@ -24,6 +33,7 @@ Project::Project(const std::string& name)
 
 Project::~Project()
 {
+    m_saver->waitForAllSaves();
 }
 
 std::string Project::getName() const
@@ -57,12 +67,22 @@ bool Project::isModified() const
 
 void Project::setModified(bool modified)
 {
+    if (modified) {
+        m_revision++;
+    }
+
     if (m_isModified != modified) {
         m_isModified = modified;
         emit modificationChanged(m_isModified);
     }
 }
 
+void Project::setMachineModified()
+{
+    m_machineRevision++;
+    setModified(true);
+}
+
 TapeDocument* Project::createTape(const std::string& name)
 {
     std::string id = generateUniqueTapeId();
@@ -95,6 +115,75 @@ std::vector<TapeDocument*> Project::getAllTapes() const
 }
 
 bool Project::saveToFile(const std::string& path)
+{
+    // Written by the saver, after any saves queued before this one
+    m_saver->save(path, true);
+    m_saver->waitForAllSaves();
+    return m_saver->lastSaveSucceeded();
+}
+
+void Project::replaceMachine(std::shared_ptr<TuringMachine> machine)
+{
+    m_machine = std::move(machine);
+}
+
+ProjectSnapshot Project::createSnapshot() const
+{
+    ProjectSnapshot snapshot;
+    snapshot.name = m_name;
+    snapshot.code = m_machine->getOriginalCode();
+    snapshot.moduleHash = m_codeDocument->getModuleHash();
+    snapshot.machine = m_machine;
+    snapshot.currentState = m_machine->getCurrentState();
+    snapshot.run = m_machine->getRunState();
+    snapshot.revision = m_revision;
+    snapshot.machineRevision = m_machineRevision;
+    snapshot.journalId = m_journalId;
+
+    // Tape copies share their cell blocks, a block is only copied when written.
+    // Tapes not loaded yet are copied from their file by the writer.
+    for (const auto& tape : m_tapeDocuments) {
+        ProjectSnapshot::TapeEntry entry;
+        entry.id = tape->getId();
+        entry.name = tape->getName();
+        if (tape->isLoaded()) {
+            entry.tape = *tape->getTape();
+        } else {
+            entry.tape.setHeadPosition(tape->getHeadPosition());
+            entry.source = tape->getSource();
+            entry.cellCount = tape->getCellCount();
+        }
+        snapshot.tapes.push_back(std::move(entry));
+    }
+
+    return snapshot;
+}
+
+void Project::relocateTapes(const ProjectSnapshot& snapshot, const std::vector<TapeSource>& sources,
+                            bool replacedOnly)
+{
+    for (size_t i = 0; i < snapshot.tapes.size() && i < sources.size(); ++i) {
+        TapeDocument* tape = getTape(snapshot.tapes[i].id);
+        if (!tape || tape->isLoaded()) {
+            continue;
+        }
+        if (!replacedOnly || tape->getSource()->path == sources[i].path) {
+            tape->relocate(std::make_shared<TapeSource>(sources[i]));
+        }
+    }
+}
+
+std::string Project::getAutosavePath() const
+{
+    if (!m_filePath.empty()) {
+        return m_filePath + AutosaveSuffix;
+    }
+
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/autosave";
+    return (directory + "/" + QString::fromStdString(m_autosaveId) + ".tmproj").toStdString();
+}
+
+bool Project::exportToJson(const std::string& path) const
 {
     QJsonObject projectJson;
     
@@ -116,6 +205,13 @@ bool Project::saveToFile(const std::string& path)
         tapeJson["id"] = QString::fromStdString(tape->getId());
         tapeJson["name"] = QString::fromStdString(tape->getName());
         tapeJson["content"] = QString::fromStdString(tape->getTape()->getCurrentContent());
+
+        // Every written cell as [start, length, symbols] runs with absolute positions
+        QJsonArray runsArray;
+        tape->getTape()->forEachRun([&runsArray](int start, int length, const std::string& symbols) {
+            runsArray.append(QJsonArray{start, length, QString::fromStdString(symbols)});
+        });
+        tapeJson["runs"] = runsArray;
         tapeJson["headPosition"] = tape->getTape()->getHeadPosition();
         tapesArray.append(tapeJson);
     }
@@ -133,10 +229,12 @@ bool Project::saveToFile(const std::string& path)
     file.write(doc.toJson());
     file.close();
     
-    // Update file path and reset modified flag
-    setFilePath(path);
-    setModified(false);
-    
+    // Keep the compiled machine so reopening the project skips the parser
+    if (!m_machine->getOriginalCode().empty()) {
+        MachineCache::getInstance().store(m_machine->getOriginalCode(), *m_machine,
+                                          m_codeDocument->getModuleHash());
+    }
+
     return true;
 }
 
@@ -147,8 +245,45 @@ std::unique_ptr<Project> Project::loadFromFile(const std::string& path)
         qWarning() << "Failed to open file for reading:" << QString::fromStdString(path);
         return nullptr;
     }
-    
-    QByteArray data = file.readAll();
+
+    // Map the file so binary projects are decoded in place
+    qint64 size = file.size();
+    uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+
+    QByteArray data;
+    if (mapped) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), static_cast<int>(size));
+    } else {
+        data = file.readAll();
+    }
+
+    std::unique_ptr<Project> project;
+    bool binary = ProjectFile::isProjectFile(data.constData(), static_cast<size_t>(data.size()));
+    if (binary) {
+        project = ProjectFile::decode(data.constData(), static_cast<size_t>(data.size()), path);
+    } else {
+        // Projects saved by older versions, or exported, are JSON
+        project = loadFromJson(data, path);
+    }
+
+    // Nothing may reference the mapping once it is gone
+    data.clear();
+    if (mapped) {
+        file.unmap(mapped);
+    }
+
+    // Saves since the file was last written in full are in its journal
+    if (project && binary) {
+        uint64_t journalSize = ProjectJournal::replay(path, project->m_journalId, *project);
+        project->setModified(false);
+        project->m_saver->setBase(path, journalSize);
+    }
+
+    return project;
+}
+
+std::unique_ptr<Project> Project::loadFromJson(const QByteArray& data, const std::string& path)
+{
     QJsonDocument doc = QJsonDocument::fromJson(data);
     
     if (doc.isNull() || !doc.isObject()) {
@@ -165,29 +300,59 @@ std::unique_ptr<Project> Project::loadFromFile(const std::string& path)
     }
     
     auto project = std::make_unique<Project>(projectName);
+
+    // Module paths in the code are relative to the project file
+    project->setFilePath(path);
     
     // Load machine data
     if (projectJson.contains("machine") && projectJson["machine"].isObject()) {
         QJsonObject machineJson = projectJson["machine"].toObject();
-        
+
+        std::string code;
+        if (machineJson.contains("code")) {
+            code = machineJson["code"].toString().toStdString();
+        }
+
+        // An unchanged machine, with unchanged modules, comes straight from the compiled cache
+        std::unique_ptr<TuringMachine> cachedMachine;
+        std::string moduleHash;
+        if (!code.empty()) {
+            MachineLinker linker;
+            moduleHash = linker.hashModules(code, project->m_codeDocument->getBaseDirectory());
+            cachedMachine = MachineCache::getInstance().load(code, moduleHash);
+        }
+
+        std::string machineData;
         if (machineJson.contains("machineData")) {
-            std::string machineData = machineJson["machineData"].toString().toStdString();
-            try {
-                // Create a new machine from JSON
-                auto loadedMachine = TuringMachine::fromJson(machineData);
-                if (loadedMachine) {
-                    project->m_machine = std::move(loadedMachine);
+            machineData = machineJson["machineData"].toString().toStdString();
+        }
+
+        if (cachedMachine) {
+            // The project's own machine holds its name and layout, which a
+            // cached one may not share; only those are read from its JSON
+            MachineCache::restoreProjectFields(*cachedMachine, machineData);
+            project->m_machine = std::move(cachedMachine);
+            project->m_codeDocument->restoreCode(code, moduleHash);
+        } else {
+            if (!machineData.empty()) {
+                try {
+                    // Create a new machine from JSON
+                    auto loadedMachine = TuringMachine::fromJson(machineData);
+                    if (loadedMachine) {
+                        project->m_machine = std::move(loadedMachine);
+                    }
+                } catch (const std::exception& e) {
+                    qWarning() << "Error loading machine data:" << e.what();
                 }
-            } catch (const std::exception& e) {
-                qWarning() << "Error loading machine data:" << e.what();
             }
-        }
-        
-        // Set the code in the code document
-        if (machineJson.contains("code")) {
-            std::string code = machineJson["code"].toString().toStdString();
-            project->m_machine->setOriginalCode(code);
-            project->m_codeDocument->setCode(code);
+
+            if (!code.empty()) {
+                // Set the code in the code document, compiled again in case a module changed
+                project->m_machine->setOriginalCode(std::string());
+                project->m_codeDocument->setCode(code);
+                MachineCache::getInstance().store(code, *project->m_machine,
+                                                  project->m_codeDocument->getModuleHash());
+            }
         }
     }
     
@@ -209,8 +374,21 @@ std::unique_ptr<Project> Project::loadFromFile(const std::string& path)
             // Create a new tape document
             auto tapeDoc = std::make_unique<TapeDocument>(project.get(), id, name);
             
-            // Set content and head position
-            if (tapeJson.contains("content")) {
+            // Set content and head position, runs hold the full tape when present
+            if (tapeJson.contains("runs") && tapeJson["runs"].isArray()) {
+                Tape* tape = tapeDoc->getTape();
+                for (const QJsonValue& runValue : tapeJson["runs"].toArray()) {
+                    QJsonArray run = runValue.toArray();
+                    if (run.size() != 3) continue;
+
+                    int start = run[0].toInt();
+                    int length = run[1].toInt();
+                    std::string symbols = run[2].toString().toStdString();
+                    for (int i = 0; i < length; ++i) {
+                        tape->setCell(start + i, symbols);
+                    }
+                }
+            } else if (tapeJson.contains("content")) {
                 tapeDoc->getTape()->setInitialContent(tapeJson["content"].toString().toStdString());
             }
             
@@ -227,8 +405,6 @@ std::unique_ptr<Project> Project::loadFromFile(const std::string& path)
         project->createTape("Default Tape");
     }
     
-    // Set the file path
-    project->setFilePath(path);
     project->setModified(false);
     
     return project;
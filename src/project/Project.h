@@ -1,14 +1,20 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 #include <QObject>
 
+class QByteArray;
+
 // Forward declarations
 class TuringMachine;
 class CodeDocument;
 class TapeDocument;
+class ProjectSaver;
+struct ProjectSnapshot;
+struct TapeSource;
 
 /**
  * Project class that contains a TuringMachine and associated documents
@@ -31,9 +37,22 @@ public:
     bool isModified() const;
     void setModified(bool modified);
 
+    // Bumped on every modification, tells whether a snapshot is still current
+    uint64_t getRevision() const { return m_revision; }
+
+    // Marks the project modified by an edit to the machine's states,
+    // transitions or layout rather than to its code, which the journal
+    // can't replay; bumps the machine revision the saver compares
+    void setMachineModified();
+    uint64_t getMachineRevision() const { return m_machineRevision; }
+
     // Machine access
     TuringMachine* getMachine() { return m_machine.get(); }
 
+    // Put a machine compiled from new code in place of the current one,
+    // which a running save may go on reading; see TuringMachine::takeOver
+    void replaceMachine(std::shared_ptr<TuringMachine> machine);
+
     // Document management
     CodeDocument* getCodeDocument() { return m_codeDocument.get(); }
 
@@ -41,10 +60,32 @@ public:
     TapeDocument* getTape(const std::string& id) const;
     std::vector<TapeDocument*> getAllTapes() const;
 
-    // File operations
+    // File operations, projects are saved in the binary format.
+    // saveToFile blocks and rewrites the file in full; use getSaver() to
+    // save in the background, appending to the file's journal.
     bool saveToFile(const std::string& path);
     static std::unique_ptr<Project> loadFromFile(const std::string& path);
 
+    // Write the project as JSON, readable by loadFromFile and older versions
+    bool exportToJson(const std::string& path) const;
+
+    // Background saving and autosave
+    ProjectSaver* getSaver() { return m_saver.get(); }
+    ProjectSnapshot createSnapshot() const;
+
+    // Point tapes not loaded yet at their copies in a file just written, given
+    // in snapshot order; optionally only those read from a file it replaced
+    void relocateTapes(const ProjectSnapshot& snapshot, const std::vector<TapeSource>& sources,
+                       bool replacedOnly = false);
+
+    // Id tying the project file to its journal, changed by every full save
+    uint64_t getJournalId() const { return m_journalId; }
+    void setJournalId(uint64_t id) { m_journalId = id; }
+
+    // Saved projects autosave next to their file, untitled ones in the application data directory
+    static constexpr const char* AutosaveSuffix = ".autosave";
+    std::string getAutosavePath() const;
+
     signals:
         void nameChanged(const std::string& newName);
     void modificationChanged(bool modified);
@@ -55,10 +96,23 @@ private:
     std::string m_name;
     std::string m_filePath;
     bool m_isModified;
+    uint64_t m_revision;
+    uint64_t m_machineRevision;
+    std::string m_autosaveId;
+    uint64_t m_journalId;
 
-    std::unique_ptr<TuringMachine> m_machine;
+    std::shared_ptr<TuringMachine> m_machine;  // Shared with the snapshot of a running save
     std::unique_ptr<CodeDocument> m_codeDocument;
     std::vector<std::unique_ptr<TapeDocument>> m_tapeDocuments;
 
+    // Declared last so a running save finishes before the machine and tapes go away
+    std::unique_ptr<ProjectSaver> m_saver;
+
     std::string generateUniqueTapeId() const;
+
+    static std::unique_ptr<Project> loadFromJson(const QByteArray& data, const std::string& path);
+
+    // Binary files and their journals restore the machine and tapes directly
+    friend class ProjectFile;
+    friend class ProjectJournal;
 };
\ No newline at end of file
@@ -0,0 +1,772 @@
+#include "ProjectFile.h"
+#include "BinaryIO.h"
+#include "MachineImage.h"
+#include "Project.h"
+#include "../model/TuringMachine.h"
+#include "../model/Tape.h"
+#include "../document/CodeDocument.h"
+#include "../document/TapeDocument.h"
+#include "../parser/MachineLinker.h"
+#include <QIODevice>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <climits>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using BinaryIO::StringTableBuilder;
+using BinaryIO::appendU32;
+using BinaryIO::BinaryReader;
+
+constexpr uint32_t ProjectMagic = 0x4A504D54;  // "TMPJ" in little-endian
+constexpr size_t HeaderFields = 4;
+constexpr size_t SectionFields = 3;
+constexpr size_t TapeIndexFields = 6;
+
+// Files older than this store their tapes inline, without a tape index
+constexpr uint32_t TapeIndexVersion = 3;
+
+// Section types; unknown types are skipped so newer files stay readable
+enum SectionType : uint32_t {
+    STRINGS = 1,
+    PROJECT,
+    CODE,
+    MACHINE,
+    TAPES,
+    TAPE_INDEX,
+    RUN,
+    SECTION_TYPE_COUNT
+};
+
+// Blank gaps up to this long become a blank run instead of starting a new segment
+constexpr int64_t MaxInlineGap = 64;
+
+// Runs per segment are capped so tapes are streamed in bounded memory
+constexpr size_t MaxRunsPerSegment = 4096;
+
+// Set in a tape block's symbol count when its segments may be compressed
+constexpr uint32_t CompressedSegments = 0x80000000u;
+
+// Segments with fewer runs are always stored as they are
+constexpr size_t MinCompressedRuns = 16;
+
+// Buffered output is handed to the device in pieces of this size
+constexpr int FlushSize = 1 << 20;
+
+struct Section {
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+// Buffers writes to a device and tracks the offset of everything written
+class DeviceWriter {
+public:
+    explicit DeviceWriter(QIODevice& device) : m_device(device), m_offset(0), m_ok(true) {}
+
+    void appendU32(uint32_t value)
+    {
+        BinaryIO::appendU32(m_buffer, value);
+        m_offset += sizeof(uint32_t);
+        if (m_buffer.size() >= FlushSize) {
+            flush();
+        }
+    }
+
+    // Large blocks bypass the buffer
+    void append(const char* data, size_t size)
+    {
+        flush();
+        while (size > 0 && m_ok) {
+            qint64 written = m_device.write(data, static_cast<qint64>(size));
+            if (written <= 0) {
+                m_ok = false;
+                break;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+            m_offset += static_cast<uint64_t>(written);
+        }
+    }
+
+    // Length-prefixed and padded, for short data that belongs in the buffer
+    void appendBytes(const char* data, size_t size)
+    {
+        appendU32(static_cast<uint32_t>(size));
+        m_buffer.append(data, static_cast<int>(size));
+        m_offset += size;
+        alignTo4();
+        if (m_buffer.size() >= FlushSize) {
+            flush();
+        }
+    }
+
+    void appendString(const std::string& str)
+    {
+        appendBytes(str.data(), str.size());
+    }
+
+    void alignTo4()
+    {
+        while (m_offset & 3) {
+            m_buffer.append('\0');
+            m_offset++;
+        }
+    }
+
+    bool flush()
+    {
+        if (m_ok && !m_buffer.isEmpty()) {
+            m_ok = m_device.write(m_buffer) == m_buffer.size();
+        }
+        m_buffer.resize(0);
+        return m_ok;
+    }
+
+    uint64_t offset() const { return m_offset; }
+    bool ok() const { return m_ok; }
+
+private:
+    QIODevice& m_device;
+    QByteArray m_buffer;
+    uint64_t m_offset;
+    bool m_ok;
+};
+
+void writeStringTable(DeviceWriter& out, const std::vector<std::string>& strings)
+{
+    uint32_t blobSize = 0;
+    for (const auto& str : strings) {
+        blobSize += static_cast<uint32_t>(str.size());
+    }
+
+    out.appendU32(static_cast<uint32_t>(strings.size()));
+    out.appendU32(blobSize);
+
+    uint32_t offset = 0;
+    for (const auto& str : strings) {
+        out.appendU32(offset);
+        offset += static_cast<uint32_t>(str.size());
+    }
+    out.appendU32(offset);
+
+    for (const auto& str : strings) {
+        out.append(str.data(), str.size());
+    }
+}
+
+bool readStringTable(const Section& section, std::vector<std::string_view>& strings)
+{
+    BinaryReader reader(section.data, section.size);
+    uint32_t count = reader.readU32();
+    uint32_t blobSize = reader.readU32();
+
+    size_t offsetsBase = reader.position();
+    const char* offsets = reader.take((static_cast<size_t>(count) + 1) * sizeof(uint32_t));
+    const char* blob = reader.take(blobSize);
+    if (!reader.ok() || !offsets || !blob) {
+        return false;
+    }
+
+    strings.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t begin = reader.u32At(offsetsBase, i);
+        uint32_t end = reader.u32At(offsetsBase, i + 1);
+        if (begin > end || end > blobSize) {
+            return false;
+        }
+        strings[i] = std::string_view(blob + begin, end - begin);
+    }
+
+    return true;
+}
+
+// Streams a tape as a self-contained block: its symbols, blank first, then
+// segments of a start position and a run count followed by (length, symbol
+// index) runs. A segment without runs ends the tape. Returns the cell count.
+// With CompressedSegments set in the symbol count, the runs of a segment are
+// length-prefixed and qCompress'ed, a zero length meaning they follow as is.
+// Long runs of repeated patterns shrink many times over this way.
+uint32_t writeTapeBlock(DeviceWriter& out, const Tape& tape)
+{
+    StringTableBuilder symbols;
+    const uint32_t blankIndex = symbols.add(tape.getBlankSymbolAsString());
+
+    uint32_t cellCount = 0;
+    tape.forEachRun([&](int, int length, const std::string& runSymbols) {
+        symbols.add(runSymbols);
+        cellCount += static_cast<uint32_t>(length);
+    });
+
+    out.appendU32(static_cast<uint32_t>(symbols.strings().size()) | CompressedSegments);
+    for (const std::string& symbol : symbols.strings()) {
+        out.appendString(symbol);
+    }
+
+    std::vector<uint32_t> runs;
+    int segmentStart = 0;
+    int64_t segmentEnd = 0;  // One past the last cell of the open segment
+
+    QByteArray packed;
+
+    auto flushSegment = [&]() {
+        out.appendU32(static_cast<uint32_t>(segmentStart));
+        out.appendU32(static_cast<uint32_t>(runs.size() / 2));
+
+        if (runs.size() / 2 >= MinCompressedRuns) {
+            packed.resize(0);
+            for (uint32_t value : runs) {
+                appendU32(packed, value);
+            }
+            QByteArray compressed = qCompress(packed);
+            if (compressed.size() < packed.size()) {
+                out.appendBytes(compressed.constData(), static_cast<size_t>(compressed.size()));
+                runs.clear();
+                return;
+            }
+        }
+
+        out.appendU32(0);
+        for (uint32_t value : runs) {
+            out.appendU32(value);
+        }
+        runs.clear();
+    };
+
+    tape.forEachRun([&](int start, int length, const std::string& runSymbols) {
+        int64_t gap = static_cast<int64_t>(start) - segmentEnd;
+        if (!runs.empty() && (gap > MaxInlineGap || runs.size() / 2 >= MaxRunsPerSegment)) {
+            flushSegment();
+        }
+
+        if (runs.empty()) {
+            segmentStart = start;
+        } else if (gap > 0) {
+            runs.push_back(static_cast<uint32_t>(gap));
+            runs.push_back(blankIndex);
+        }
+
+        runs.push_back(static_cast<uint32_t>(length));
+        runs.push_back(symbols.add(runSymbols));
+        segmentEnd = static_cast<int64_t>(start) + length;
+    });
+
+    if (!runs.empty()) {
+        flushSegment();
+    }
+
+    // End of tape
+    out.appendU32(0);
+    out.appendU32(0);
+    return cellCount;
+}
+
+bool decodeTapeBlock(const char* data, size_t size, Tape& tape)
+{
+    BinaryReader reader(data, size);
+
+    uint32_t symbolCount = reader.readU32();
+    const bool compressed = symbolCount & CompressedSegments;
+    symbolCount &= ~CompressedSegments;
+    if (!reader.ok() || symbolCount == 0 || symbolCount > size / sizeof(uint32_t)) {
+        return false;
+    }
+
+    std::vector<std::string> symbols;
+    symbols.reserve(symbolCount);
+    for (uint32_t i = 0; i < symbolCount; ++i) {
+        uint32_t length = reader.readU32();
+        const char* symbol = reader.take(length);
+        if (!symbol || !reader.take((4 - length % 4) % 4)) {
+            return false;
+        }
+        symbols.emplace_back(symbol, length);
+    }
+
+    // Segments follow until one without runs
+    QByteArray unpacked;
+    while (reader.ok()) {
+        int64_t position = static_cast<int32_t>(reader.readU32());
+        uint32_t runCount = reader.readU32();
+        if (runCount == 0) {
+            break;
+        }
+
+        const size_t runsSize = static_cast<size_t>(runCount) * 2 * sizeof(uint32_t);
+        uint32_t packedSize = compressed ? reader.readU32() : 0;
+        BinaryReader runs(nullptr, 0);
+        if (packedSize > 0) {
+            // Only unpacked once the segment is reached, one segment at a time
+            const char* packed = reader.take(packedSize);
+            if (!packed || !reader.take((4 - packedSize % 4) % 4)) {
+                return false;
+            }
+            unpacked = qUncompress(reinterpret_cast<const uchar*>(packed), static_cast<int>(packedSize));
+            if (static_cast<size_t>(unpacked.size()) != runsSize) {
+                return false;
+            }
+            runs = BinaryReader(unpacked.constData(), runsSize);
+        } else {
+            const char* stored = reader.take(runsSize);
+            if (!stored) {
+                return false;
+            }
+            runs = BinaryReader(stored, runsSize);
+        }
+
+        for (uint32_t run = 0; run < runCount; ++run) {
+            uint32_t length = runs.u32At(0, run * 2);
+            uint32_t symbol = runs.u32At(0, run * 2 + 1);
+            if (symbol >= symbols.size() || position + length > static_cast<int64_t>(INT_MAX) + 1) {
+                return false;
+            }
+
+            // Symbol 0 is the blank, written for short gaps inside a segment
+            if (symbol != 0) {
+                for (uint32_t cell = 0; cell < length; ++cell) {
+                    tape.setCell(static_cast<int>(position + cell), symbols[symbol]);
+                }
+            }
+            position += length;
+        }
+    }
+
+    return reader.ok();
+}
+
+// Reads one tape of a file older than TapeIndexVersion from its TAPES
+// section, symbols being indices into the file's string table. Version 1
+// stores segments with one symbol per cell, version 2 segments of
+// (length, symbol) runs like a tape block.
+bool decodeInlineTape(BinaryReader& reader, uint32_t version,
+                      const std::vector<std::string_view>& strings, Tape& tape)
+{
+    const std::string blank = tape.getBlankSymbolAsString();
+    auto setCells = [&](int64_t position, uint32_t length, uint32_t symbol) {
+        if (symbol >= strings.size() || position + length > static_cast<int64_t>(INT_MAX) + 1) {
+            return false;
+        }
+        const std::string symbols(strings[symbol]);
+        if (symbols != blank) {
+            for (uint32_t cell = 0; cell < length; ++cell) {
+                tape.setCell(static_cast<int>(position + cell), symbols);
+            }
+        }
+        return true;
+    };
+
+    if (version == 1) {
+        uint32_t segmentCount = reader.readU32();
+        for (uint32_t s = 0; s < segmentCount && reader.ok(); ++s) {
+            int64_t position = static_cast<int32_t>(reader.readU32());
+            uint32_t cellCount = reader.readU32();
+
+            size_t cellsBase = reader.position();
+            if (!reader.take(static_cast<size_t>(cellCount) * sizeof(uint32_t))) {
+                return false;
+            }
+            for (uint32_t cell = 0; cell < cellCount; ++cell) {
+                if (!setCells(position + cell, 1, reader.u32At(cellsBase, cell))) {
+                    return false;
+                }
+            }
+        }
+        return reader.ok();
+    }
+
+    // Segments follow until one without runs
+    while (reader.ok()) {
+        int64_t position = static_cast<int32_t>(reader.readU32());
+        uint32_t runCount = reader.readU32();
+        if (runCount == 0) {
+            break;
+        }
+
+        size_t runsBase = reader.position();
+        if (!reader.take(static_cast<size_t>(runCount) * 2 * sizeof(uint32_t))) {
+            return false;
+        }
+        for (uint32_t run = 0; run < runCount; ++run) {
+            uint32_t length = reader.u32At(runsBase, run * 2);
+            if (!setCells(position, length, reader.u32At(runsBase, run * 2 + 1))) {
+                return false;
+            }
+            position += length;
+        }
+    }
+    return reader.ok();
+}
+
+int64_t lastModified(const QFileInfo& info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+} // namespace
+
+bool ProjectFile::write(const ProjectSnapshot& snapshot, QIODevice& device,
+                        std::vector<TapeSource>* writtenTapes)
+{
+    StringTableBuilder strings;
+
+    struct Entry {
+        SectionType type;
+        uint64_t offset;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+
+    DeviceWriter out(device);
+
+    auto beginSection = [&](SectionType type) {
+        out.alignTo4();
+        entries.push_back({type, out.offset(), 0});
+    };
+    auto endSection = [&]() {
+        entries.back().size = out.offset() - entries.back().offset;
+    };
+
+    const uint32_t sectionCount = 7;
+
+    // Header, then a section table that is filled in once the offsets are known
+    out.appendU32(ProjectMagic);
+    out.appendU32(Version);
+    out.appendU32(sectionCount);
+    out.appendU32(0);  // Reserved
+    for (size_t i = 0; i < sectionCount * SectionFields; ++i) {
+        out.appendU32(0);
+    }
+
+    beginSection(PROJECT);
+    out.appendU32(strings.add(snapshot.name));
+    out.appendU32(strings.add(snapshot.moduleHash));
+    out.appendU32(static_cast<uint32_t>(snapshot.journalId));
+    out.appendU32(static_cast<uint32_t>(snapshot.journalId >> 32));
+    endSection();
+
+    beginSection(CODE);
+    out.append(snapshot.code.data(), snapshot.code.size());
+    endSection();
+
+    beginSection(MACHINE);
+    QByteArray image = MachineImage::encode(*snapshot.machine, snapshot.currentState);
+    out.append(image.constData(), static_cast<size_t>(image.size()));
+    endSection();
+
+    // Tapes are streamed cell run by cell run, never as one string. Tapes
+    // that were never loaded are copied from their file as stored.
+    std::vector<TapeSource> tapeBlocks;
+    std::vector<uint32_t> cellCounts;
+    beginSection(TAPES);
+    for (const ProjectSnapshot::TapeEntry& entry : snapshot.tapes) {
+        out.alignTo4();
+        TapeSource block;
+        block.offset = static_cast<uint32_t>(out.offset());
+
+        if (entry.source) {
+            QByteArray data;
+            if (!readTapeData(*entry.source, data)) {
+                qWarning() << "Failed to copy tape" << QString::fromStdString(entry.name)
+                           << "from" << QString::fromStdString(entry.source->path);
+                return false;
+            }
+            out.append(data.constData(), static_cast<size_t>(data.size()));
+            cellCounts.push_back(entry.cellCount);
+        } else {
+            cellCounts.push_back(writeTapeBlock(out, entry.tape));
+        }
+
+        block.size = static_cast<uint32_t>(out.offset() - block.offset);
+        tapeBlocks.push_back(block);
+    }
+    endSection();
+
+    // The index is all that is read when the project is opened
+    beginSection(TAPE_INDEX);
+    out.appendU32(static_cast<uint32_t>(snapshot.tapes.size()));
+    for (size_t i = 0; i < snapshot.tapes.size(); ++i) {
+        const ProjectSnapshot::TapeEntry& entry = snapshot.tapes[i];
+        out.appendU32(strings.add(entry.id));
+        out.appendU32(strings.add(entry.name));
+        out.appendU32(static_cast<uint32_t>(entry.tape.getHeadPosition()));
+        out.appendU32(cellCounts[i]);
+        out.appendU32(tapeBlocks[i].offset);
+        out.appendU32(tapeBlocks[i].size);
+    }
+    endSection();
+
+    beginSection(RUN);
+    out.appendU32(static_cast<uint32_t>(snapshot.run.stepCount));
+    out.appendU32(static_cast<uint32_t>(snapshot.run.stepCount >> 32));
+    out.appendU32(static_cast<uint32_t>(snapshot.run.status));
+    out.appendU32(static_cast<uint32_t>(snapshot.run.maxHistorySize));
+    endSection();
+
+    // Strings go last, every other section has added to the table by now
+    beginSection(STRINGS);
+    writeStringTable(out, strings.strings());
+    endSection();
+
+    out.alignTo4();
+    if (!out.flush()) {
+        qWarning() << "Failed to write project file";
+        return false;
+    }
+
+    if (out.offset() > UINT32_MAX) {
+        qWarning() << "Project is too large for the binary format";
+        return false;
+    }
+
+    // Section table: type, offset from the start of the file, unpadded size
+    QByteArray table;
+    for (const Entry& entry : entries) {
+        appendU32(table, entry.type);
+        appendU32(table, static_cast<uint32_t>(entry.offset));
+        appendU32(table, static_cast<uint32_t>(entry.size));
+    }
+
+    uint64_t end = out.offset();
+    if (!device.seek(HeaderFields * sizeof(uint32_t)) || device.write(table) != table.size() ||
+        !device.seek(static_cast<qint64>(end))) {
+        qWarning() << "Failed to write project file section table";
+        return false;
+    }
+
+    if (writtenTapes) {
+        *writtenTapes = std::move(tapeBlocks);
+    }
+    return true;
+}
+
+bool ProjectFile::readTapeData(const TapeSource& source, QByteArray& data)
+{
+    QFile file(QString::fromStdString(source.path));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // Offsets are only meaningful in the file they were read from
+    if (file.size() != source.fileSize || lastModified(QFileInfo(file)) != source.modified) {
+        qWarning() << "Project file changed since it was opened:" << QString::fromStdString(source.path);
+        return false;
+    }
+
+    if (!file.seek(source.offset)) {
+        return false;
+    }
+    data = file.read(source.size);
+    return data.size() == static_cast<int>(source.size);
+}
+
+bool ProjectFile::loadTape(const TapeSource& source, Tape& tape)
+{
+    QByteArray data;
+    return readTapeData(source, data) && decodeTape(data, tape);
+}
+
+bool ProjectFile::decodeTape(const QByteArray& data, Tape& tape)
+{
+    return decodeTapeBlock(data.constData(), static_cast<size_t>(data.size()), tape);
+}
+
+bool ProjectFile::isProjectFile(const char* data, size_t size)
+{
+    BinaryReader reader(data, size);
+    uint32_t magic = reader.readU32();
+    return reader.ok() && magic == ProjectMagic;
+}
+
+std::unique_ptr<Project> ProjectFile::decode(const char* data, size_t size, const std::string& path)
+{
+    BinaryReader reader(data, size);
+    uint32_t magic = reader.readU32();
+    uint32_t version = reader.readU32();
+    uint32_t sectionCount = reader.readU32();
+    reader.readU32();  // Reserved
+
+    if (!reader.ok() || magic != ProjectMagic) {
+        qWarning() << "Not a binary project file";
+        return nullptr;
+    }
+    if (version < MinVersion || version > Version) {
+        qWarning() << "Unsupported project file version" << version;
+        return nullptr;
+    }
+
+    size_t tableBase = reader.position();
+    if (!reader.take(static_cast<size_t>(sectionCount) * SectionFields * sizeof(uint32_t))) {
+        qWarning() << "Truncated project file";
+        return nullptr;
+    }
+
+    Section sections[SECTION_TYPE_COUNT];
+    for (uint32_t i = 0; i < sectionCount; ++i) {
+        size_t field = static_cast<size_t>(i) * SectionFields;
+        uint32_t type = reader.u32At(tableBase, field);
+        uint32_t offset = reader.u32At(tableBase, field + 1);
+        uint32_t length = reader.u32At(tableBase, field + 2);
+
+        if (offset > size || length > size - offset) {
+            qWarning() << "Project file section out of bounds";
+            return nullptr;
+        }
+        if (type < SECTION_TYPE_COUNT) {
+            sections[type] = {data + offset, length};
+        }
+    }
+
+    std::vector<std::string_view> strings;
+    if (!sections[STRINGS].data || !readStringTable(sections[STRINGS], strings)) {
+        qWarning() << "Corrupt string table in project file";
+        return nullptr;
+    }
+
+    bool ok = true;
+    auto stringAt = [&strings, &ok](uint32_t index) -> std::string {
+        if (index >= strings.size()) {
+            ok = false;
+            return std::string();
+        }
+        return std::string(strings[index]);
+    };
+
+    // Project metadata
+    BinaryReader projectReader(sections[PROJECT].data, sections[PROJECT].size);
+    std::string name = stringAt(projectReader.readU32());
+    std::string moduleHash = stringAt(projectReader.readU32());
+    if (!projectReader.ok() || !ok) {
+        qWarning() << "Corrupt project metadata";
+        return nullptr;
+    }
+
+    // Files written before journaling have no journal id
+    uint64_t journalId = 0;
+    if (!projectReader.atEnd()) {
+        journalId = projectReader.readU32();
+        journalId |= static_cast<uint64_t>(projectReader.readU32()) << 32;
+    }
+
+    auto project = std::make_unique<Project>(name);
+    project->setJournalId(journalId);
+
+    // Module paths in the code are relative to the project file
+    project->setFilePath(path);
+
+    // The compiled machine is decoded straight from the mapped image
+    std::unique_ptr<TuringMachine> machine;
+    if (sections[MACHINE].data) {
+        machine = MachineImage::decode(sections[MACHINE].data, sections[MACHINE].size);
+    }
+    if (!machine) {
+        qWarning() << "Missing or corrupt machine in project file";
+        return nullptr;
+    }
+    project->m_machine = std::move(machine);
+
+    std::string code(sections[CODE].data ? sections[CODE].data : "", sections[CODE].size);
+    if (!code.empty()) {
+        // Relink if a module the machine was built from has changed since it was saved
+        MachineLinker linker;
+        std::string currentHash = linker.hashModules(code, project->m_codeDocument->getBaseDirectory());
+        if (currentHash == moduleHash) {
+            project->m_codeDocument->restoreCode(code, moduleHash);
+        } else {
+            project->m_codeDocument->setCode(code);
+        }
+    }
+
+    // Files written before runs were saved start from step 0
+    if (sections[RUN].data) {
+        BinaryReader runReader(sections[RUN].data, sections[RUN].size);
+        RunState run;
+        run.stepCount = runReader.readU32();
+        run.stepCount |= static_cast<uint64_t>(runReader.readU32()) << 32;
+        uint32_t status = runReader.readU32();
+        run.maxHistorySize = static_cast<int>(runReader.readU32());
+        if (!runReader.ok() || status > static_cast<uint32_t>(ExecutionStatus::ERROR) ||
+            run.maxHistorySize <= 0) {
+            qWarning() << "Corrupt run state in project file";
+            return nullptr;
+        }
+        run.status = static_cast<ExecutionStatus>(status);
+        project->m_machine->restoreRunState(run);
+    }
+
+    project->m_tapeDocuments.clear();
+
+    // Older files have no tape index, their tapes are read right away
+    if (version < TapeIndexVersion) {
+        BinaryReader tapeReader(sections[TAPES].data, sections[TAPES].size);
+        uint32_t tapeCount = tapeReader.readU32();
+        for (uint32_t i = 0; i < tapeCount && tapeReader.ok() && ok; ++i) {
+            std::string id = stringAt(tapeReader.readU32());
+            std::string tapeName = stringAt(tapeReader.readU32());
+            int headPosition = static_cast<int>(tapeReader.readU32());
+
+            auto tapeDoc = std::make_unique<TapeDocument>(project.get(), id, tapeName);
+            Tape* tape = tapeDoc->getTape();
+            ok = ok && decodeInlineTape(tapeReader, version, strings, *tape);
+            tape->setHeadPosition(headPosition);
+            project->m_tapeDocuments.push_back(std::move(tapeDoc));
+        }
+
+        if (!tapeReader.ok() || !ok) {
+            qWarning() << "Corrupt tape data in project file";
+            return nullptr;
+        }
+    } else {
+        // Only the index is read, each tape's cells are read on first use
+        QFileInfo fileInfo(QString::fromStdString(path));
+        const int64_t fileSize = fileInfo.size();
+        const int64_t modified = lastModified(fileInfo);
+
+        BinaryReader indexReader(sections[TAPE_INDEX].data, sections[TAPE_INDEX].size);
+        uint32_t tapeCount = indexReader.readU32();
+        size_t indexBase = indexReader.position();
+        if (!indexReader.take(static_cast<size_t>(tapeCount) * TapeIndexFields * sizeof(uint32_t))) {
+            qWarning() << "Corrupt tape index in project file";
+            return nullptr;
+        }
+
+        for (uint32_t i = 0; i < tapeCount && ok; ++i) {
+            size_t field = static_cast<size_t>(i) * TapeIndexFields;
+            std::string id = stringAt(indexReader.u32At(indexBase, field));
+            std::string tapeName = stringAt(indexReader.u32At(indexBase, field + 1));
+            int headPosition = static_cast<int>(indexReader.u32At(indexBase, field + 2));
+            uint32_t cellCount = indexReader.u32At(indexBase, field + 3);
+
+            auto source = std::make_shared<TapeSource>();
+            source->path = path;
+            source->offset = indexReader.u32At(indexBase, field + 4);
+            source->size = indexReader.u32At(indexBase, field + 5);
+            source->fileSize = fileSize;
+            source->modified = modified;
+
+            if (source->offset > size || source->size > size - source->offset) {
+                ok = false;
+                break;
+            }
+
+            auto tapeDoc = std::make_unique<TapeDocument>(project.get(), id, tapeName);
+            tapeDoc->setStoredTape(std::move(source), headPosition, cellCount);
+            project->m_tapeDocuments.push_back(std::move(tapeDoc));
+        }
+
+        if (!ok) {
+            qWarning() << "Corrupt tape index in project file";
+            return nullptr;
+        }
+    }
+
+    // If no tapes were stored, create a default one
+    if (project->m_tapeDocuments.empty()) {
+        project->createTape("Default Tape");
+    }
+
+    project->setModified(false);
+    return project;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../model/Tape.h"
+#include "../model/TuringMachine.h"
+
+class Project;
+class QByteArray;
+class QIODevice;
+
+/**
+ * Where one tape's data sits in a project file. Tapes of an opened project
+ * are read from the file when first used; its size and modification time
+ * tell whether the file has been replaced since.
+ */
+struct TapeSource {
+    std::string path;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    int64_t fileSize = 0;
+    int64_t modified = 0;  // Milliseconds since the epoch
+};
+
+/**
+ * Everything a project file holds, captured on the GUI thread so it can be
+ * written from another one. Tapes are copy-on-write copies, tapes never
+ * loaded are copied from their file as stored. The machine is shared, as
+ * compiling puts a new one in its place instead of changing it.
+ */
+struct ProjectSnapshot {
+    struct TapeEntry {
+        std::string id;
+        std::string name;
+        Tape tape;
+        std::shared_ptr<const TapeSource> source;  // Set for tapes not loaded yet
+        uint32_t cellCount = 0;                     // Stored cells of a tape not loaded yet
+    };
+
+    std::string name;
+    std::string code;
+    std::string moduleHash;
+    std::shared_ptr<const TuringMachine> machine;
+    std::string currentState;
+    RunState run;
+    std::vector<TapeEntry> tapes;
+    uint64_t revision = 0;   // Project revision the snapshot was taken at
+    uint64_t machineRevision = 0;  // Of edits to the machine not made through its code
+    uint64_t journalId = 0;  // Journal that may follow the file, see ProjectJournal
+};
+
+/**
+ * Versioned binary project file. A header and a section table are followed
+ * by project metadata, the machine code, the compiled machine as a
+ * MachineImage, the tapes, a tape index, the run state and finally the
+ * string table. Each tape is a self-contained block of run-length encoded
+ * segments with its own symbol list, so it can be read on its own; larger
+ * segments are compressed with qCompress and unpacked one at a time when
+ * the tape is loaded. The index holds only names, ids, sizes and where
+ * each block is. The run state holds the 64-bit step count, so a long run
+ * resumes where it was saved. All sections are 4-byte aligned
+ * little-endian data, so a memory-mapped file is decoded in place without
+ * parsing text.
+ */
+class ProjectFile {
+public:
+    static constexpr uint32_t Version = 4;
+    static constexpr uint32_t MinVersion = 1;  // Oldest version still read, see decode
+
+    // Stream a snapshot to a seekable device; tapes are written run by run.
+    // Where each tape went is reported in snapshot order, without the path.
+    static bool write(const ProjectSnapshot& snapshot, QIODevice& device,
+                      std::vector<TapeSource>* writtenTapes = nullptr);
+
+    // Build a project from file data, returns nullptr if the data is invalid.
+    // Files before version 3 have their tapes inline and are read in full.
+    static std::unique_ptr<Project> decode(const char* data, size_t size, const std::string& path);
+
+    // Read the stored block of a tape, failing if the file has changed since
+    static bool readTapeData(const TapeSource& source, QByteArray& data);
+
+    // Fill an empty tape from its stored block, or from one already read
+    static bool loadTape(const TapeSource& source, Tape& tape);
+    static bool decodeTape(const QByteArray& data, Tape& tape);
+
+    // Check the magic number, telling binary projects apart from JSON ones
+    static bool isProjectFile(const char* data, size_t size);
+};
\ No newline at end of file
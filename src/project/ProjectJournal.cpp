@@ -0,0 +1,375 @@
+#include "ProjectJournal.h"
+#include "BinaryIO.h"
+#include "MachineCache.h"
+#include "Project.h"
+#include "ProjectFile.h"
+#include "../model/TuringMachine.h"
+#include "../model/Tape.h"
+#include "../document/CodeDocument.h"
+#include "../document/TapeDocument.h"
+#include "../parser/MachineLinker.h"
+#include <QFile>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <climits>
+#include <unordered_map>
+
+namespace {
+
+using BinaryIO::BinaryReader;
+using BinaryIO::appendU32;
+using BinaryIO::appendU64;
+using BinaryIO::appendVarint;
+using BinaryIO::zigzagEncode;
+using BinaryIO::zigzagDecode;
+
+constexpr uint32_t JournalMagic = 0x4C4A4D54;  // "TMJL" in little-endian
+constexpr uint32_t JournalVersion = 1;
+constexpr size_t HeaderSize = 16;
+
+// Each record is a tag, a varint payload length and the payload
+enum RecordType : uint8_t {
+    PROJECT_NAME = 1,
+    CODE,          // Code and module hash
+    CURRENT_STATE,
+    TAPE_ADDED,    // Id and name
+    TAPE_NAME,     // Id and name
+    TAPE_HEAD,     // Id and position
+    TAPE_CELLS,    // Id, a position range and the runs now written in it
+    RUN_STATE,     // Step count, status and run options
+    COMMIT = 0x7F  // Checksum of the batch's records, ends the batch
+};
+
+void appendString(QByteArray& out, const std::string& str)
+{
+    appendVarint(out, str.size());
+    out.append(str.data(), static_cast<int>(str.size()));
+}
+
+std::string readString(BinaryReader& reader)
+{
+    uint64_t length = reader.readVarint();
+    const char* data = reader.take(length);
+    return data ? std::string(data, length) : std::string();
+}
+
+void appendRecord(QByteArray& batch, RecordType type, const QByteArray& payload)
+{
+    batch.append(static_cast<char>(type));
+    appendVarint(batch, static_cast<uint64_t>(payload.size()));
+    batch.append(payload);
+}
+
+void appendTapeString(QByteArray& batch, RecordType type, const std::string& id, const std::string& value)
+{
+    QByteArray payload;
+    appendString(payload, id);
+    appendString(payload, value);
+    appendRecord(batch, type, payload);
+}
+
+// The cells of changed blocks, each range replacing what was written there
+void appendTapeCells(QByteArray& batch, const std::string& id, const Tape& tape, const Tape& base)
+{
+    tape.forEachChangedRange(base, [&](int64_t start, int64_t end) {
+        QByteArray payload;
+        appendString(payload, id);
+        appendVarint(payload, zigzagEncode(start));
+        appendVarint(payload, static_cast<uint64_t>(end - start));
+
+        int64_t previousEnd = start;
+        tape.forEachRunInRange(start, end, [&](int runStart, int length, const std::string& symbols) {
+            appendVarint(payload, static_cast<uint64_t>(runStart - previousEnd));
+            appendVarint(payload, static_cast<uint64_t>(length));
+            appendString(payload, symbols);
+            previousEnd = static_cast<int64_t>(runStart) + length;
+        });
+
+        appendRecord(batch, TAPE_CELLS, payload);
+    });
+}
+
+void applyCode(const std::string& code, const std::string& moduleHash,
+               std::shared_ptr<TuringMachine>& machine, CodeDocument& codeDocument)
+{
+    // The saver cached the machine compiled from this code, unless a module has changed since
+    MachineLinker linker;
+    std::string currentHash = linker.hashModules(code, codeDocument.getBaseDirectory());
+    std::unique_ptr<TuringMachine> cached;
+    if (currentHash == moduleHash) {
+        cached = MachineCache::getInstance().load(code, currentHash);
+    }
+
+    if (cached) {
+        MachineCache::restoreProjectFields(*cached, *machine);
+        machine = std::move(cached);
+        codeDocument.restoreCode(code, currentHash);
+    } else {
+        codeDocument.setCode(code);
+    }
+}
+
+} // namespace
+
+uint64_t ProjectJournal::createId()
+{
+    uint64_t id = 0;
+    while (id == 0) {
+        id = QRandomGenerator::global()->generate64();
+    }
+    return id;
+}
+
+bool ProjectJournal::encodeChanges(const ProjectSnapshot& base, const ProjectSnapshot& current, QByteArray& batch)
+{
+    batch.clear();
+
+    if (current.name != base.name) {
+        QByteArray payload;
+        appendString(payload, current.name);
+        appendRecord(batch, PROJECT_NAME, payload);
+    }
+
+    if (current.code != base.code || current.moduleHash != base.moduleHash) {
+        QByteArray payload;
+        appendString(payload, current.code);
+        appendString(payload, current.moduleHash);
+        appendRecord(batch, CODE, payload);
+    }
+
+    // Compiling resets the state, so it follows any code change
+    if (current.currentState != base.currentState || current.code != base.code) {
+        QByteArray payload;
+        appendString(payload, current.currentState);
+        appendRecord(batch, CURRENT_STATE, payload);
+    }
+
+    if (current.run != base.run || current.code != base.code) {
+        QByteArray payload;
+        appendVarint(payload, current.run.stepCount);
+        appendVarint(payload, static_cast<uint64_t>(current.run.status));
+        appendVarint(payload, static_cast<uint64_t>(current.run.maxHistorySize));
+        appendRecord(batch, RUN_STATE, payload);
+    }
+
+    std::unordered_map<std::string, const ProjectSnapshot::TapeEntry*> baseTapes;
+    for (const auto& entry : base.tapes) {
+        baseTapes.emplace(entry.id, &entry);
+    }
+
+    const Tape empty;
+    for (const auto& entry : current.tapes) {
+        auto it = baseTapes.find(entry.id);
+        const ProjectSnapshot::TapeEntry* baseEntry = it != baseTapes.end() ? it->second : nullptr;
+
+        if (!baseEntry) {
+            appendTapeString(batch, TAPE_ADDED, entry.id, entry.name);
+        } else if (entry.name != baseEntry->name) {
+            appendTapeString(batch, TAPE_NAME, entry.id, entry.name);
+        }
+
+        int head = entry.tape.getHeadPosition();
+        if (!baseEntry || head != baseEntry->tape.getHeadPosition()) {
+            QByteArray payload;
+            appendString(payload, entry.id);
+            appendVarint(payload, zigzagEncode(head));
+            appendRecord(batch, TAPE_HEAD, payload);
+        }
+
+        // A tape not loaded yet is as the project file has it
+        if (entry.source) {
+            continue;
+        }
+
+        if (!baseEntry) {
+            appendTapeCells(batch, entry.id, entry.tape, empty);
+        } else if (baseEntry->source) {
+            // Loaded since the base was taken, compare with what the file holds
+            Tape stored;
+            if (!ProjectFile::loadTape(*baseEntry->source, stored)) {
+                qWarning() << "Failed to read tape" << QString::fromStdString(entry.name) << "to journal its changes";
+                return false;
+            }
+            appendTapeCells(batch, entry.id, entry.tape, stored);
+        } else {
+            appendTapeCells(batch, entry.id, entry.tape, baseEntry->tape);
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        QByteArray payload;
+        appendU64(payload, BinaryIO::fnv1a64(batch.constData(), static_cast<size_t>(batch.size())));
+        appendRecord(batch, COMMIT, payload);
+    }
+
+    return true;
+}
+
+bool ProjectJournal::append(const std::string& projectPath, uint64_t journalId, uint64_t validSize,
+                            const QByteArray& batch, uint64_t* newSize)
+{
+    QString path = QString::fromStdString(pathFor(projectPath));
+
+    // Cut off whatever a crash left after the last complete batch
+    bool fresh = validSize < HeaderSize || !QFile::resize(path, static_cast<qint64>(validSize));
+
+    QFile file(path);
+    if (!file.open(fresh ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to open project journal:" << path;
+        return false;
+    }
+
+    QByteArray data;
+    if (fresh) {
+        appendU32(data, JournalMagic);
+        appendU32(data, JournalVersion);
+        appendU64(data, journalId);
+    }
+    data.append(batch);
+
+    if (file.write(data) != data.size() || !file.flush()) {
+        qWarning() << "Failed to write project journal:" << path;
+        return false;
+    }
+    file.close();
+
+    *newSize = (fresh ? 0 : validSize) + static_cast<uint64_t>(data.size());
+    return true;
+}
+
+uint64_t ProjectJournal::replay(const std::string& projectPath, uint64_t journalId, Project& project)
+{
+    QFile file(QString::fromStdString(pathFor(projectPath)));
+    if (journalId == 0 || !file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    BinaryReader header(data.constData(), static_cast<size_t>(data.size()));
+    uint32_t magic = header.readU32();
+    uint32_t version = header.readU32();
+    uint64_t id = header.readU64();
+
+    // A journal left behind by an older version of the file has been folded into it
+    if (!header.ok() || magic != JournalMagic || version != JournalVersion || id != journalId) {
+        return 0;
+    }
+
+    // Find the complete batches first, a torn one at the end is ignored
+    BinaryReader reader(data.constData(), static_cast<size_t>(data.size()));
+    reader.seek(HeaderSize);
+    size_t batchStart = HeaderSize;
+    size_t validEnd = HeaderSize;
+    while (!reader.atEnd()) {
+        size_t recordStart = reader.position();
+        uint8_t type = reader.readU8();
+        uint64_t length = reader.readVarint();
+        const char* payload = reader.take(length);
+        if (!reader.ok() || !payload) {
+            break;
+        }
+
+        if (type == COMMIT) {
+            BinaryReader commit(payload, length);
+            uint64_t checksum = commit.readU64();
+            if (!commit.ok() ||
+                checksum != BinaryIO::fnv1a64(data.constData() + batchStart, recordStart - batchStart)) {
+                break;
+            }
+            validEnd = reader.position();
+            batchStart = validEnd;
+        }
+    }
+
+    reader.seek(HeaderSize);
+    while (reader.position() < validEnd) {
+        uint8_t type = reader.readU8();
+        uint64_t length = reader.readVarint();
+        BinaryReader record(reader.take(length), length);
+
+        switch (type) {
+            case PROJECT_NAME:
+                project.setName(readString(record));
+                break;
+            case CODE: {
+                std::string code = readString(record);
+                std::string moduleHash = readString(record);
+                applyCode(code, moduleHash, project.m_machine, *project.m_codeDocument);
+                break;
+            }
+            case CURRENT_STATE:
+                project.m_machine->setCurrentState(readString(record));
+                break;
+            case RUN_STATE: {
+                RunState run;
+                run.stepCount = record.readVarint();
+                uint64_t status = record.readVarint();
+                uint64_t maxHistorySize = record.readVarint();
+                if (record.ok() && status <= static_cast<uint64_t>(ExecutionStatus::ERROR) &&
+                    maxHistorySize > 0 && maxHistorySize <= INT_MAX) {
+                    run.status = static_cast<ExecutionStatus>(status);
+                    run.maxHistorySize = static_cast<int>(maxHistorySize);
+                    project.m_machine->restoreRunState(run);
+                }
+                break;
+            }
+            case TAPE_ADDED: {
+                std::string tapeId = readString(record);
+                std::string name = readString(record);
+                if (!project.getTape(tapeId)) {
+                    project.m_tapeDocuments.push_back(std::make_unique<TapeDocument>(&project, tapeId, name));
+                }
+                break;
+            }
+            case TAPE_NAME: {
+                TapeDocument* tape = project.getTape(readString(record));
+                std::string name = readString(record);
+                if (tape) {
+                    tape->setName(name);
+                }
+                break;
+            }
+            case TAPE_HEAD: {
+                TapeDocument* tape = project.getTape(readString(record));
+                int64_t head = zigzagDecode(record.readVarint());
+                if (tape && record.ok()) {
+                    tape->setHeadPosition(static_cast<int>(head));
+                }
+                break;
+            }
+            case TAPE_CELLS: {
+                TapeDocument* tape = project.getTape(readString(record));
+                int64_t start = zigzagDecode(record.readVarint());
+                int64_t end = start + static_cast<int64_t>(record.readVarint());
+                if (!tape || !record.ok() || start < INT_MIN || end > static_cast<int64_t>(INT_MAX) + 1) {
+                    break;
+                }
+
+                // Reading a tape not loaded yet brings in the file's content first
+                Tape* cells = tape->getTape();
+                cells->clearRange(start, end);
+
+                int64_t position = start;
+                while (!record.atEnd()) {
+                    position += static_cast<int64_t>(record.readVarint());
+                    uint64_t runLength = record.readVarint();
+                    std::string symbols = readString(record);
+                    if (!record.ok() || position + static_cast<int64_t>(runLength) > end) {
+                        break;
+                    }
+                    for (uint64_t cell = 0; cell < runLength; ++cell) {
+                        cells->setCell(static_cast<int>(position + static_cast<int64_t>(cell)), symbols);
+                    }
+                    position += static_cast<int64_t>(runLength);
+                }
+                break;
+            }
+            default:
+                // Commits, and records of newer versions
+                break;
+        }
+    }
+
+    return validEnd;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <QByteArray>
+
+class Project;
+struct ProjectSnapshot;
+
+/**
+ * Append-only log of the changes saved since a project file was last
+ * written in full. A save appends one batch: renames, code changes, head
+ * moves and the tape blocks that changed, followed by a checksummed commit
+ * record. Opening a project replays every complete batch on top of the
+ * project file, so a batch cut short by a crash is simply ignored.
+ */
+class ProjectJournal
+{
+public:
+    static constexpr const char* Suffix = ".journal";
+
+    static std::string pathFor(const std::string& projectPath) { return projectPath + Suffix; }
+
+    // A fresh nonzero id for a project file written in full
+    static uint64_t createId();
+
+    // Encode the changes from one snapshot to a later one as a batch, empty if nothing changed
+    static bool encodeChanges(const ProjectSnapshot& base, const ProjectSnapshot& current, QByteArray& batch);
+
+    // Append a batch to the journal of the given project file. Anything past
+    // validSize, such as a torn batch, is cut off first; a journal without a
+    // valid header for journalId is started anew. Returns the new valid size.
+    static bool append(const std::string& projectPath, uint64_t journalId, uint64_t validSize,
+                       const QByteArray& batch, uint64_t* newSize);
+
+    // Apply the complete batches of a project file's journal, returns the valid size
+    static uint64_t replay(const std::string& projectPath, uint64_t journalId, Project& project);
+};
\ No newline at end of file
@@ -1,8 +1,19 @@
 #include "ProjectManager.h"
 #include "Project.h"
+#include "ProjectSaver.h"
+#include "ProjectJournal.h"
 #include "../document/Document.h"
+#include "../document/CodeDocument.h"
+#include "../model/HistoryStore.h"
+#include "../model/TuringMachine.h"
+#include "../parser/MachineNotation.h"
 #include <QFileInfo>
+#include <QDateTime>
+#include <QFile>
+#include <QTimer>
+#include <QSettings>
 #include <QDebug>
+#include <algorithm>
 
 ProjectManager& ProjectManager::getInstance()
 {
@@ -12,18 +23,43 @@ ProjectManager& ProjectManager::getInstance()
 
 ProjectManager::ProjectManager()
 {
+    m_autosaveTimer = new QTimer(this);
+    connect(m_autosaveTimer, &QTimer::timeout, this, &ProjectManager::autosaveProjects);
+
+    QSettings settings("YourOrganization", "TuringMachineVisualizer");
+    m_autosaveInterval = 0;
+    setAutosaveInterval(settings.value("autosaveInterval", 5).toInt());
+
+    m_historyMemoryLimit = settings.value("historyMemoryLimit", static_cast<int>(HistoryStore::DefaultMemoryLimit >> 20)).toInt();
+    m_historyDiskLimit = settings.value("historyDiskLimit", static_cast<int>(HistoryStore::DefaultDiskLimit >> 20)).toInt();
 }
 
 ProjectManager::~ProjectManager()
 {
 }
 
-Project* ProjectManager::createProject(const std::string& name)
+Project* ProjectManager::addProject(std::unique_ptr<Project> project)
 {
-    auto project = std::make_unique<Project>(name);
     Project* projectPtr = project.get();
-    
+    applyHistoryLimits(projectPtr);
+
+    // Report background saves; autosaves are silent
+    connect(projectPtr->getSaver(), &ProjectSaver::saveFinished, this,
+            [this, projectPtr](const std::string& path, bool success) {
+        if (success) {
+            emit projectSaved(projectPtr);
+        } else {
+            emit projectSaveFailed(projectPtr, path);
+        }
+    });
+
     m_projects.push_back(std::move(project));
+    return projectPtr;
+}
+
+Project* ProjectManager::createProject(const std::string& name)
+{
+    Project* projectPtr = addProject(std::make_unique<Project>(name));
     emit projectCreated(projectPtr);
     
     return projectPtr;
@@ -43,13 +79,84 @@ Project* ProjectManager::openProject(const std::string& path)
         return nullptr;
     }
     
-    Project* projectPtr = project.get();
-    m_projects.push_back(std::move(project));
+    Project* projectPtr = addProject(std::move(project));
     emit projectOpened(projectPtr);
     
     return projectPtr;
 }
 
+std::vector<Project*> ProjectManager::importCorpus(const std::string& path, size_t* skipped)
+{
+    std::vector<Project*> imported;
+    size_t failed = 0;
+    std::string baseName = QFileInfo(QString::fromStdString(path)).completeBaseName().toStdString();
+
+    bool read = MachineNotation::readCorpus(path,
+        [&](std::string_view text, MachineNotation::Format format, size_t line) {
+        // Corpus machines are named by their notation, a Morphett program by its file
+        std::string name = format == MachineNotation::Format::STANDARD ? std::string(text) : baseName;
+        auto project = std::make_unique<Project>(name);
+
+        TuringMachine* machine = project->getMachine();
+        if (!MachineNotation::parse(text, format, *machine)) {
+            qWarning() << "Skipped the machine on line" << line << "of" << QString::fromStdString(path);
+            failed++;
+            return true;
+        }
+
+        // The code is only generated for the editor, the machine is already built
+        std::string code = MachineNotation::toCode(*machine);
+        project->getCodeDocument()->restoreCode(code);
+
+        // Nothing to save until the machine is edited, the corpus still holds it
+        project->setModified(false);
+
+        Project* projectPtr = addProject(std::move(project));
+        imported.push_back(projectPtr);
+        emit projectCreated(projectPtr);
+        return true;
+    });
+
+    if (!read) {
+        qWarning() << "Failed to read machine corpus:" << QString::fromStdString(path);
+    }
+    if (skipped) {
+        *skipped = failed;
+    }
+    return imported;
+}
+
+bool ProjectManager::hasNewerAutosave(const std::string& path) const
+{
+    QFileInfo projectInfo(QString::fromStdString(path));
+    QFileInfo journalInfo(QString::fromStdString(ProjectJournal::pathFor(path)));
+    QFileInfo autosaveInfo(QString::fromStdString(path + Project::AutosaveSuffix));
+
+    // Saves since the file was written in full only touch its journal
+    QDateTime saved = projectInfo.lastModified();
+    if (journalInfo.exists() && journalInfo.lastModified() > saved) {
+        saved = journalInfo.lastModified();
+    }
+    return autosaveInfo.exists() && autosaveInfo.lastModified() > saved;
+}
+
+Project* ProjectManager::recoverProject(const std::string& path)
+{
+    auto project = Project::loadFromFile(path + Project::AutosaveSuffix);
+    if (!project) {
+        return nullptr;
+    }
+
+    // The recovered work belongs to the original file but has not been saved there
+    project->setFilePath(path);
+    project->setModified(true);
+
+    Project* projectPtr = addProject(std::move(project));
+    emit projectOpened(projectPtr);
+
+    return projectPtr;
+}
+
 bool ProjectManager::closeProject(Project* project)
 {
     if (!project) return false;
@@ -58,6 +165,13 @@ bool ProjectManager::closeProject(Project* project)
                           [project](const auto& p) { return p.get() == project; });
     
     if (it != m_projects.end()) {
+        project->getSaver()->waitForAllSaves();
+
+        // A project closed without unsaved changes needs no recovery
+        if (!project->isModified()) {
+            QFile::remove(QString::fromStdString(project->getAutosavePath()));
+        }
+
         emit projectClosed(project);
         m_projects.erase(it);
         return true;
@@ -74,24 +188,84 @@ bool ProjectManager::saveProject(Project* project)
         return false;  // Need a path
     }
     
-    bool success = project->saveToFile(project->getFilePath());
-    if (success) {
-        emit projectSaved(project);
-    }
-    
-    return success;
+    project->getSaver()->save(project->getFilePath());
+    return true;
 }
 
 bool ProjectManager::saveProjectAs(Project* project, const std::string& path)
 {
-    if (!project) return false;
+    if (!project || path.empty()) return false;
     
-    bool success = project->saveToFile(path);
-    if (success) {
-        emit projectSaved(project);
+    project->getSaver()->save(path);
+    return true;
+}
+
+void ProjectManager::waitForPendingSaves()
+{
+    for (const auto& project : m_projects) {
+        project->getSaver()->waitForAllSaves();
+    }
+}
+
+int ProjectManager::getAutosaveInterval() const
+{
+    return m_autosaveInterval;
+}
+
+void ProjectManager::setAutosaveInterval(int minutes)
+{
+    minutes = std::max(0, minutes);
+    if (m_autosaveInterval != minutes) {
+        m_autosaveInterval = minutes;
+
+        QSettings settings("YourOrganization", "TuringMachineVisualizer");
+        settings.setValue("autosaveInterval", minutes);
+    }
+
+    if (minutes > 0) {
+        m_autosaveTimer->start(minutes * 60 * 1000);
+    } else {
+        m_autosaveTimer->stop();
+    }
+}
+
+int ProjectManager::getHistoryMemoryLimit() const
+{
+    return m_historyMemoryLimit;
+}
+
+int ProjectManager::getHistoryDiskLimit() const
+{
+    return m_historyDiskLimit;
+}
+
+void ProjectManager::setHistoryLimits(int memoryMegabytes, int diskMegabytes)
+{
+    m_historyMemoryLimit = std::max(0, memoryMegabytes);
+    m_historyDiskLimit = std::max(0, diskMegabytes);
+
+    QSettings settings("YourOrganization", "TuringMachineVisualizer");
+    settings.setValue("historyMemoryLimit", m_historyMemoryLimit);
+    settings.setValue("historyDiskLimit", m_historyDiskLimit);
+
+    for (const auto& project : m_projects) {
+        applyHistoryLimits(project.get());
+    }
+}
+
+void ProjectManager::applyHistoryLimits(Project* project) const
+{
+    project->getMachine()->setHistoryLimits(static_cast<size_t>(m_historyMemoryLimit) << 20,
+                                            static_cast<size_t>(m_historyDiskLimit) << 20);
+}
+
+void ProjectManager::autosaveProjects()
+{
+    for (const auto& project : m_projects) {
+        if (project->isModified()) {
+            project->getSaver()->autosave();
+        }
     }
-    
-    return success;
 }
 
 std::vector<Project*> ProjectManager::getAllProjects() const
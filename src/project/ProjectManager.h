@@ -7,6 +7,7 @@
 
 class Project;
 class Document;
+class QTimer;
 
 /**
  * Singleton class that manages all open projects
@@ -21,9 +22,27 @@ public:
     // Project operations
     Project* createProject(const std::string& name = "Untitled");
     Project* openProject(const std::string& path);
+    // A project for each machine of a corpus in a notation MachineNotation reads,
+    // machines that don't parse are skipped and counted
+    std::vector<Project*> importCorpus(const std::string& path, size_t* skipped = nullptr);
     bool closeProject(Project* project);
+    // Saves run in the background, projectSaved or projectSaveFailed reports the result
     bool saveProject(Project* project);
     bool saveProjectAs(Project* project, const std::string& path);
+    void waitForPendingSaves();
+
+    // Autosave recovery for projects that were not closed cleanly
+    bool hasNewerAutosave(const std::string& path) const;
+    Project* recoverProject(const std::string& path);
+
+    // Periodic autosave, an interval of 0 minutes disables it
+    int getAutosaveInterval() const;
+    void setAutosaveInterval(int minutes);
+
+    // Megabytes of execution history each machine keeps in memory and spills to disk
+    int getHistoryMemoryLimit() const;
+    int getHistoryDiskLimit() const;
+    void setHistoryLimits(int memoryMegabytes, int diskMegabytes);
 
     // Project access
     std::vector<Project*> getAllProjects() const;
@@ -34,10 +53,14 @@ public:
     void projectOpened(Project* project);
     void projectClosed(Project* project);
     void projectSaved(Project* project);
+    void projectSaveFailed(Project* project, const std::string& path);
 
     public slots:
         void onDocumentClosed(Document* document);
 
+private slots:
+    void autosaveProjects();
+
 private:
     ProjectManager();
     ~ProjectManager();
@@ -47,4 +70,11 @@ private:
     ProjectManager& operator=(const ProjectManager&) = delete;
 
     std::vector<std::unique_ptr<Project>> m_projects;
+    QTimer* m_autosaveTimer;
+    int m_autosaveInterval;
+    int m_historyMemoryLimit;
+    int m_historyDiskLimit;
+
+    Project* addProject(std::unique_ptr<Project> project);
+    void applyHistoryLimits(Project* project) const;
 };
\ No newline at end of file
@@ -0,0 +1,275 @@
+#include "ProjectSaver.h"
+#include "Project.h"
+#include "ProjectFile.h"
+#include "ProjectJournal.h"
+#include "MachineCache.h"
+#include <QThread>
+#include <QTimer>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+
+ProjectSaver::ProjectSaver(Project* project)
+    : m_project(project), m_thread(nullptr), m_currentRevision(0), m_autosavedRevision(0), m_success(false),
+      m_lastSaveSucceeded(false), m_writtenJournalSize(0), m_baseSize(0), m_journalSize(0)
+{
+}
+
+ProjectSaver::~ProjectSaver()
+{
+    // The project is going away, so only the running save is allowed to finish
+    m_queue.clear();
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void ProjectSaver::save(const std::string& path, bool full)
+{
+    enqueue({path, false, full, false});
+}
+
+void ProjectSaver::autosave()
+{
+    // Nothing changed since the last autosave
+    if (m_project->getRevision() == m_autosavedRevision) {
+        return;
+    }
+
+    std::string path = m_project->getAutosavePath();
+    QDir().mkpath(QFileInfo(QString::fromStdString(path)).absolutePath());
+    enqueue({path, true, true, false});
+}
+
+void ProjectSaver::setBase(const std::string& path, uint64_t journalSize)
+{
+    auto base = std::make_shared<ProjectSnapshot>(m_project->createSnapshot());
+    base->machine = nullptr;  // Only the machine's code is compared
+    m_base = std::move(base);
+    m_basePath = path;
+    m_baseSize = static_cast<uint64_t>(QFileInfo(QString::fromStdString(path)).size());
+    m_journalSize = journalSize;
+}
+
+void ProjectSaver::waitForCurrentSave()
+{
+    if (m_thread) {
+        m_thread->wait();
+        finishCurrent();
+    }
+}
+
+void ProjectSaver::waitForAllSaves()
+{
+    waitForCurrentSave();
+
+    // Finishing a save may start a compaction
+    while (m_thread || !m_queue.empty()) {
+        startNext();
+        waitForCurrentSave();
+    }
+}
+
+bool ProjectSaver::writeFile(const ProjectSnapshot& snapshot, const std::string& path,
+                             std::vector<TapeSource>* writtenTapes)
+{
+    // QSaveFile writes to a temporary file and renames it over the target on
+    // commit, so a crash mid-save never leaves a truncated project behind
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open file for writing:" << QString::fromStdString(path);
+        return false;
+    }
+
+    if (!ProjectFile::write(snapshot, file, writtenTapes)) {
+        file.cancelWriting();
+        qWarning() << "Failed to write project file:" << QString::fromStdString(path);
+        return false;
+    }
+
+    if (!file.commit()) {
+        qWarning() << "Failed to write project file:" << QString::fromStdString(path);
+        return false;
+    }
+
+    if (writtenTapes) {
+        QFileInfo info(QString::fromStdString(path));
+        for (TapeSource& source : *writtenTapes) {
+            source.path = path;
+            source.fileSize = info.size();
+            source.modified = info.lastModified().toMSecsSinceEpoch();
+        }
+    }
+
+    return true;
+}
+
+void ProjectSaver::enqueue(const Request& request, bool start)
+{
+    // Only the newest state matters, so a queued save to the same file is replaced
+    auto it = std::find_if(m_queue.begin(), m_queue.end(),
+                           [&request](const Request& queued) { return queued.path == request.path; });
+    if (it != m_queue.end()) {
+        bool full = it->full || request.full;
+        *it = request;
+        it->full = full;
+    } else {
+        m_queue.push_back(request);
+    }
+
+    if (start && !m_thread) {
+        startNext();
+    }
+}
+
+void ProjectSaver::startNext()
+{
+    if (m_thread || m_queue.empty()) {
+        return;
+    }
+
+    m_current = m_queue.front();
+    m_queue.erase(m_queue.begin());
+
+    // Taking the snapshot is the only part of a save done on this thread
+    auto snapshot = std::make_shared<ProjectSnapshot>(m_project->createSnapshot());
+
+    // Saving to the file the base came from only appends what changed. The
+    // journal replays code, not machines, so edits to the machine itself
+    // are written with the whole file.
+    m_current.journal = !m_current.autosave && !m_current.full && m_base &&
+                        m_current.path == m_basePath && !needsCompaction() &&
+                        snapshot->machineRevision == m_base->machineRevision;
+    if (!m_current.journal && !m_current.autosave) {
+        // A new project file invalidates the old journal
+        snapshot->journalId = ProjectJournal::createId();
+    }
+    m_currentSnapshot = snapshot;
+    m_currentRevision = snapshot->revision;
+    m_success = false;
+    m_writtenTapes.clear();
+    m_writtenJournalSize = m_journalSize;
+
+    std::string path = m_current.path;
+    QThread* thread;
+    if (m_current.journal) {
+        std::shared_ptr<const ProjectSnapshot> base = m_base;
+        uint64_t journalSize = m_journalSize;
+        thread = QThread::create([this, snapshot, base, path, journalSize]() {
+            QByteArray batch;
+            bool success = ProjectJournal::encodeChanges(*base, *snapshot, batch);
+            if (success && !batch.isEmpty()) {
+                success = ProjectJournal::append(path, snapshot->journalId, journalSize, batch,
+                                                 &m_writtenJournalSize);
+            }
+
+            // Replaying a code change reuses the compiled machine instead of compiling again
+            if (success && snapshot->code != base->code && !snapshot->code.empty()) {
+                MachineCache::getInstance().store(snapshot->code, *snapshot->machine, snapshot->currentState,
+                                                  snapshot->moduleHash);
+            }
+            m_success = success;
+        });
+    } else {
+        bool replacesJournal = !m_current.autosave;
+        thread = QThread::create([this, snapshot, path, replacesJournal]() {
+            m_success = writeFile(*snapshot, path, &m_writtenTapes);
+
+            // The new file holds everything, so a crash before this leaves a journal it ignores
+            if (m_success && replacesJournal) {
+                QFile::remove(QString::fromStdString(ProjectJournal::pathFor(path)));
+            }
+        });
+    }
+    m_thread = thread;
+
+    // A save finished by waitForCurrentSave() has already been handled
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        if (thread == m_thread) {
+            finishCurrent();
+        }
+    });
+
+    thread->start();
+}
+
+bool ProjectSaver::needsCompaction() const
+{
+    return m_journalSize > std::max<uint64_t>(MinCompactionSize, m_baseSize / 2);
+}
+
+void ProjectSaver::finishCurrent()
+{
+    m_thread->deleteLater();
+    m_thread = nullptr;
+
+    Request request = m_current;
+    bool success = m_success;
+    std::shared_ptr<const ProjectSnapshot> snapshot = std::move(m_currentSnapshot);
+
+    if (success && !request.journal) {
+        // Tapes not loaded yet follow a new project file, as the old one may
+        // be removed, and any file that replaced the one they were read from
+        m_project->relocateTapes(*snapshot, m_writtenTapes, request.autosave);
+    }
+
+    if (request.autosave) {
+        if (success) {
+            m_autosavedRevision = m_currentRevision;
+        }
+        emit autosaveFinished(request.path, success);
+    } else {
+        if (success && request.journal) {
+            // Only the machine's code is compared, don't keep a replaced machine alive
+            auto base = std::make_shared<ProjectSnapshot>(*snapshot);
+            base->machine = nullptr;
+            m_base = std::move(base);
+            m_journalSize = m_writtenJournalSize;
+        } else if (success) {
+            // The base keeps tapes not loaded yet, so they must point at the new file too
+            auto base = std::make_shared<ProjectSnapshot>(*snapshot);
+            for (size_t i = 0; i < base->tapes.size() && i < m_writtenTapes.size(); ++i) {
+                if (base->tapes[i].source) {
+                    base->tapes[i].source = std::make_shared<TapeSource>(m_writtenTapes[i]);
+                }
+            }
+            base->machine = nullptr;
+            m_base = std::move(base);
+            m_basePath = request.path;
+            m_baseSize = static_cast<uint64_t>(QFileInfo(QString::fromStdString(request.path)).size());
+            m_journalSize = 0;
+            m_project->setJournalId(snapshot->journalId);
+        }
+
+        if (success) {
+            // Any autosave is superseded, including one made before the project had a path
+            std::string previousAutosave = m_project->getAutosavePath();
+            m_project->setFilePath(request.path);
+            QFile::remove(QString::fromStdString(previousAutosave));
+            QFile::remove(QString::fromStdString(m_project->getAutosavePath()));
+
+            // Edits made while the save was running still need saving
+            if (m_project->getRevision() == m_currentRevision) {
+                m_project->setModified(false);
+            }
+        }
+        m_lastSaveSucceeded = success;
+        emit saveFinished(request.path, success);
+
+        // Compact a journal that has grown large in the background
+        if (success && request.journal && needsCompaction()) {
+            enqueue({request.path, false, true, false}, false);
+        }
+    }
+
+    // Queued saves start from the event loop, so a caller waiting for this
+    // save can change the machine before the next snapshot is taken
+    if (!m_queue.empty()) {
+        QTimer::singleShot(0, this, &ProjectSaver::startNext);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <QObject>
+
+class Project;
+class QThread;
+struct ProjectSnapshot;
+struct TapeSource;
+
+/**
+ * Writes a project on a worker thread. The GUI thread only takes a
+ * snapshot, the worker serializes it into a temporary file that replaces
+ * the target atomically once complete. Saving again to the same file only
+ * appends what changed since to the file's journal, until the journal has
+ * grown enough to be compacted into a full save. Autosaves go to a separate
+ * file and leave the project's path and modified flag alone.
+ */
+class ProjectSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProjectSaver(Project* project);
+    ~ProjectSaver();
+
+    // Journals grow to at least this size before being compacted
+    static constexpr uint64_t MinCompactionSize = 1 << 20;
+
+    // Start a save, or queue it behind the one that is running.
+    // A full save rewrites the file even when journaling would do.
+    void save(const std::string& path, bool full = false);
+    void autosave();
+
+    // The project was just opened from a file with this much valid journal
+    void setBase(const std::string& path, uint64_t journalSize);
+
+    bool lastSaveSucceeded() const { return m_lastSaveSucceeded; }
+
+    bool isSaving() const { return m_thread != nullptr; }
+
+    // Block until the running save is done, queued saves start later
+    void waitForCurrentSave();
+
+    // Block until every running and queued save is done
+    void waitForAllSaves();
+
+    // Write a snapshot synchronously, used by the worker and blocking saves.
+    // Reports where each tape was written, for tapes that are not loaded yet.
+    static bool writeFile(const ProjectSnapshot& snapshot, const std::string& path,
+                          std::vector<TapeSource>* writtenTapes = nullptr);
+
+    signals:
+        void saveFinished(const std::string& path, bool success);
+    void autosaveFinished(const std::string& path, bool success);
+
+private:
+    struct Request {
+        std::string path;
+        bool autosave;
+        bool full;
+        bool journal;  // Decided when the save starts
+    };
+
+    Project* m_project;
+    QThread* m_thread;
+    Request m_current;
+    std::shared_ptr<const ProjectSnapshot> m_currentSnapshot;
+    uint64_t m_currentRevision;
+    uint64_t m_autosavedRevision;
+    std::atomic<bool> m_success;
+    bool m_lastSaveSucceeded;
+    std::vector<Request> m_queue;
+
+    // Filled by the worker
+    std::vector<TapeSource> m_writtenTapes;
+    uint64_t m_writtenJournalSize;
+
+    // What the project file and its journal hold, changes are found against it
+    std::shared_ptr<const ProjectSnapshot> m_base;
+    std::string m_basePath;
+    uint64_t m_baseSize;
+    uint64_t m_journalSize;
+
+    bool needsCompaction() const;
+
+    void enqueue(const Request& request, bool start = true);
+    void startNext();
+    void finishCurrent();
+};
\ No newline at end of file
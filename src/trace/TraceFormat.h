@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Execution trace file layout. A fixed header is followed by a stream of
+ * records and, once recording finished cleanly, an index and a trailer:
+ *
+ *   header   u32 magic, u32 version, u32 checkpoint interval, u32 reserved
+ *   records  step, symbol/state definition or checkpoint records
+ *   index    END tag, symbol and state tables, checkpoint positions, step count
+ *   trailer  u64 offset of the index, u32 end magic
+ *
+ * A step record is a tag byte below STEP_LIMIT holding the move and which
+ * fields follow, then varint ids: the symbol read, the symbol written if
+ * it differs and the new state if it changed. Symbols and states get ids
+ * in order of their definition records, which precede their first use.
+ */
+namespace TraceFormat {
+
+constexpr uint32_t Magic = 0x52544D54;     // "TMTR" in little-endian
+constexpr uint32_t EndMagic = 0x45544D54;  // "TMTE" in little-endian
+constexpr uint32_t Version = 1;
+constexpr size_t HeaderSize = 16;
+constexpr size_t TrailerSize = 12;
+
+// Step record tag bits
+constexpr uint8_t MOVE_MASK = 0x03;      // Direction as LEFT, RIGHT or STAY
+constexpr uint8_t WRITE_CHANGED = 0x04;  // A write symbol id follows the read one
+constexpr uint8_t STATE_CHANGED = 0x08;  // A state id follows
+constexpr uint8_t STEP_LIMIT = 0x10;
+
+// Other record tags
+enum RecordTag : uint8_t {
+    SYMBOL_DEFINITION = 0x80,  // varint length, bytes
+    STATE_DEFINITION,          // varint length, bytes
+    CHECKPOINT,                // varint step, varint state id, zigzag head, varint run count,
+                               // runs of zigzag gap from the previous run, varint length, varint symbol id
+    END                        // Start of the index
+};
+
+} // namespace TraceFormat
\ No newline at end of file
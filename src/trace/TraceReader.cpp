@@ -0,0 +1,345 @@
+#include "TraceReader.h"
+#include "TraceFormat.h"
+#include "../project/BinaryIO.h"
+#include <QDebug>
+#include <algorithm>
+
+using BinaryIO::BinaryReader;
+using BinaryIO::zigzagDecode;
+
+TraceReader::TraceReader()
+    : m_data(nullptr), m_size(0), m_endOffset(0), m_stepCount(0),
+      m_offset(0), m_position(0), m_stateId(0)
+{
+}
+
+TraceReader::~TraceReader()
+{
+    close();
+}
+
+bool TraceReader::open(const std::string& path)
+{
+    close();
+
+    m_file.setFileName(QString::fromStdString(path));
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open trace file:" << QString::fromStdString(path);
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    uchar* mapped = size > 0 ? m_file.map(0, size) : nullptr;
+    if (!mapped) {
+        qWarning() << "Failed to map trace file:" << QString::fromStdString(path);
+        m_file.close();
+        return false;
+    }
+    m_data = reinterpret_cast<const char*>(mapped);
+    m_size = static_cast<size_t>(size);
+
+    BinaryReader header(m_data, m_size);
+    uint32_t magic = header.readU32();
+    uint32_t version = header.readU32();
+    if (!header.ok() || magic != TraceFormat::Magic) {
+        qWarning() << "Not a trace file:" << QString::fromStdString(path);
+        close();
+        return false;
+    }
+    if (version != TraceFormat::Version) {
+        qWarning() << "Unsupported trace file version" << version;
+        close();
+        return false;
+    }
+
+    // Traces that were not finished have no index and are scanned instead
+    if (!readIndex() && !scan()) {
+        qWarning() << "Corrupt trace file:" << QString::fromStdString(path);
+        close();
+        return false;
+    }
+
+    return seek(0);
+}
+
+void TraceReader::close()
+{
+    if (m_data) {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+        m_file.close();
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_endOffset = 0;
+    m_symbols.clear();
+    m_states.clear();
+    m_checkpoints.clear();
+    m_stepCount = 0;
+    m_offset = 0;
+    m_position = 0;
+    m_stateId = 0;
+    m_tape.reset();
+}
+
+bool TraceReader::seek(uint64_t step)
+{
+    if (!isOpen() || step > m_stepCount) {
+        return false;
+    }
+
+    // Last checkpoint at or before the step
+    auto checkpoint = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), step,
+                                       [](uint64_t value, const std::pair<uint64_t, uint64_t>& entry) {
+                                           return value < entry.first;
+                                       });
+    if (checkpoint == m_checkpoints.begin()) {
+        return false;
+    }
+    --checkpoint;
+
+    // Seeking forward past that checkpoint just keeps replaying
+    if (m_position > step || m_offset <= checkpoint->second) {
+        BinaryReader reader(m_data, m_endOffset);
+        reader.seek(checkpoint->second);
+        if (reader.readU8() != TraceFormat::CHECKPOINT || !readCheckpoint(reader, true)) {
+            return false;
+        }
+        m_offset = reader.position();
+    }
+
+    while (m_position < step) {
+        if (!next()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TraceReader::next(TraceStep* step)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    BinaryReader reader(m_data, m_endOffset);
+    reader.seek(m_offset);
+
+    while (!reader.atEnd()) {
+        uint8_t tag = reader.readU8();
+
+        if (tag < TraceFormat::STEP_LIMIT) {
+            uint64_t read = reader.readVarint();
+            uint64_t write = (tag & TraceFormat::WRITE_CHANGED) ? reader.readVarint() : read;
+            uint64_t state = (tag & TraceFormat::STATE_CHANGED) ? reader.readVarint() : m_stateId;
+            if (!reader.ok() || read >= m_symbols.size() || write >= m_symbols.size() ||
+                state >= m_states.size()) {
+                return false;
+            }
+
+            Direction move = static_cast<Direction>(tag & TraceFormat::MOVE_MASK);
+            m_tape.write(m_symbols[write]);
+            switch (move) {
+                case Direction::LEFT:
+                    m_tape.moveLeft();
+                    break;
+                case Direction::RIGHT:
+                    m_tape.moveRight();
+                    break;
+                case Direction::STAY:
+                    break;
+            }
+
+            m_stateId = static_cast<uint32_t>(state);
+            m_position++;
+            m_offset = reader.position();
+
+            if (step) {
+                step->number = m_position;
+                step->readSymbol = m_symbols[read];
+                step->writeSymbol = m_symbols[write];
+                step->move = move;
+                step->state = m_states[m_stateId];
+            }
+            return true;
+        }
+
+        if (tag == TraceFormat::SYMBOL_DEFINITION || tag == TraceFormat::STATE_DEFINITION) {
+            // The dictionaries are complete once the trace is open
+            reader.take(reader.readVarint());
+        } else if (tag == TraceFormat::CHECKPOINT) {
+            if (!readCheckpoint(reader, true)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+
+        if (!reader.ok()) {
+            return false;
+        }
+        m_offset = reader.position();
+    }
+
+    return false;
+}
+
+std::string TraceReader::getState() const
+{
+    return m_stateId < m_states.size() ? m_states[m_stateId] : std::string();
+}
+
+bool TraceReader::readIndex()
+{
+    if (m_size < TraceFormat::HeaderSize + TraceFormat::TrailerSize) {
+        return false;
+    }
+
+    BinaryReader trailer(m_data + m_size - TraceFormat::TrailerSize, TraceFormat::TrailerSize);
+    uint64_t indexOffset = trailer.readU64();
+    uint32_t endMagic = trailer.readU32();
+    if (endMagic != TraceFormat::EndMagic || indexOffset < TraceFormat::HeaderSize ||
+        indexOffset >= m_size - TraceFormat::TrailerSize) {
+        return false;
+    }
+
+    BinaryReader reader(m_data, m_size - TraceFormat::TrailerSize);
+    reader.seek(indexOffset);
+    if (reader.readU8() != TraceFormat::END) {
+        return false;
+    }
+
+    auto readStrings = [&reader](std::vector<std::string>& strings) {
+        uint64_t count = reader.readVarint();
+        for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+            uint64_t length = reader.readVarint();
+            const char* data = reader.take(length);
+            if (data) {
+                strings.emplace_back(data, length);
+            }
+        }
+    };
+    readStrings(m_symbols);
+    readStrings(m_states);
+
+    uint64_t checkpointCount = reader.readVarint();
+    uint64_t step = 0;
+    uint64_t offset = 0;
+    for (uint64_t i = 0; i < checkpointCount && reader.ok(); ++i) {
+        step += reader.readVarint();
+        offset += reader.readVarint();
+        m_checkpoints.emplace_back(step, offset);
+    }
+    m_stepCount = reader.readVarint();
+
+    if (!reader.ok() || m_checkpoints.empty() || offset >= indexOffset) {
+        m_symbols.clear();
+        m_states.clear();
+        m_checkpoints.clear();
+        m_stepCount = 0;
+        return false;
+    }
+
+    m_endOffset = indexOffset;
+    return true;
+}
+
+bool TraceReader::scan()
+{
+    m_symbols.clear();
+    m_states.clear();
+    m_checkpoints.clear();
+    m_stepCount = 0;
+
+    BinaryReader reader(m_data, m_size);
+    reader.seek(TraceFormat::HeaderSize);
+    size_t recordsEnd = TraceFormat::HeaderSize;
+
+    // Stops at the index, or at a record cut short when recording was interrupted
+    while (!reader.atEnd()) {
+        size_t recordStart = reader.position();
+        uint8_t tag = reader.readU8();
+
+        if (tag < TraceFormat::STEP_LIMIT) {
+            reader.readVarint();
+            if (tag & TraceFormat::WRITE_CHANGED) {
+                reader.readVarint();
+            }
+            if (tag & TraceFormat::STATE_CHANGED) {
+                reader.readVarint();
+            }
+            if (!reader.ok()) {
+                break;
+            }
+            m_stepCount++;
+        } else if (tag == TraceFormat::SYMBOL_DEFINITION || tag == TraceFormat::STATE_DEFINITION) {
+            uint64_t length = reader.readVarint();
+            const char* data = reader.take(length);
+            if (!data) {
+                break;
+            }
+            auto& strings = tag == TraceFormat::SYMBOL_DEFINITION ? m_symbols : m_states;
+            strings.emplace_back(data, length);
+        } else if (tag == TraceFormat::CHECKPOINT) {
+            uint64_t step = 0;
+            if (!readCheckpoint(reader, false, &step)) {
+                break;
+            }
+            m_checkpoints.emplace_back(step, recordStart);
+        } else {
+            break;
+        }
+
+        recordsEnd = reader.position();
+    }
+
+    m_endOffset = recordsEnd;
+    return !m_checkpoints.empty();
+}
+
+bool TraceReader::readCheckpoint(BinaryReader& reader, bool apply, uint64_t* step)
+{
+    uint64_t position = reader.readVarint();
+    uint64_t state = reader.readVarint();
+    int64_t head = zigzagDecode(reader.readVarint());
+    uint64_t runCount = reader.readVarint();
+
+    if (apply) {
+        if (!reader.ok() || state >= m_states.size()) {
+            return false;
+        }
+        m_tape.reset();
+    }
+
+    int64_t previousEnd = 0;
+    for (uint64_t i = 0; i < runCount && reader.ok(); ++i) {
+        int64_t start = previousEnd + zigzagDecode(reader.readVarint());
+        uint64_t length = reader.readVarint();
+        uint64_t symbol = reader.readVarint();
+
+        if (apply && reader.ok()) {
+            if (symbol >= m_symbols.size()) {
+                return false;
+            }
+            for (uint64_t cell = 0; cell < length; ++cell) {
+                m_tape.setCell(static_cast<int>(start + static_cast<int64_t>(cell)), m_symbols[symbol]);
+            }
+        }
+        previousEnd = start + static_cast<int64_t>(length);
+    }
+
+    if (!reader.ok()) {
+        return false;
+    }
+
+    if (apply) {
+        m_tape.setHeadPosition(static_cast<int>(head));
+        m_stateId = static_cast<uint32_t>(state);
+        m_position = position;
+    }
+    if (step) {
+        *step = position;
+    }
+    return true;
+}
\ No newline at end of file
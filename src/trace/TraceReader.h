@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../model/Tape.h"
+#include "../model/Transition.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <QFile>
+
+namespace BinaryIO { class BinaryReader; }
+
+// One recorded step as read back from a trace
+struct TraceStep {
+    uint64_t number = 0;  // 1 for the first recorded step
+    std::string readSymbol;
+    std::string writeSymbol;
+    Direction move = Direction::STAY;
+    std::string state;    // State after the step
+};
+
+/**
+ * Reads a trace written by TraceRecorder from a memory-mapped file and
+ * reconstructs the machine configuration after any recorded step. Seeking
+ * starts from the nearest checkpoint. Traces that were not finished, e.g.
+ * after a crash, are indexed by scanning them once.
+ */
+class TraceReader
+{
+public:
+    TraceReader();
+    ~TraceReader();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    uint64_t getStepCount() const { return m_stepCount; }
+    uint32_t getCheckpointCount() const { return static_cast<uint32_t>(m_checkpoints.size()); }
+
+    // Move to the configuration after the given number of steps, 0 being the initial one
+    bool seek(uint64_t step);
+
+    // Advance one step, optionally reporting what it did; false at the end of the trace
+    bool next(TraceStep* step = nullptr);
+
+    // Configuration at the current position
+    uint64_t getPosition() const { return m_position; }
+    std::string getState() const;
+    const Tape& getTape() const { return m_tape; }
+
+private:
+    QFile m_file;
+    const char* m_data;
+    size_t m_size;
+    size_t m_endOffset;  // Where the records end
+
+    std::vector<std::string> m_symbols;
+    std::vector<std::string> m_states;
+    std::vector<std::pair<uint64_t, uint64_t>> m_checkpoints;  // Step and file offset
+    uint64_t m_stepCount;
+
+    size_t m_offset;
+    uint64_t m_position;
+    uint32_t m_stateId;
+    Tape m_tape;
+
+    bool readIndex();
+    bool scan();
+    bool readCheckpoint(BinaryIO::BinaryReader& reader, bool apply, uint64_t* step = nullptr);
+};
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "TraceRecorder.h"
+#include "TraceFormat.h"
+#include "../model/TuringMachine.h"
+#include "../model/Tape.h"
+#include "../project/BinaryIO.h"
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using BinaryIO::appendU32;
+using BinaryIO::appendU64;
+using BinaryIO::appendVarint;
+using BinaryIO::zigzagEncode;
+
+// Encoded records are handed to the writer in buffers of about this size
+constexpr int BufferSize = 1 << 20;
+
+// Buffers waiting to be written before recording blocks, bounding memory
+constexpr size_t MaxQueuedBuffers = 8;
+
+void appendString(QByteArray& out, const std::string& str)
+{
+    appendVarint(out, str.size());
+    out.append(str.data(), static_cast<int>(str.size()));
+}
+
+} // namespace
+
+// Writes buffers to the trace file on its own thread
+class TraceRecorder::Writer
+{
+public:
+    ~Writer()
+    {
+        close();
+    }
+
+    bool open(const QString& path)
+    {
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+
+        m_thread = std::thread(&Writer::run, this);
+        return true;
+    }
+
+    void push(QByteArray buffer)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_spaceAvailable.wait(lock, [this]() { return m_queue.size() < MaxQueuedBuffers; });
+        m_queue.push_back(std::move(buffer));
+        m_dataAvailable.notify_one();
+    }
+
+    // Write what is queued and close the file
+    bool close()
+    {
+        if (m_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closing = true;
+            }
+            m_dataAvailable.notify_one();
+            m_thread.join();
+            m_file.close();
+        }
+        return !m_failed;
+    }
+
+private:
+    QFile m_file;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_dataAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::deque<QByteArray> m_queue;
+    bool m_closing = false;
+    std::atomic<bool> m_failed{false};
+
+    void run()
+    {
+        for (;;) {
+            QByteArray buffer;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_dataAvailable.wait(lock, [this]() { return !m_queue.empty() || m_closing; });
+                if (m_queue.empty()) {
+                    return;
+                }
+                buffer = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_spaceAvailable.notify_one();
+
+            if (!m_failed && m_file.write(buffer) != buffer.size()) {
+                qWarning() << "Failed to write trace file:" << m_file.fileName();
+                m_failed = true;
+            }
+        }
+    }
+};
+
+TraceRecorder::TraceRecorder()
+    : m_machine(nullptr), m_tape(nullptr), m_flushedBytes(0), m_stateId(0),
+      m_stepCount(0), m_nextCheckpoint(0), m_checkpointInterval(DefaultCheckpointInterval)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    if (isRecording()) {
+        finish();
+    }
+}
+
+bool TraceRecorder::start(const std::string& path, TuringMachine& machine, const Tape& tape,
+                          uint32_t checkpointInterval)
+{
+    if (isRecording()) {
+        finish();
+    }
+
+    auto writer = std::make_unique<Writer>();
+    if (!writer->open(QString::fromStdString(path))) {
+        qWarning() << "Failed to open trace file for writing:" << QString::fromStdString(path);
+        return false;
+    }
+
+    m_writer = std::move(writer);
+    m_machine = &machine;
+    m_tape = &tape;
+    m_flushedBytes = 0;
+    m_symbolIds.clear();
+    m_stateIds.clear();
+    m_symbols.clear();
+    m_states.clear();
+    m_stepCount = 0;
+    m_checkpointInterval = std::max<uint32_t>(1, checkpointInterval);
+    m_checkpoints.clear();
+
+    m_buffer = QByteArray();
+    m_buffer.reserve(BufferSize);
+    appendU32(m_buffer, TraceFormat::Magic);
+    appendU32(m_buffer, TraceFormat::Version);
+    appendU32(m_buffer, m_checkpointInterval);
+    appendU32(m_buffer, 0);  // Reserved
+
+    // The trace starts from the current configuration
+    writeCheckpoint(machine);
+    machine.addObserver(this);
+    return true;
+}
+
+bool TraceRecorder::finish()
+{
+    if (!isRecording()) {
+        return false;
+    }
+
+    m_machine->removeObserver(this);
+    m_machine = nullptr;
+    m_tape = nullptr;
+
+    // Index: dictionaries and checkpoints, so readers can seek without a scan
+    uint64_t indexOffset = m_flushedBytes + m_buffer.size();
+    m_buffer.append(static_cast<char>(TraceFormat::END));
+
+    appendVarint(m_buffer, m_symbols.size());
+    for (const std::string& symbol : m_symbols) {
+        appendString(m_buffer, symbol);
+    }
+    appendVarint(m_buffer, m_states.size());
+    for (const std::string& state : m_states) {
+        appendString(m_buffer, state);
+    }
+
+    appendVarint(m_buffer, m_checkpoints.size());
+    uint64_t previousStep = 0;
+    uint64_t previousOffset = 0;
+    for (const auto& checkpoint : m_checkpoints) {
+        appendVarint(m_buffer, checkpoint.first - previousStep);
+        appendVarint(m_buffer, checkpoint.second - previousOffset);
+        previousStep = checkpoint.first;
+        previousOffset = checkpoint.second;
+    }
+    appendVarint(m_buffer, m_stepCount);
+
+    appendU64(m_buffer, indexOffset);
+    appendU32(m_buffer, TraceFormat::EndMagic);
+
+    m_writer->push(std::move(m_buffer));
+    m_buffer = QByteArray();
+
+    bool success = m_writer->close();
+    m_writer.reset();
+    return success;
+}
+
+void TraceRecorder::onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                           const Transition& transition)
+{
+    // Steps on the machine's other tapes are not part of this trace
+    if (machine.getTape() != m_tape) {
+        return;
+    }
+
+    // Ids first, a new symbol or state writes its definition before the step
+    uint32_t read = symbolId(readSymbol);
+    std::string writeSymbol = transition.getWriteSymbol();
+    uint32_t write = writeSymbol == readSymbol ? read : symbolId(writeSymbol);
+
+    std::string toState = transition.getToState();
+    uint32_t state = toState == m_states[m_stateId] ? m_stateId : stateId(toState);
+
+    uint8_t tag = static_cast<uint8_t>(transition.getDirection()) & TraceFormat::MOVE_MASK;
+    if (write != read) {
+        tag |= TraceFormat::WRITE_CHANGED;
+    }
+    if (state != m_stateId) {
+        tag |= TraceFormat::STATE_CHANGED;
+    }
+
+    m_buffer.append(static_cast<char>(tag));
+    appendVarint(m_buffer, read);
+    if (write != read) {
+        appendVarint(m_buffer, write);
+    }
+    if (state != m_stateId) {
+        appendVarint(m_buffer, state);
+    }
+
+    m_stateId = state;
+    m_stepCount++;
+
+    if (m_stepCount >= m_nextCheckpoint) {
+        writeCheckpoint(machine);
+    }
+    flushIfFull();
+}
+
+void TraceRecorder::onJump(const TuringMachine& machine)
+{
+    // The configuration after a reset or step backward can't be derived from steps
+    if (machine.getTape() == m_tape) {
+        writeCheckpoint(machine);
+        flushIfFull();
+    }
+}
+
+void TraceRecorder::onReplaced(TuringMachine& replacement)
+{
+    m_machine = &replacement;
+}
+
+uint32_t TraceRecorder::symbolId(const std::string& symbol)
+{
+    auto it = m_symbolIds.find(symbol);
+    if (it != m_symbolIds.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(m_symbols.size());
+    m_symbols.push_back(symbol);
+    m_symbolIds.emplace(symbol, id);
+
+    m_buffer.append(static_cast<char>(TraceFormat::SYMBOL_DEFINITION));
+    appendString(m_buffer, symbol);
+    return id;
+}
+
+uint32_t TraceRecorder::stateId(const std::string& state)
+{
+    auto it = m_stateIds.find(state);
+    if (it != m_stateIds.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(m_states.size());
+    m_states.push_back(state);
+    m_stateIds.emplace(state, id);
+
+    m_buffer.append(static_cast<char>(TraceFormat::STATE_DEFINITION));
+    appendString(m_buffer, state);
+    return id;
+}
+
+void TraceRecorder::writeCheckpoint(const TuringMachine& machine)
+{
+    m_stateId = stateId(machine.getCurrentState());
+
+    // Define every symbol on the tape before the checkpoint refers to it
+    uint64_t runCount = 0;
+    m_tape->forEachRun([this, &runCount](int, int, const std::string& symbols) {
+        symbolId(symbols);
+        runCount++;
+    });
+
+    uint64_t offset = m_flushedBytes + m_buffer.size();
+    m_checkpoints.emplace_back(m_stepCount, offset);
+
+    m_buffer.append(static_cast<char>(TraceFormat::CHECKPOINT));
+    appendVarint(m_buffer, m_stepCount);
+    appendVarint(m_buffer, m_stateId);
+    appendVarint(m_buffer, zigzagEncode(m_tape->getHeadPosition()));
+    appendVarint(m_buffer, runCount);
+
+    int64_t previousEnd = 0;
+    m_tape->forEachRun([this, &previousEnd](int start, int length, const std::string& symbols) {
+        appendVarint(m_buffer, zigzagEncode(start - previousEnd));
+        appendVarint(m_buffer, static_cast<uint64_t>(length));
+        appendVarint(m_buffer, m_symbolIds[symbols]);
+        previousEnd = static_cast<int64_t>(start) + length;
+    });
+
+    // Checkpoints of large tapes are spaced out so they stay a small part of the trace
+    uint64_t size = m_flushedBytes + m_buffer.size() - offset;
+    m_nextCheckpoint = m_stepCount + std::max<uint64_t>(m_checkpointInterval, size * 4);
+}
+
+void TraceRecorder::flushIfFull()
+{
+    if (m_buffer.size() >= BufferSize) {
+        m_flushedBytes += m_buffer.size();
+        m_writer->push(std::move(m_buffer));
+        m_buffer = QByteArray();
+        m_buffer.reserve(BufferSize);
+    }
+}
\ No newline at end of file
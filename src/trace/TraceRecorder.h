@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../model/ExecutionObserver.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <QByteArray>
+
+class Tape;
+
+/**
+ * Records every step a machine takes on one tape to a trace file. Steps
+ * are encoded into a few bytes each on the calling thread, full buffers
+ * are written by a background thread. Full tape checkpoints are added
+ * periodically so a TraceReader can seek without replaying from the start.
+ */
+class TraceRecorder : public ExecutionObserver
+{
+public:
+    static constexpr uint32_t DefaultCheckpointInterval = 1 << 16;
+
+    TraceRecorder();
+    ~TraceRecorder() override;
+
+    // Start recording machine steps on the given tape, beginning with its current configuration
+    bool start(const std::string& path, TuringMachine& machine, const Tape& tape,
+               uint32_t checkpointInterval = DefaultCheckpointInterval);
+
+    // Write the index and close the file, returns false if any write failed
+    bool finish();
+
+    bool isRecording() const { return m_machine != nullptr; }
+    uint64_t getStepCount() const { return m_stepCount; }
+
+    // ExecutionObserver
+    void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                const Transition& transition) override;
+    void onJump(const TuringMachine& machine) override;
+    void onReplaced(TuringMachine& replacement) override;
+
+private:
+    class Writer;
+
+    std::unique_ptr<Writer> m_writer;
+    TuringMachine* m_machine;
+    const Tape* m_tape;
+
+    QByteArray m_buffer;
+    uint64_t m_flushedBytes;  // Bytes handed to the writer before m_buffer
+
+    std::unordered_map<std::string, uint32_t> m_symbolIds;
+    std::unordered_map<std::string, uint32_t> m_stateIds;
+    std::vector<std::string> m_symbols;
+    std::vector<std::string> m_states;
+    uint32_t m_stateId;  // State the machine is in
+
+    uint64_t m_stepCount;
+    uint64_t m_nextCheckpoint;
+    uint32_t m_checkpointInterval;
+    std::vector<std::pair<uint64_t, uint64_t>> m_checkpoints;  // Step and file offset
+
+    uint32_t symbolId(const std::string& symbol);
+    uint32_t stateId(const std::string& state);
+    void writeCheckpoint(const TuringMachine& machine);
+    void flushIfFull();
+};
\ No newline at end of file
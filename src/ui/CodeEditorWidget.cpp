@@ -3,7 +3,7 @@
 #include <sstream>
 
 // Qt includes
-#include <QTextEdit>
+#include <QPlainTextEdit>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -11,79 +11,12 @@
 #include <QFont>
 #include <QMessageBox>
 #include <QDebug>
-#include <QSyntaxHighlighter>
-#include <QRegularExpression>
 
 // Project includes
 #include "../model/TuringMachine.h"
 #include "../model/State.h"
 #include "../model/Transition.h"
-
-// Syntax highlighter for the code editor
-class TuringMachineSyntaxHighlighter : public QSyntaxHighlighter
-{
-public:
-    TuringMachineSyntaxHighlighter(QTextDocument* parent)
-        : QSyntaxHighlighter(parent)
-    {
-        // Function notation format
-        QTextCharFormat functionFormat;
-        functionFormat.setForeground(Qt::darkBlue);
-        functionFormat.setFontWeight(QFont::Bold);
-        QRegularExpression functionRegex(R"(^(?:f)?\s*\()");
-        highlightingRules.append({functionRegex, functionFormat});
-
-        // State format
-        QTextCharFormat stateFormat;
-        stateFormat.setForeground(Qt::darkGreen);
-        QRegularExpression stateRegex(R"(q[0-9a-zA-Z_]+)");
-        highlightingRules.append({stateRegex, stateFormat});
-
-        // Symbol format
-        QTextCharFormat symbolFormat;
-        symbolFormat.setForeground(Qt::red);
-        QRegularExpression symbolRegex(R"(Blank|_|[0-9a-zA-Z])");
-        highlightingRules.append({symbolRegex, symbolFormat});
-
-        // Direction format
-        QTextCharFormat directionFormat;
-        directionFormat.setForeground(Qt::darkMagenta);
-        QRegularExpression directionRegex(R"(R|L|N|0|S)");
-        highlightingRules.append({directionRegex, directionFormat});
-
-        // Comment format
-        QTextCharFormat commentFormat;
-        commentFormat.setForeground(Qt::gray);
-        QRegularExpression commentRegex("//[^\n]*");
-        highlightingRules.append({commentRegex, commentFormat});
-
-        // Parentheses, commas, arrows format
-        QTextCharFormat punctuationFormat;
-        punctuationFormat.setForeground(Qt::black);
-        punctuationFormat.setFontWeight(QFont::Bold);
-        QRegularExpression punctuationRegex(R"([\(\),]|->|=)");
-        highlightingRules.append({punctuationRegex, punctuationFormat});
-    }
-
-protected:
-    void highlightBlock(const QString& text) override
-    {
-        for (const auto& rule : highlightingRules) {
-            QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-            while (matchIterator.hasNext()) {
-                QRegularExpressionMatch match = matchIterator.next();
-                setFormat(match.capturedStart(), match.capturedLength(), rule.format);
-            }
-        }
-    }
-
-private:
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightingRule> highlightingRules;
-};
+#include "CodeHighlighter.h"
 
 // CodeEditorWidget implementation
 CodeEditorWidget::CodeEditorWidget(TuringMachine* machine, QWidget *parent)
@@ -111,13 +44,16 @@ void CodeEditorWidget::setupUI()
     mainLayout->addWidget(descriptionLabel);
 
     // Code editor
-    m_codeEditor = new QTextEdit(this);
+    m_codeEditor = new QPlainTextEdit(this);
     QFont font("Courier New", 10);
     m_codeEditor->setFont(font);
     mainLayout->addWidget(m_codeEditor);
 
     // Setup syntax highlighting
-    new TuringMachineSyntaxHighlighter(m_codeEditor->document());
+    CodeHighlighter* highlighter = new CodeHighlighter(m_codeEditor->document());
+    connect(m_codeEditor, &QPlainTextEdit::updateRequest, this, [this, highlighter]() {
+        highlighter->highlightVisibleBlocks(m_codeEditor);
+    });
 
     // Button layout
     QHBoxLayout* buttonLayout = new QHBoxLayout();
@@ -139,7 +75,7 @@ void CodeEditorWidget::setupUI()
     // Connect signals
     connect(m_applyButton, &QPushButton::clicked, this, &CodeEditorWidget::applyCode);
     connect(m_resetButton, &QPushButton::clicked, this, &CodeEditorWidget::resetCode);
-    connect(m_codeEditor, &QTextEdit::textChanged, this, &CodeEditorWidget::onTextChanged);
+    connect(m_codeEditor, &QPlainTextEdit::textChanged, this, &CodeEditorWidget::onTextChanged);
 
     // Initial state
     m_applyButton->setEnabled(false);
@@ -4,7 +4,7 @@
 #include <string>
 
 // Forward declarations
-class QTextEdit;
+class QPlainTextEdit;
 class QPushButton;
 class QVBoxLayout;
 class QHBoxLayout;
@@ -52,7 +52,7 @@ public:
 
 private:
     TuringMachine* m_machine;
-    QTextEdit* m_codeEditor;
+    QPlainTextEdit* m_codeEditor;
     QLabel* m_statusLabel;
     QPushButton* m_applyButton;
     QPushButton* m_resetButton;
@@ -0,0 +1,198 @@
+#include "CodeHighlighter.h"
+
+#include <QPlainTextEdit>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <climits>
+
+namespace {
+
+// Hash of the text a block was last highlighted from
+class HighlightedText : public QTextBlockUserData
+{
+public:
+    explicit HighlightedText(size_t hash) : hash(hash) {}
+    size_t hash;
+};
+
+} // namespace
+
+CodeHighlighter::CodeHighlighter(QTextDocument* document)
+    : QSyntaxHighlighter(document),
+      m_firstVisibleBlock(0), m_lastVisibleBlock(INT_MAX)
+{
+    // Keywords: s, a, r, q, f, m, c
+    m_keywordFormat.setForeground(Qt::darkBlue);
+    m_keywordFormat.setFontWeight(QFont::Bold);
+
+    // State identifiers
+    m_stateFormat.setForeground(Qt::darkGreen);
+
+    // Read and write symbols
+    m_symbolFormat.setForeground(Qt::red);
+
+    // Directions
+    m_directionFormat.setForeground(Qt::darkMagenta);
+
+    // Module names in m(...) and c(...)
+    m_moduleFormat.setForeground(Qt::darkCyan);
+    m_moduleFormat.setFontItalic(true);
+
+    // Comments
+    m_commentFormat.setForeground(Qt::gray);
+
+    // Parentheses, commas, arrows
+    m_punctuationFormat.setForeground(Qt::black);
+    m_punctuationFormat.setFontWeight(QFont::Bold);
+}
+
+void CodeHighlighter::setVisibleRange(int firstBlock, int lastBlock)
+{
+    m_firstVisibleBlock = qMax(0, firstBlock);
+    m_lastVisibleBlock = lastBlock;
+}
+
+void CodeHighlighter::highlightVisibleBlocks(QPlainTextEdit* editor)
+{
+    if (!editor || !document()) return;
+
+    QTextBlock first = editor->cursorForPosition(QPoint(0, 0)).block();
+    QTextBlock last = editor->cursorForPosition(QPoint(0, editor->viewport()->height() - 1)).block();
+
+    // Keep a margin ready on either side so scrolling a page does not flash
+    const int margin = 50;
+    setVisibleRange(first.blockNumber() - margin, last.blockNumber() + margin);
+
+    QTextBlock block = document()->findBlockByNumber(m_firstVisibleBlock);
+    for (int number = m_firstVisibleBlock; block.isValid() && number <= m_lastVisibleBlock; ++number) {
+        // A highlighted block stays so until edited, so this only lexes new lines
+        if (isPending(block)) {
+            rehighlightBlock(block);
+        }
+        block = block.next();
+    }
+}
+
+void CodeHighlighter::highlightBlock(const QString& text)
+{
+    int blockNumber = currentBlock().blockNumber();
+    if (blockNumber < m_firstVisibleBlock || blockNumber > m_lastVisibleBlock) {
+        // Formats not set again are cleared, but they only still fit unchanged text
+        if (!isPending(currentBlock())) {
+            for (const QTextLayout::FormatRange& range : currentBlock().layout()->formats()) {
+                setFormat(range.start, range.length, range.format);
+            }
+        }
+        return;
+    }
+
+    // Latin-1 keeps one byte per UTF-16 unit, so token offsets are text positions
+    QByteArray line = text.toLatin1();
+    CodeLexer::tokenize(std::string_view(line.constData(), static_cast<size_t>(line.size())), m_tokens);
+
+    LineKind kind = OTHER;
+    int group = 0;        // Parenthesised group, 1 for f(...), 2 for -> (...)
+    int fieldIndex = -1;  // Comma-separated field inside the current group
+
+    for (const Token& token : m_tokens) {
+        int start = static_cast<int>(token.offset);
+        int length = static_cast<int>(token.text.size());
+
+        switch (token.type) {
+            case TokenType::Keyword:
+                if (token.text == "f") {
+                    kind = TRANSITION;
+                } else if (token.text == "m") {
+                    kind = MODULE_DECLARATION;
+                } else if (token.text == "c") {
+                    kind = MODULE_CALL;
+                } else {
+                    kind = STATE_DECLARATION;
+                }
+                setFormat(start, length, m_keywordFormat);
+                break;
+            case TokenType::Comment:
+                if (kind == OTHER) {
+                    kind = COMMENT;
+                }
+                setFormat(start, length, m_commentFormat);
+                break;
+            case TokenType::LeftParen:
+                group++;
+                fieldIndex = 0;
+                setFormat(start, length, m_punctuationFormat);
+                break;
+            case TokenType::RightParen:
+                fieldIndex = -1;
+                setFormat(start, length, m_punctuationFormat);
+                break;
+            case TokenType::Comma:
+                if (fieldIndex >= 0) {
+                    fieldIndex++;
+                }
+                setFormat(start, length, m_punctuationFormat);
+                break;
+            case TokenType::Arrow:
+                setFormat(start, length, m_punctuationFormat);
+                break;
+            case TokenType::Identifier:
+            case TokenType::Text: {
+                Field field = Field::NONE;
+                if (kind == STATE_DECLARATION && group == 1) {
+                    field = (fieldIndex == 0) ? Field::STATE : Field::NAME;
+                } else if (kind == MODULE_DECLARATION && group == 1) {
+                    field = (fieldIndex == 0) ? Field::MODULE : Field::NAME;
+                } else if (kind == MODULE_CALL && group == 1) {
+                    field = (fieldIndex == 1) ? Field::MODULE : Field::STATE;
+                } else if (kind == TRANSITION && (group == 1 || group == 2)) {
+                    if (fieldIndex == 0) {
+                        field = Field::STATE;
+                    } else if (fieldIndex == 1) {
+                        field = Field::SYMBOL;
+                    } else if (fieldIndex == 2 && group == 2) {
+                        field = Field::DIRECTION;
+                    }
+                }
+
+                const QTextCharFormat* format = formatForField(field);
+                if (format) {
+                    setFormat(start, length, *format);
+                }
+                break;
+            }
+            case TokenType::Whitespace:
+                break;
+        }
+    }
+
+    setCurrentBlockState(kind);
+
+    const size_t hash = qHash(text);
+    if (HighlightedText* highlighted = static_cast<HighlightedText*>(currentBlockUserData())) {
+        highlighted->hash = hash;
+    } else {
+        setCurrentBlockUserData(new HighlightedText(hash));
+    }
+}
+
+const QTextCharFormat* CodeHighlighter::formatForField(Field field) const
+{
+    switch (field) {
+        case Field::STATE:
+            return &m_stateFormat;
+        case Field::SYMBOL:
+            return &m_symbolFormat;
+        case Field::DIRECTION:
+            return &m_directionFormat;
+        case Field::MODULE:
+            return &m_moduleFormat;
+        default:
+            return nullptr;
+    }
+}
+
+bool CodeHighlighter::isPending(const QTextBlock& block)
+{
+    const HighlightedText* highlighted = static_cast<const HighlightedText*>(block.userData());
+    return !highlighted || highlighted->hash != qHash(block.text());
+}
\ No newline at end of file
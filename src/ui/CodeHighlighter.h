@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+#include <vector>
+
+#include "../parser/CodeLexer.h"
+
+class QPlainTextEdit;
+class QTextBlock;
+
+/**
+ * Syntax highlighter for Turing machine code built on the parser's CodeLexer.
+ *
+ * Each block stores what kind of line it holds as its state. Blocks outside
+ * the visible range are left pending and only highlighted once they scroll
+ * into view, so huge generated machines load and scroll without lexing
+ * every line up front. Which blocks are pending is kept in their user data,
+ * with the text they were last highlighted from; their state and formats
+ * are left as they are, since a changed state makes Qt highlight the next
+ * block too.
+ */
+class CodeHighlighter : public QSyntaxHighlighter
+{
+    Q_OBJECT
+
+public:
+    // Block states
+    enum LineKind {
+        PENDING = -1,          // Never highlighted (QTextBlock default)
+        OTHER = 0,
+        STATE_DECLARATION,
+        TRANSITION,
+        COMMENT,
+        MODULE_DECLARATION,
+        MODULE_CALL
+    };
+
+    explicit CodeHighlighter(QTextDocument* document);
+
+    // Only lex blocks in this range; by default every block is highlighted
+    void setVisibleRange(int firstBlock, int lastBlock);
+
+    // Highlight pending blocks currently shown in the editor's viewport
+    void highlightVisibleBlocks(QPlainTextEdit* editor);
+
+protected:
+    void highlightBlock(const QString& text) override;
+
+private:
+    enum class Field {
+        NONE,
+        STATE,
+        SYMBOL,
+        DIRECTION,
+        NAME,
+        MODULE
+    };
+
+    QTextCharFormat m_keywordFormat;
+    QTextCharFormat m_stateFormat;
+    QTextCharFormat m_symbolFormat;
+    QTextCharFormat m_directionFormat;
+    QTextCharFormat m_moduleFormat;
+    QTextCharFormat m_commentFormat;
+    QTextCharFormat m_punctuationFormat;
+
+    int m_firstVisibleBlock;
+    int m_lastVisibleBlock;
+
+    std::vector<Token> m_tokens;  // Reused between blocks
+
+    const QTextCharFormat* formatForField(Field field) const;
+
+    // Not highlighted since its text last changed
+    static bool isPending(const QTextBlock& block);
+};
\ No newline at end of file
@@ -6,6 +6,9 @@
 #include "document/DocumentView.h"
 #include "document/CodeEditorView.h"
 #include "document/TapeVisualizationView.h"
+#include "document/SpaceTimeView.h"
+#include "document/StateGraphView.h"
+#include "document/MachineTablesView.h"
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
@@ -110,8 +113,76 @@ void DocumentTabManager::openProject(Project* project)
     }
 }
 
+void DocumentTabManager::openSpaceTimeView(TapeDocument* tapeDoc)
+{
+    if (!tapeDoc) return;
+
+    auto it = m_spaceTimeViews.find(tapeDoc);
+    if (it != m_spaceTimeViews.end()) {
+        setCurrentWidget(it->second);
+        return;
+    }
+
+    DocumentView* view = new SpaceTimeView(tapeDoc, this);
+    m_spaceTimeViews[tapeDoc] = view;
+    setCurrentIndex(addTab(view, QString()));
+    updateTabText(view);
+
+    connect(tapeDoc, &Document::nameChanged, view, [this, view](const std::string&) {
+        updateTabText(view);
+        view->updateFromDocument();
+    });
+}
+
+void DocumentTabManager::openStateGraphView(CodeDocument* codeDoc)
+{
+    if (!codeDoc) return;
+
+    auto it = m_graphViews.find(codeDoc);
+    if (it != m_graphViews.end()) {
+        setCurrentWidget(it->second);
+        return;
+    }
+
+    DocumentView* view = new StateGraphView(codeDoc, this);
+    m_graphViews[codeDoc] = view;
+    setCurrentIndex(addTab(view, QString()));
+    updateTabText(view);
+}
+
+void DocumentTabManager::openMachineTablesView(CodeDocument* codeDoc)
+{
+    if (!codeDoc) return;
+
+    auto it = m_tableViews.find(codeDoc);
+    if (it != m_tableViews.end()) {
+        setCurrentWidget(it->second);
+        return;
+    }
+
+    DocumentView* view = new MachineTablesView(codeDoc, this);
+    m_tableViews[codeDoc] = view;
+    setCurrentIndex(addTab(view, QString()));
+    updateTabText(view);
+}
+
 void DocumentTabManager::closeDocument(Document* document)
 {
+    auto it = m_spaceTimeViews.find(document);
+    if (it != m_spaceTimeViews.end()) {
+        onTabCloseRequested(indexOf(it->second));
+    }
+
+    auto graph = m_graphViews.find(document);
+    if (graph != m_graphViews.end()) {
+        onTabCloseRequested(indexOf(graph->second));
+    }
+
+    auto tables = m_tableViews.find(document);
+    if (tables != m_tableViews.end()) {
+        onTabCloseRequested(indexOf(tables->second));
+    }
+
     int index = findTabIndex(document);
     if (index >= 0) {
         onTabCloseRequested(index);
@@ -159,6 +230,17 @@ void DocumentTabManager::onTabCloseRequested(int index)
     Document* document = view->getDocument();
     if (!document) return;
 
+    // A diagram, graph or table closes without touching its document
+    for (auto* views : {&m_spaceTimeViews, &m_graphViews, &m_tableViews}) {
+        auto it = views->find(document);
+        if (it != views->end() && it->second == view) {
+            views->erase(it);
+            removeTab(index);
+            delete view;
+            return;
+        }
+    }
+
     // Check if document is modified
     if (document->getProject() && document->getProject()->isModified()) {
         QMessageBox::StandardButton result = QMessageBox::question(
@@ -240,6 +322,18 @@ void DocumentTabManager::updateTabText(DocumentView* view)
     if (!document) return;
 
     QString tabName = QString::fromStdString(document->getName());
+    if (qobject_cast<SpaceTimeView*>(view)) {
+        setTabText(index, tr("%1 (Space-Time)").arg(tabName));
+        return;
+    }
+    if (qobject_cast<StateGraphView*>(view)) {
+        setTabText(index, tr("%1 (Graph)").arg(tabName));
+        return;
+    }
+    if (qobject_cast<MachineTablesView*>(view)) {
+        setTabText(index, tr("%1 (Tables)").arg(tabName));
+        return;
+    }
     if (document->getProject() && document->getProject()->isModified()) {
         tabName += "*";
     }
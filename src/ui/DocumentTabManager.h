@@ -4,6 +4,7 @@
 #include <memory>
 #include <map>
 
+class CodeDocument;
 class Document;
 class DocumentView;
 class Project;
@@ -27,7 +28,16 @@ public:
     // Open a project - its documents will be opened in tabs
     void openProject(Project* project);
 
-    // Close specific document
+    // Open a space-time diagram of a tape's runs, in a tab next to the tape's
+    void openSpaceTimeView(TapeDocument* tapeDoc);
+
+    // Open a graph of the machine compiled from the code, in a tab next to the code's
+    void openStateGraphView(CodeDocument* codeDoc);
+
+    // Open tables of the machine's states and transitions, in a tab next to the code's
+    void openMachineTablesView(CodeDocument* codeDoc);
+
+    // Close specific document, with its space-time diagram, graph or tables if open
     void closeDocument(Document* document);
 
     // Close current tab
@@ -49,6 +59,9 @@ public:
 
 private:
     std::map<Document*, DocumentView*> m_documentViews;
+    std::map<Document*, DocumentView*> m_spaceTimeViews;  // Further tabs on tape documents
+    std::map<Document*, DocumentView*> m_graphViews;      // and on code documents
+    std::map<Document*, DocumentView*> m_tableViews;
     QMenu* m_tabContextMenu;
 
     void setupContextMenu();
@@ -0,0 +1,268 @@
+#include "GraphLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// A cell is taken as a whole when its size is below this fraction of its
+// distance; higher is faster and coarser
+constexpr float Theta = 1.2f;
+
+// Temperatures, as fractions of the edge length, and how fast they fall
+constexpr float InitialTemperature = 1.0f;
+constexpr float InitialTemperaturePerRoot = 0.1f;  // Times the square root of the node count
+constexpr float SettledTemperature = 0.005f;
+constexpr float Cooling = 0.97f;
+
+// Pull toward the middle per unit of distance
+constexpr float Gravity = 0.1f;
+
+// Nodes closer than this many edge lengths are pushed apart as if this far,
+// in a direction of their own
+constexpr float MinDistance = 0.01f;
+
+// Cells stop dividing here, holding all nodes at almost the same position
+constexpr int MaxDepth = 24;
+
+constexpr float GoldenAngle = 2.39996323f;
+
+// Graphs from this many nodes have their repulsion computed in parallel
+constexpr int ParallelThreshold = 2000;
+
+} // namespace
+
+GraphLayout::GraphLayout(std::vector<float> positions, const std::vector<std::pair<int, int>>& edges,
+                         float edgeLength)
+    : m_positions(std::move(positions)), m_edgeLength(edgeLength), m_iteration(0)
+{
+    const int count = nodeCount();
+    m_pinned.assign(count, 0);
+    m_displacement.assign(m_positions.size(), 0.0f);
+    m_temperature = m_edgeLength * (InitialTemperature +
+                                    InitialTemperaturePerRoot * std::sqrt(static_cast<float>(count)));
+
+    m_edges.reserve(edges.size() * 2);
+    for (const auto& edge : edges) {
+        if (edge.first != edge.second && edge.first >= 0 && edge.second >= 0 &&
+            edge.first < count && edge.second < count) {
+            m_edges.push_back(edge.first);
+            m_edges.push_back(edge.second);
+        }
+    }
+}
+
+void GraphLayout::setPinned(int node, bool pinned)
+{
+    if (node >= 0 && node < nodeCount()) {
+        m_pinned[node] = pinned ? 1 : 0;
+    }
+}
+
+bool GraphLayout::isSettled() const
+{
+    return nodeCount() == 0 || m_iteration >= MaxIterations ||
+           m_temperature < m_edgeLength * SettledTemperature;
+}
+
+bool GraphLayout::step()
+{
+    if (isSettled()) return false;
+
+    const int count = nodeCount();
+    buildTree();
+
+    // Repulsion between all nodes, each worker taking a range of them
+    int workerCount = 1;
+    if (count >= ParallelThreshold) {
+        workerCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < workerCount; ++i) {
+        workers.emplace_back(&GraphLayout::repelRange, this,
+                             count * i / workerCount, count * (i + 1) / workerCount);
+    }
+
+    repelRange(0, count / workerCount);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Attraction along edges
+    for (size_t e = 0; e < m_edges.size(); e += 2) {
+        const int a = m_edges[e];
+        const int b = m_edges[e + 1];
+        const float dx = m_positions[2 * a] - m_positions[2 * b];
+        const float dy = m_positions[2 * a + 1] - m_positions[2 * b + 1];
+        const float pull = std::sqrt(dx * dx + dy * dy) / m_edgeLength;
+        m_displacement[2 * a] -= dx * pull;
+        m_displacement[2 * a + 1] -= dy * pull;
+        m_displacement[2 * b] += dx * pull;
+        m_displacement[2 * b + 1] += dy * pull;
+    }
+
+    // Gravity toward the center of mass, which the root cell holds
+    const Cell& root = m_cells[0];
+    const float centerX = root.sumX / root.count;
+    const float centerY = root.sumY / root.count;
+
+    for (int i = 0; i < count; ++i) {
+        float dx = m_displacement[2 * i] - (m_positions[2 * i] - centerX) * Gravity;
+        float dy = m_displacement[2 * i + 1] - (m_positions[2 * i + 1] - centerY) * Gravity;
+        m_displacement[2 * i] = 0.0f;
+        m_displacement[2 * i + 1] = 0.0f;
+        if (m_pinned[i]) continue;
+
+        const float length = std::sqrt(dx * dx + dy * dy);
+        if (length > 0.0f) {
+            const float scale = std::min(length, m_temperature) / length;
+            m_positions[2 * i] += dx * scale;
+            m_positions[2 * i + 1] += dy * scale;
+        }
+    }
+
+    m_temperature *= Cooling;
+    ++m_iteration;
+    return !isSettled();
+}
+
+void GraphLayout::buildTree()
+{
+    const int count = nodeCount();
+    float minX = m_positions[0], maxX = minX;
+    float minY = m_positions[1], maxY = minY;
+    for (int i = 1; i < count; ++i) {
+        minX = std::min(minX, m_positions[2 * i]);
+        maxX = std::max(maxX, m_positions[2 * i]);
+        minY = std::min(minY, m_positions[2 * i + 1]);
+        maxY = std::max(maxY, m_positions[2 * i + 1]);
+    }
+
+    m_cells.clear();
+    m_cells.reserve(2 * count);
+    const float half = std::max(maxX - minX, maxY - minY) / 2 + m_edgeLength;
+    newCell((minX + maxX) / 2, (minY + maxY) / 2, half);
+
+    for (int i = 0; i < count; ++i) {
+        insert(i);
+    }
+}
+
+int GraphLayout::newCell(float x, float y, float half)
+{
+    m_cells.push_back(Cell{x, y, half, 0.0f, 0.0f, 0, -1, {-1, -1, -1, -1}});
+    return static_cast<int>(m_cells.size()) - 1;
+}
+
+void GraphLayout::insert(int node)
+{
+    const float x = m_positions[2 * node];
+    const float y = m_positions[2 * node + 1];
+
+    // Cells are appended while descending, so they are looked up by index
+    auto childFor = [this](int cell, float px, float py) {
+        const Cell& parent = m_cells[cell];
+        const int quadrant = (px >= parent.x ? 1 : 0) | (py >= parent.y ? 2 : 0);
+        if (parent.children[quadrant] < 0) {
+            const float half = parent.half / 2;
+            const int child = newCell(parent.x + ((quadrant & 1) ? half : -half),
+                                      parent.y + ((quadrant & 2) ? half : -half), half);
+            m_cells[cell].children[quadrant] = child;
+        }
+        return m_cells[cell].children[quadrant];
+    };
+
+    int cell = 0;
+    for (int depth = 0;; ++depth) {
+        Cell& current = m_cells[cell];
+        current.sumX += x;
+        current.sumY += y;
+        if (++current.count == 1) {
+            current.node = node;
+            return;
+        }
+        if (depth == MaxDepth) {
+            current.node = -1;
+            return;
+        }
+
+        // The node that was alone here moves down a level
+        const int other = current.node;
+        if (other >= 0) {
+            current.node = -1;
+            const float otherX = m_positions[2 * other];
+            const float otherY = m_positions[2 * other + 1];
+            Cell& child = m_cells[childFor(cell, otherX, otherY)];
+            child.sumX = otherX;
+            child.sumY = otherY;
+            child.count = 1;
+            child.node = other;
+        }
+        cell = childFor(cell, x, y);
+    }
+}
+
+void GraphLayout::repelRange(int first, int last)
+{
+    std::vector<int32_t> stack;
+    for (int i = first; i < last; ++i) {
+        repel(i, m_displacement[2 * i], m_displacement[2 * i + 1], stack);
+    }
+}
+
+void GraphLayout::repel(int node, float& dx, float& dy, std::vector<int32_t>& stack) const
+{
+    const float x = m_positions[2 * node];
+    const float y = m_positions[2 * node + 1];
+    const float strength = m_edgeLength * m_edgeLength;
+    const float minDistance = m_edgeLength * MinDistance;
+
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Cell& cell = m_cells[stack.back()];
+        stack.pop_back();
+
+        // Leave the node itself out of the cells it is in
+        float count = static_cast<float>(cell.count);
+        float sumX = cell.sumX;
+        float sumY = cell.sumY;
+        if (x >= cell.x - cell.half && x < cell.x + cell.half &&
+            y >= cell.y - cell.half && y < cell.y + cell.half) {
+            count -= 1;
+            sumX -= x;
+            sumY -= y;
+        }
+        if (count <= 0.0f) continue;
+
+        const float offsetX = x - sumX / count;
+        const float offsetY = y - sumY / count;
+        const float distance2 = offsetX * offsetX + offsetY * offsetY;
+        const float size = 2 * cell.half;
+
+        const bool leaf = cell.children[0] < 0 && cell.children[1] < 0 &&
+                          cell.children[2] < 0 && cell.children[3] < 0;
+        if (!leaf && size * size >= Theta * Theta * distance2) {
+            for (int child : cell.children) {
+                if (child >= 0) {
+                    stack.push_back(child);
+                }
+            }
+            continue;
+        }
+
+        if (distance2 < minDistance * minDistance) {
+            // On top of each other; separate in a direction that differs per node
+            const float angle = GoldenAngle * node;
+            dx += std::cos(angle) * strength * count / minDistance;
+            dy += std::sin(angle) * strength * count / minDistance;
+        } else {
+            const float force = strength * count / distance2;
+            dx += offsetX * force;
+            dy += offsetY * force;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Force-directed layout of a graph: edges pull the nodes they join
+ * together, all nodes push each other apart and a weak gravity keeps
+ * unconnected parts from drifting off. Repulsion is approximated with a
+ * Barnes-Hut quadtree, so an iteration costs O(n log n + e) rather than
+ * O(n^2). How far a node may move is capped by a temperature that cools
+ * with every iteration, until the layout has settled.
+ *
+ * Pinned nodes push and pull the others but stay where they are. An
+ * instance is not shared between threads; a worker owns it while it runs.
+ */
+class GraphLayout
+{
+public:
+    // Positions are x, y pairs in node order. Edges joining a node to
+    // itself are ignored.
+    GraphLayout(std::vector<float> positions, const std::vector<std::pair<int, int>>& edges,
+                float edgeLength);
+
+    void setPinned(int node, bool pinned);
+
+    // One iteration; false once the layout has settled
+    bool step();
+
+    bool isSettled() const;
+    int getIteration() const { return m_iteration; }
+    const std::vector<float>& getPositions() const { return m_positions; }
+
+    // Gives up on settling after this many iterations
+    static constexpr int MaxIterations = 1000;
+
+private:
+    struct Cell {
+        float x, y, half;      // Square covered, by its center
+        float sumX, sumY;      // Of the positions of the nodes inside
+        int32_t count;
+        int32_t node;          // The only node inside, -1 if none or several
+        int32_t children[4];   // -1 where nothing is inside
+    };
+
+    std::vector<float> m_positions;
+    std::vector<int32_t> m_edges;  // Pairs of node indexes
+    std::vector<uint8_t> m_pinned;
+    float m_edgeLength;
+    float m_temperature;
+    int m_iteration;
+
+    std::vector<Cell> m_cells;
+    std::vector<float> m_displacement;
+
+    int nodeCount() const { return static_cast<int>(m_positions.size() / 2); }
+
+    void buildTree();
+    int newCell(float x, float y, float half);
+    void insert(int node);
+    void repelRange(int first, int last);
+    void repel(int node, float& dx, float& dy, std::vector<int32_t>& stack) const;
+};
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * Rows of pointers into a TuringMachine for the state and transition
+ * tables. Cells are only formatted when a view asks for them, so a table
+ * of 100k transitions costs a vector of pointers rather than an item per
+ * cell. Filtering and sorting work on these rows directly, comparing the
+ * machine's strings instead of formatted cells, and edits made through a
+ * model insert, remove, move or update single rows.
+ *
+ * The rows are always sorted by lessThan, a total order, so a row is found
+ * by binary search. Subclasses must find an item's row before changing any
+ * field it is sorted or filtered by, and place it again afterwards.
+ */
+template<typename Item>
+class MachineTableModel : public QAbstractTableModel
+{
+public:
+    explicit MachineTableModel(QObject* parent = nullptr)
+        : QAbstractTableModel(parent), m_sortColumn(0), m_sortOrder(Qt::AscendingOrder)
+    {
+    }
+
+    Item* itemAt(int row) const
+    {
+        return row >= 0 && row < static_cast<int>(m_rows.size()) ? m_rows[row] : nullptr;
+    }
+
+    // -1 when filtered out
+    int rowOf(const Item* item) const
+    {
+        if (!item) return -1;
+        auto it = std::lower_bound(m_rows.begin(), m_rows.end(), item, lessThanFunction());
+        return it != m_rows.end() && *it == item ? static_cast<int>(it - m_rows.begin()) : -1;
+    }
+
+    // Only items with a field containing the text are shown
+    void setFilterText(const QString& text)
+    {
+        const std::string filter = text.toStdString();
+        if (filter != m_filter) {
+            m_filter = filter;
+            refresh();
+        }
+    }
+
+    // Read all items again, after changes made to the machine elsewhere
+    void refresh()
+    {
+        beginResetModel();
+        m_rows.clear();
+        collect(m_rows);
+        if (!m_filter.empty()) {
+            m_rows.erase(std::remove_if(m_rows.begin(), m_rows.end(),
+                                        [this](const Item* item) { return !matches(item); }),
+                         m_rows.end());
+        }
+        std::sort(m_rows.begin(), m_rows.end(), lessThanFunction());
+        endResetModel();
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+    }
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override
+    {
+        emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+        // Selections and the current index follow their items
+        const QModelIndexList persistent = persistentIndexList();
+        std::vector<Item*> items;
+        items.reserve(persistent.size());
+        for (const QModelIndex& index : persistent) {
+            items.push_back(itemAt(index.row()));
+        }
+
+        m_sortColumn = std::max(column, 0);
+        m_sortOrder = order;
+        std::sort(m_rows.begin(), m_rows.end(), lessThanFunction());
+
+        QModelIndexList moved;
+        moved.reserve(persistent.size());
+        for (int i = 0; i < persistent.size(); ++i) {
+            moved.append(index(rowOf(items[i]), persistent[i].column()));
+        }
+        changePersistentIndexList(persistent, moved);
+
+        emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+protected:
+    std::vector<Item*> m_rows;
+    std::string m_filter;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+
+    // All items of the machine, in any order
+    virtual void collect(std::vector<Item*>& items) const = 0;
+
+    // Compares one column, 0 when equal; ties are broken by the item's key
+    virtual int compare(const Item* a, const Item* b, int column) const = 0;
+    virtual int compareKeys(const Item* a, const Item* b) const = 0;
+
+    virtual bool matches(const Item* item) const = 0;
+
+    bool contains(const std::string& field) const
+    {
+        return field.find(m_filter) != std::string::npos;
+    }
+
+    bool lessThan(const Item* a, const Item* b) const
+    {
+        int result = compare(a, b, m_sortColumn);
+        if (result == 0) {
+            result = compareKeys(a, b);
+        }
+        return m_sortOrder == Qt::AscendingOrder ? result < 0 : result > 0;
+    }
+
+    void insertRowFor(Item* item)
+    {
+        if (!item || (!m_filter.empty() && !matches(item))) return;
+
+        const int row = static_cast<int>(std::lower_bound(m_rows.begin(), m_rows.end(), item, lessThanFunction()) - m_rows.begin());
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insert(m_rows.begin() + row, item);
+        endInsertRows();
+    }
+
+    void removeRowAt(int row)
+    {
+        if (row < 0) return;
+
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.erase(m_rows.begin() + row);
+        endRemoveRows();
+    }
+
+    // The item at this row changed: update it, move it to where it sorts
+    // now, or remove it if it no longer matches the filter
+    void placeRow(int row)
+    {
+        Item* item = m_rows[row];
+        if (!m_filter.empty() && !matches(item)) {
+            removeRowAt(row);
+            return;
+        }
+
+        // Search the rows on the side it moves to, which are still in order
+        auto begin = m_rows.begin();
+        int target;
+        if (row > 0 && lessThan(item, m_rows[row - 1])) {
+            target = static_cast<int>(std::lower_bound(begin, begin + row, item, lessThanFunction()) - begin);
+        } else {
+            target = static_cast<int>(std::lower_bound(begin + row + 1, m_rows.end(), item, lessThanFunction()) - begin) - 1;
+        }
+
+        if (target != row) {
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), target > row ? target + 1 : target);
+            if (target > row) {
+                std::rotate(begin + row, begin + row + 1, begin + target + 1);
+            } else {
+                std::rotate(begin + target, begin + row, begin + row + 1);
+            }
+            endMoveRows();
+        }
+        emit dataChanged(index(target, 0), index(target, columnCount() - 1));
+    }
+
+    // Changes an item's fields and keeps its row in place
+    template<typename Change>
+    void editItem(Item* item, Change change)
+    {
+        const int row = rowOf(item);
+        change();
+        if (row >= 0) {
+            placeRow(row);
+        } else {
+            insertRowFor(item);  // Filtered out before, may match now
+        }
+    }
+
+private:
+    struct LessThan {
+        const MachineTableModel* model;
+        bool operator()(const Item* a, const Item* b) const { return model->lessThan(a, b); }
+    };
+
+    LessThan lessThanFunction() const { return LessThan{this}; }
+};
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "MainWindow.h"
 #include "DocumentTabManager.h"
+#include "PreferencesDialog.h"
 #include "../document/Document.h"
+#include "../document/CodeDocument.h"
+#include "../document/TapeDocument.h"
+#include "../model/TuringMachine.h"
+#include "../parser/MachineNotation.h"
 #include "../project/Project.h"
 #include "../project/ProjectManager.h"
 #include <QApplication>
@@ -14,6 +19,9 @@
 #include <QCloseEvent>
 #include <QInputDialog>
 #include <QScreen>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), m_currentDocument(nullptr), m_currentProject(nullptr)
@@ -34,6 +42,12 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_tabManager, &DocumentTabManager::documentTabClosed,
             this, &MainWindow::onDocumentTabClosed);
 
+    // Saves finish in the background
+    connect(&ProjectManager::getInstance(), &ProjectManager::projectSaved,
+            this, &MainWindow::onProjectSaved);
+    connect(&ProjectManager::getInstance(), &ProjectManager::projectSaveFailed,
+            this, &MainWindow::onProjectSaveFailed);
+
     // Read settings
     readSettings();
 
@@ -83,6 +97,9 @@ void MainWindow::closeEvent(QCloseEvent *event)
         }
     }
 
+    // Let background saves complete before the projects go away
+    ProjectManager::getInstance().waitForPendingSaves();
+
     writeSettings();
     event->accept();
 }
@@ -115,6 +132,58 @@ void MainWindow::createActions()
     m_saveAsProjectAction->setEnabled(false); // Disabled until a project is active
     connect(m_saveAsProjectAction, &QAction::triggered, this, &MainWindow::saveProjectAs);
 
+    // Export JSON action
+    m_exportJsonAction = new QAction(tr("&Export as JSON..."), this);
+    m_exportJsonAction->setStatusTip(tr("Write the current project as a JSON file"));
+    m_exportJsonAction->setEnabled(false); // Disabled until a project is active
+    connect(m_exportJsonAction, &QAction::triggered, this, &MainWindow::exportProjectAsJson);
+
+    // Import Code action
+    m_importCodeAction = new QAction(tr("&Import Machine Code..."), this);
+    m_importCodeAction->setStatusTip(tr("Load machine code from a file into the current project"));
+    m_importCodeAction->setEnabled(false); // Disabled until a project is active
+    connect(m_importCodeAction, &QAction::triggered, this, &MainWindow::importMachineCode);
+
+    // Import Corpus action
+    m_importCorpusAction = new QAction(tr("Import Machine &Corpus..."), this);
+    m_importCorpusAction->setStatusTip(tr("Open every machine of a busy beaver or Morphett file as a project"));
+    connect(m_importCorpusAction, &QAction::triggered, this, &MainWindow::importMachineCorpus);
+
+    // Export Notation action
+    m_exportNotationAction = new QAction(tr("Export Machine &Notation..."), this);
+    m_exportNotationAction->setStatusTip(tr("Write the current machine in the busy beaver or Morphett notation"));
+    m_exportNotationAction->setEnabled(false); // Disabled until a project is active
+    connect(m_exportNotationAction, &QAction::triggered, this, &MainWindow::exportMachineNotation);
+
+    // Autosave action
+    m_autosaveAction = new QAction(tr("A&utosave Interval..."), this);
+    m_autosaveAction->setStatusTip(tr("Choose how often modified projects are autosaved"));
+    connect(m_autosaveAction, &QAction::triggered, this, &MainWindow::setAutosaveInterval);
+
+    // Preferences action
+    m_preferencesAction = new QAction(tr("&Preferences..."), this);
+    m_preferencesAction->setShortcuts(QKeySequence::Preferences);
+    m_preferencesAction->setStatusTip(tr("Choose how much execution history is kept"));
+    connect(m_preferencesAction, &QAction::triggered, this, &MainWindow::showPreferences);
+
+    // Space-Time Diagram action
+    m_spaceTimeAction = new QAction(tr("&Space-Time Diagram"), this);
+    m_spaceTimeAction->setStatusTip(tr("Show the current tape's run over time in a tab of its own"));
+    m_spaceTimeAction->setEnabled(false); // Disabled until a tape is active
+    connect(m_spaceTimeAction, &QAction::triggered, this, &MainWindow::showSpaceTimeDiagram);
+
+    // State Graph action
+    m_stateGraphAction = new QAction(tr("State &Graph"), this);
+    m_stateGraphAction->setStatusTip(tr("Show the machine's states and transitions as a graph in a tab of its own"));
+    m_stateGraphAction->setEnabled(false); // Disabled until a project is open
+    connect(m_stateGraphAction, &QAction::triggered, this, &MainWindow::showStateGraph);
+
+    // Machine Tables action
+    m_machineTablesAction = new QAction(tr("State &Tables"), this);
+    m_machineTablesAction->setStatusTip(tr("List and edit the machine's states and transitions in a tab of its own"));
+    m_machineTablesAction->setEnabled(false); // Disabled until a project is open
+    connect(m_machineTablesAction, &QAction::triggered, this, &MainWindow::showMachineTables);
+
     // Exit action
     m_exitAction = new QAction(tr("E&xit"), this);
     m_exitAction->setShortcuts(QKeySequence::Quit);
@@ -131,13 +200,24 @@ void MainWindow::createMenus()
     m_fileMenu->addAction(m_saveProjectAction);
     m_fileMenu->addAction(m_saveAsProjectAction);
     m_fileMenu->addSeparator();
+    m_fileMenu->addAction(m_importCodeAction);
+    m_fileMenu->addAction(m_importCorpusAction);
+    m_fileMenu->addAction(m_exportJsonAction);
+    m_fileMenu->addAction(m_exportNotationAction);
+    m_fileMenu->addSeparator();
+    m_fileMenu->addAction(m_autosaveAction);
+    m_fileMenu->addSeparator();
     m_fileMenu->addAction(m_exitAction);
 
-    // Edit menu (placeholder)
+    // Edit menu
     m_editMenu = menuBar()->addMenu(tr("&Edit"));
+    m_editMenu->addAction(m_preferencesAction);
 
-    // View menu (placeholder)
+    // View menu
     m_viewMenu = menuBar()->addMenu(tr("&View"));
+    m_viewMenu->addAction(m_spaceTimeAction);
+    m_viewMenu->addAction(m_stateGraphAction);
+    m_viewMenu->addAction(m_machineTablesAction);
 
     // Help menu (placeholder)
     m_helpMenu = menuBar()->addMenu(tr("&Help"));
@@ -217,7 +297,7 @@ void MainWindow::openProject()
         this,
         tr("Open Project"),
         QString(),
-        tr("Turing Machine Projects (*.tmproj);;All Files (*)")
+        tr("Turing Machine Projects (*.tmproj *.json);;All Files (*)")
     );
 
     if (filePath.isEmpty()) return;
@@ -232,8 +312,25 @@ void MainWindow::openProject()
         return;
     }
 
+    // Offer work autosaved after the file was last saved, e.g. before a crash
+    Project* project = nullptr;
+    if (ProjectManager::getInstance().hasNewerAutosave(filePath.toStdString())) {
+        QMessageBox::StandardButton result = QMessageBox::question(
+            this,
+            tr("Recover Project"),
+            tr("An autosave newer than %1 was found. Recover the autosaved project?").arg(filePath),
+            QMessageBox::Yes | QMessageBox::No
+        );
+
+        if (result == QMessageBox::Yes) {
+            project = ProjectManager::getInstance().recoverProject(filePath.toStdString());
+        }
+    }
+
     // Try to open the project
-    Project* project = ProjectManager::getInstance().openProject(filePath.toStdString());
+    if (!project) {
+        project = ProjectManager::getInstance().openProject(filePath.toStdString());
+    }
 
     if (project) {
         // Open the project's documents in tabs
@@ -255,14 +352,7 @@ void MainWindow::saveProject()
     }
 
     if (ProjectManager::getInstance().saveProject(m_currentProject)) {
-        statusBar()->showMessage(tr("Project saved"), 2000);
-        updateWindowTitle();
-    } else {
-        QMessageBox::warning(
-            this,
-            tr("Save Error"),
-            tr("Failed to save the project")
-        );
+        statusBar()->showMessage(tr("Saving project..."));
     }
 }
 
@@ -285,13 +375,223 @@ void MainWindow::saveProjectAs()
     }
 
     if (ProjectManager::getInstance().saveProjectAs(m_currentProject, filePath.toStdString())) {
-        statusBar()->showMessage(tr("Project saved as %1").arg(filePath), 2000);
+        statusBar()->showMessage(tr("Saving project as %1...").arg(filePath));
+    }
+}
+
+void MainWindow::onProjectSaved(Project* project)
+{
+    statusBar()->showMessage(tr("Project saved as %1").arg(
+        QString::fromStdString(project->getFilePath())), 2000);
+    updateWindowTitle();
+}
+
+void MainWindow::onProjectSaveFailed(Project* project, const std::string& path)
+{
+    Q_UNUSED(project);
+    QMessageBox::warning(
+        this,
+        tr("Save Error"),
+        tr("Failed to save the project as %1").arg(QString::fromStdString(path))
+    );
+}
+
+void MainWindow::setAutosaveInterval()
+{
+    bool ok;
+    int minutes = QInputDialog::getInt(
+        this,
+        tr("Autosave Interval"),
+        tr("Autosave modified projects every (minutes, 0 to disable):"),
+        ProjectManager::getInstance().getAutosaveInterval(),
+        0, 120, 1, &ok
+    );
+
+    if (ok) {
+        ProjectManager::getInstance().setAutosaveInterval(minutes);
+    }
+}
+
+void MainWindow::showPreferences()
+{
+    ProjectManager& manager = ProjectManager::getInstance();
+    PreferencesDialog dialog(manager.getHistoryMemoryLimit(), manager.getHistoryDiskLimit(), this);
+    if (dialog.exec() == QDialog::Accepted) {
+        manager.setHistoryLimits(dialog.getHistoryMemoryLimit(), dialog.getHistoryDiskLimit());
+    }
+}
+
+void MainWindow::showSpaceTimeDiagram()
+{
+    if (!m_currentDocument || m_currentDocument->getType() != Document::DocumentType::TAPE) return;
+
+    m_tabManager->openSpaceTimeView(static_cast<TapeDocument*>(m_currentDocument));
+}
+
+void MainWindow::showStateGraph()
+{
+    if (!m_currentProject) return;
+
+    m_tabManager->openStateGraphView(m_currentProject->getCodeDocument());
+}
+
+void MainWindow::showMachineTables()
+{
+    if (!m_currentProject) return;
+
+    m_tabManager->openMachineTablesView(m_currentProject->getCodeDocument());
+}
+
+void MainWindow::exportProjectAsJson()
+{
+    if (!m_currentProject) return;
+
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Project as JSON"),
+        QString::fromStdString(m_currentProject->getName()),
+        tr("JSON Projects (*.json)")
+    );
+
+    if (filePath.isEmpty()) return;
+
+    // Add extension if missing
+    if (!filePath.endsWith(".json")) {
+        filePath += ".json";
+    }
+
+    if (m_currentProject->exportToJson(filePath.toStdString())) {
+        statusBar()->showMessage(tr("Project exported to %1").arg(filePath), 2000);
+    } else {
+        QMessageBox::warning(
+            this,
+            tr("Export Error"),
+            tr("Failed to export the project to %1").arg(filePath)
+        );
+    }
+}
+
+void MainWindow::importMachineCode()
+{
+    if (!m_currentProject || !m_currentProject->getCodeDocument()) return;
+
+    QString filePath = QFileDialog::getOpenFileName(
+        this,
+        tr("Import Machine Code"),
+        QString(),
+        tr("Turing Machine Code (*.tm *.txt);;All Files (*)")
+    );
+
+    if (filePath.isEmpty()) return;
+
+    CodeDocument* codeDocument = m_currentProject->getCodeDocument();
+    if (codeDocument->loadFromFile(filePath.toStdString())) {
+        m_tabManager->openDocument(codeDocument);
+        statusBar()->showMessage(tr("Imported machine code from %1").arg(filePath), 2000);
         updateWindowTitle();
     } else {
         QMessageBox::warning(
             this,
-            tr("Save Error"),
-            tr("Failed to save the project as %1").arg(filePath)
+            tr("Import Error"),
+            tr("Failed to import machine code from %1").arg(filePath)
+        );
+    }
+}
+
+void MainWindow::importMachineCorpus()
+{
+    QString filePath = QFileDialog::getOpenFileName(
+        this,
+        tr("Import Machine Corpus"),
+        QString(),
+        tr("Machine Corpora (*.txt *.csv);;All Files (*)")
+    );
+
+    if (filePath.isEmpty()) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    size_t skipped = 0;
+    std::vector<Project*> projects = ProjectManager::getInstance().importCorpus(filePath.toStdString(), &skipped);
+    qint64 elapsed = std::max<qint64>(1, timer.elapsed());
+
+    if (projects.empty()) {
+        QMessageBox::warning(
+            this,
+            tr("Import Error"),
+            tr("No machines could be imported from %1").arg(filePath)
+        );
+        return;
+    }
+
+    statusBar()->showMessage(tr("Imported %1 machines in %2 ms (%3 machines/s), skipped %4")
+        .arg(projects.size()).arg(elapsed)
+        .arg(static_cast<qint64>(projects.size() * 1000 / elapsed)).arg(skipped));
+
+    // Every machine is a project now, open the one asked for
+    Project* project = projects.front();
+    if (projects.size() > 1) {
+        QStringList names;
+        for (Project* imported : projects) {
+            names << QString::fromStdString(imported->getName());
+        }
+
+        bool ok;
+        QString name = QInputDialog::getItem(
+            this,
+            tr("Import Machine Corpus"),
+            tr("Imported %1 machines. Open:").arg(projects.size()),
+            names, 0, false, &ok
+        );
+        if (!ok) return;
+        project = projects[names.indexOf(name)];
+    }
+
+    m_tabManager->openProject(project);
+}
+
+void MainWindow::exportMachineNotation()
+{
+    if (!m_currentProject) return;
+
+    QString standardFilter = tr("Busy Beaver Notation (*.txt)");
+    QString morphettFilter = tr("Morphett Programs (*.tm)");
+    QString selectedFilter = standardFilter;
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Machine Notation"),
+        QString::fromStdString(m_currentProject->getName()),
+        standardFilter + ";;" + morphettFilter,
+        &selectedFilter
+    );
+
+    if (filePath.isEmpty()) return;
+
+    MachineNotation::Format format = selectedFilter == morphettFilter
+        ? MachineNotation::Format::MORPHETT : MachineNotation::Format::STANDARD;
+
+    std::string text;
+    if (!MachineNotation::write(*m_currentProject->getMachine(), format, text)) {
+        QMessageBox::warning(
+            this,
+            tr("Export Error"),
+            tr("The machine can't be written in this notation")
+        );
+        return;
+    }
+    if (format == MachineNotation::Format::STANDARD) {
+        text += '\n';
+    }
+
+    QFile file(filePath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+        file.write(text.data(), static_cast<qint64>(text.size())) == static_cast<qint64>(text.size())) {
+        statusBar()->showMessage(tr("Machine exported to %1").arg(filePath), 2000);
+    } else {
+        QMessageBox::warning(
+            this,
+            tr("Export Error"),
+            tr("Failed to export the machine to %1").arg(filePath)
         );
     }
 }
@@ -339,6 +639,12 @@ void MainWindow::updateUIForDocument(Document* document)
     // Enable/disable actions based on having a document
     m_saveProjectAction->setEnabled(m_currentProject != nullptr);
     m_saveAsProjectAction->setEnabled(m_currentProject != nullptr);
+    m_importCodeAction->setEnabled(m_currentProject != nullptr);
+    m_exportJsonAction->setEnabled(m_currentProject != nullptr);
+    m_exportNotationAction->setEnabled(m_currentProject != nullptr);
+    m_spaceTimeAction->setEnabled(document && document->getType() == Document::DocumentType::TAPE);
+    m_stateGraphAction->setEnabled(m_currentProject != nullptr);
+    m_machineTablesAction->setEnabled(m_currentProject != nullptr);
 
     // Update status bar
     if (document) {
@@ -2,6 +2,7 @@
 
 #include <QMainWindow>
 #include <memory>
+#include <string>
 
 class DocumentTabManager;
 class QAction;
@@ -30,6 +31,19 @@ protected:
     void openProject();
     void saveProject();
     void saveProjectAs();
+    void exportProjectAsJson();
+    void importMachineCode();
+    void importMachineCorpus();
+    void exportMachineNotation();
+    void setAutosaveInterval();
+    void showPreferences();
+    void showSpaceTimeDiagram();
+    void showStateGraph();
+    void showMachineTables();
+
+    // Background save results
+    void onProjectSaved(Project* project);
+    void onProjectSaveFailed(Project* project, const std::string& path);
 
     // Tab handling
     void onDocumentTabChanged(Document* document);
@@ -53,6 +67,15 @@ private:
     QAction* m_openProjectAction;
     QAction* m_saveProjectAction;
     QAction* m_saveAsProjectAction;
+    QAction* m_exportJsonAction;
+    QAction* m_importCodeAction;
+    QAction* m_importCorpusAction;
+    QAction* m_exportNotationAction;
+    QAction* m_autosaveAction;
+    QAction* m_preferencesAction;
+    QAction* m_spaceTimeAction;
+    QAction* m_stateGraphAction;
+    QAction* m_machineTablesAction;
     QAction* m_exitAction;
 
     // Current document and project
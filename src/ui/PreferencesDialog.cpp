@@ -4,20 +4,33 @@
 #include <QFormLayout>
 #include <QVBoxLayout>
 #include <QSpinBox>
+#include <QLabel>
 #include <QDialogButtonBox>
 
-PreferencesDialog::PreferencesDialog(int currentSpeed, QWidget *parent)
+PreferencesDialog::PreferencesDialog(int historyMemoryLimit, int historyDiskLimit, QWidget *parent)
     : QDialog(parent)
 {
     setWindowTitle(tr("Preferences"));
     
     QFormLayout* formLayout = new QFormLayout();
     
-    speedSpinBox = new QSpinBox(this);
-    speedSpinBox->setRange(50, 1000);
-    speedSpinBox->setValue(currentSpeed);
-    speedSpinBox->setSingleStep(50);
-    formLayout->addRow(tr("Simulation Speed (ms/step):"), speedSpinBox);
+    historyMemorySpinBox = new QSpinBox(this);
+    historyMemorySpinBox->setRange(1, 65536);
+    historyMemorySpinBox->setValue(historyMemoryLimit);
+    historyMemorySpinBox->setSuffix(tr(" MB"));
+    formLayout->addRow(tr("History in memory:"), historyMemorySpinBox);
+
+    historyDiskSpinBox = new QSpinBox(this);
+    historyDiskSpinBox->setRange(0, 1048576);
+    historyDiskSpinBox->setValue(historyDiskLimit);
+    historyDiskSpinBox->setSuffix(tr(" MB"));
+    historyDiskSpinBox->setSpecialValueText(tr("Off"));
+    formLayout->addRow(tr("History on disk:"), historyDiskSpinBox);
+
+    QLabel* historyNote = new QLabel(tr("Per machine. Older steps move to a temporary file once the memory "
+                                        "is used up, and are dropped once the disk space is too."), this);
+    historyNote->setWordWrap(true);
+    formLayout->addRow(historyNote);
     
     buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
@@ -28,7 +41,12 @@ PreferencesDialog::PreferencesDialog(int currentSpeed, QWidget *parent)
     mainLayout->addWidget(buttonBox);
 }
 
-int PreferencesDialog::getSimulationSpeed() const
+int PreferencesDialog::getHistoryMemoryLimit() const
+{
+    return historyMemorySpinBox->value();
+}
+
+int PreferencesDialog::getHistoryDiskLimit() const
 {
-    return speedSpinBox->value();
+    return historyDiskSpinBox->value();
 }
\ No newline at end of file
@@ -11,10 +11,13 @@ class PreferencesDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit PreferencesDialog(int currentSpeed, QWidget *parent = nullptr);
-    int getSimulationSpeed() const;
+    // Limits in megabytes
+    PreferencesDialog(int historyMemoryLimit, int historyDiskLimit, QWidget *parent = nullptr);
+    int getHistoryMemoryLimit() const;
+    int getHistoryDiskLimit() const;
 
 private:
-    QSpinBox* speedSpinBox;
+    QSpinBox* historyMemorySpinBox;
+    QSpinBox* historyDiskSpinBox;
     QDialogButtonBox* buttonBox;
 };
\ No newline at end of file
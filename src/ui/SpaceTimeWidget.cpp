@@ -0,0 +1,439 @@
+#include "SpaceTimeWidget.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "../model/Tape.h"
+#include "../model/Transition.h"
+#include "../model/TuringMachine.h"
+
+namespace {
+
+const QRgb EmptyColor = qRgb(250, 250, 250);
+const QRgb WrittenColor = qRgb(30, 80, 170);
+const QRgb HeadColor = qRgb(220, 40, 40);
+
+// Widget pixels per column or row, as far as zooming goes either way
+constexpr double MinScale = 1.0 / 64;
+constexpr double MaxScale = 32.0;
+
+constexpr double ZoomStep = 1.25;
+
+QRgb average(QRgb a, QRgb b)
+{
+    return 0xff000000u | (((a >> 1) & 0x7f7f7fu) + ((b >> 1) & 0x7f7f7fu));
+}
+
+QRgb mix(QRgb from, QRgb to, double amount)
+{
+    return qRgb(qRed(from) + qRound((qRed(to) - qRed(from)) * amount),
+                qGreen(from) + qRound((qGreen(to) - qGreen(from)) * amount),
+                qBlue(from) + qRound((qBlue(to) - qBlue(from)) * amount));
+}
+
+} // namespace
+
+SpaceTimeWidget::SpaceTimeWidget(QWidget* parent)
+    : QWidget(parent), m_tape(nullptr), m_machine(nullptr),
+      m_image(Columns, MaxRows + 1, QImage::Format_RGB32), m_rows(0),
+      m_line(Columns, Column{0, EmptyColor}), m_lineStale(false), m_origin(0), m_cellsPerColumn(1),
+      m_usedFirst(0), m_usedLast(0), m_firstStep(0), m_stepsPerRow(1), m_rowSteps(0),
+      m_headFirst(0), m_headLast(0), m_fit(true), m_scaleX(1.0), m_scaleY(1.0),
+      m_repaintPending(false)
+{
+    setMinimumSize(200, 150);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setToolTip(tr("Drag to pan, wheel to zoom, double-click to fit"));
+}
+
+SpaceTimeWidget::~SpaceTimeWidget()
+{
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+}
+
+void SpaceTimeWidget::setTape(const Tape* tape)
+{
+    m_tape = tape;
+    restart();
+}
+
+void SpaceTimeWidget::setMachine(TuringMachine* machine)
+{
+    if (machine == m_machine) return;
+
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+    m_machine = machine;
+    if (m_machine) {
+        m_machine->addObserver(this);
+    }
+    restart();
+}
+
+void SpaceTimeWidget::restart()
+{
+    m_rows = 0;
+    m_stepsPerRow = 1;
+    m_rowSteps = 0;
+    m_firstStep = m_machine ? m_machine->getStepCount() : 0;
+    m_origin = 0;
+    m_cellsPerColumn = 1;
+    m_usedFirst = m_usedLast = Columns / 2;
+
+    if (m_tape) {
+        // Center the used cells, at the finest resolution that holds them
+        const int64_t head = m_tape->getHeadPosition();
+        const int64_t left = std::min<int64_t>(m_tape->getLeftmostUsedPosition(), head);
+        const int64_t right = std::max<int64_t>(m_tape->getRightmostUsedPosition(), head);
+        while (right - left + 1 > Columns * m_cellsPerColumn) {
+            m_cellsPerColumn *= 2;
+        }
+        m_origin = (left + right) / 2 - (Columns / 2) * m_cellsPerColumn;
+        m_usedFirst = columnOf(left);
+        m_usedLast = columnOf(right);
+    }
+
+    rebuildLine();
+    fitToView();
+}
+
+void SpaceTimeWidget::refreshLine()
+{
+    if (m_lineStale) {
+        rebuildLine();
+    }
+}
+
+void SpaceTimeWidget::rebuildLine()
+{
+    m_lineStale = false;
+    std::fill(m_line.begin(), m_line.end(), Column{0, EmptyColor});
+    if (!m_tape) return;
+
+    m_tape->forEachRun([this](int start, int length, const std::string& symbols) {
+        const int64_t end = static_cast<int64_t>(start) + length;
+        cover(start);
+        cover(end - 1);
+
+        if (m_cellsPerColumn == 1) {
+            const QRgb color = symbolColor(symbols);
+            for (int64_t cell = start; cell < end; ++cell) {
+                m_line[columnOf(cell)] = Column{1, color};
+            }
+        } else {
+            for (int64_t cell = start; cell < end;) {
+                const int column = columnOf(cell);
+                const int64_t columnEnd = std::min(end, m_origin + (column + 1) * m_cellsPerColumn);
+                m_line[column].written += static_cast<uint32_t>(columnEnd - cell);
+                cell = columnEnd;
+            }
+        }
+        markUsed(columnOf(start));
+        markUsed(columnOf(end - 1));
+    });
+
+    const int64_t head = m_tape->getHeadPosition();
+    cover(head);
+    m_headFirst = m_headLast = columnOf(head);
+    markUsed(m_headFirst);
+}
+
+void SpaceTimeWidget::onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                             const Transition& transition)
+{
+    if (machine.getTape() != m_tape || !m_tape) return;
+
+    refreshLine();
+
+    const int64_t head = m_tape->getHeadPosition();
+    cover(position);
+    cover(head);
+
+    // The line changes by the one cell written
+    const std::string blank = m_tape->getBlankSymbolAsString();
+    const std::string writeSymbol = transition.getWriteSymbol();
+    const bool wasWritten = !readSymbol.empty() && readSymbol != blank;
+    const bool isWritten = !writeSymbol.empty() && writeSymbol != blank;
+    Column& column = m_line[columnOf(position)];
+    if (isWritten && !wasWritten) {
+        column.written++;
+    } else if (wasWritten && !isWritten) {
+        column.written--;
+    }
+    if (m_cellsPerColumn == 1) {
+        column.color = isWritten ? symbolColor(writeSymbol) : EmptyColor;
+    }
+    markUsed(columnOf(position));
+
+    const int headColumn = columnOf(head);
+    m_headFirst = std::min(m_headFirst, headColumn);
+    m_headLast = std::max(m_headLast, headColumn);
+    markUsed(headColumn);
+
+    if (++m_rowSteps >= m_stepsPerRow) {
+        if (m_rows == MaxRows) {
+            halveRows();
+        }
+        if (m_rowSteps >= m_stepsPerRow) {
+            writeRow(m_rows++);
+            m_rowSteps = 0;
+            m_headFirst = m_headLast = headColumn;
+        }
+    }
+
+    scheduleRepaint();
+}
+
+void SpaceTimeWidget::onJump(const TuringMachine& machine)
+{
+    if (machine.getTape() != m_tape) return;
+
+    // Stepping back keeps the rows up to that step, anything else starts over
+    const uint64_t step = machine.getStepCount();
+    const uint64_t recorded = m_firstStep + m_rows * m_stepsPerRow + m_rowSteps;
+    if (step <= m_firstStep || step > recorded) {
+        restart();
+        return;
+    }
+
+    m_rows = static_cast<int>((step - m_firstStep) / m_stepsPerRow);
+    m_rowSteps = (step - m_firstStep) % m_stepsPerRow;
+
+    // Many steps back in a row rebuild the line once
+    m_lineStale = true;
+    scheduleRepaint();
+}
+
+void SpaceTimeWidget::onReplaced(TuringMachine& replacement)
+{
+    m_machine = &replacement;
+}
+
+void SpaceTimeWidget::cover(int64_t cell)
+{
+    while (cell < m_origin) {
+        widen(true);
+    }
+    while (cell >= m_origin + Columns * m_cellsPerColumn) {
+        widen(false);
+    }
+}
+
+void SpaceTimeWidget::widen(bool toLeft)
+{
+    // Merge pairs of columns into the half of the image away from where the
+    // tape grows
+    const int shift = toLeft ? Columns / 2 : 0;
+    auto halve = [shift](auto* items, auto merge, auto empty) {
+        if (shift == 0) {
+            for (int i = 0; i < Columns / 2; ++i) {
+                items[i] = merge(items[2 * i], items[2 * i + 1]);
+            }
+        } else {
+            for (int i = Columns / 2 - 1; i >= 0; --i) {
+                items[shift + i] = merge(items[2 * i], items[2 * i + 1]);
+            }
+        }
+        std::fill(items + (Columns / 2 - shift), items + (Columns - shift), empty);
+    };
+
+    for (int row = 0; row < m_rows; ++row) {
+        halve(reinterpret_cast<QRgb*>(m_image.scanLine(row)), average, EmptyColor);
+    }
+    halve(m_line.data(), [](const Column& a, const Column& b) {
+        return Column{a.written + b.written, EmptyColor};
+    }, Column{0, EmptyColor});
+
+    m_cellsPerColumn *= 2;
+    if (toLeft) {
+        m_origin -= shift * m_cellsPerColumn;
+    }
+    m_usedFirst = m_usedFirst / 2 + shift;
+    m_usedLast = m_usedLast / 2 + shift;
+    m_headFirst = m_headFirst / 2 + shift;
+    m_headLast = m_headLast / 2 + shift;
+
+    // Keep a zoomed view on the same cells
+    m_offset.setX(m_offset.x() / 2 + shift);
+    m_scaleX *= 2;
+}
+
+void SpaceTimeWidget::halveRows()
+{
+    for (int row = 0; row < MaxRows / 2; ++row) {
+        const QRgb* first = reinterpret_cast<const QRgb*>(m_image.constScanLine(2 * row));
+        const QRgb* second = reinterpret_cast<const QRgb*>(m_image.constScanLine(2 * row + 1));
+        QRgb* merged = reinterpret_cast<QRgb*>(m_image.scanLine(row));
+        for (int column = 0; column < Columns; ++column) {
+            merged[column] = average(first[column], second[column]);
+        }
+    }
+
+    m_rows = MaxRows / 2;
+    m_stepsPerRow *= 2;
+
+    m_offset.setY(m_offset.y() / 2);
+    m_scaleY *= 2;
+}
+
+void SpaceTimeWidget::writeRow(int row)
+{
+    QRgb* pixels = reinterpret_cast<QRgb*>(m_image.scanLine(row));
+    for (int column = 0; column < Columns; ++column) {
+        pixels[column] = columnColor(m_line[column]);
+    }
+
+    // Where the head went during the row
+    for (int column = m_headFirst; column <= m_headLast; ++column) {
+        pixels[column] = average(pixels[column], HeadColor);
+    }
+}
+
+void SpaceTimeWidget::markUsed(int column)
+{
+    m_usedFirst = std::min(m_usedFirst, column);
+    m_usedLast = std::max(m_usedLast, column);
+}
+
+QRgb SpaceTimeWidget::symbolColor(const std::string& symbols)
+{
+    auto it = m_symbolColors.find(symbols);
+    if (it == m_symbolColors.end()) {
+        // Spread the symbols' hues around the circle
+        const int hue = static_cast<int>((std::hash<std::string>()(symbols) * 47) % 360);
+        it = m_symbolColors.emplace(symbols, QColor::fromHsv(hue, 170, 190).rgb()).first;
+    }
+    return it->second;
+}
+
+QRgb SpaceTimeWidget::columnColor(const Column& column) const
+{
+    if (column.written == 0) {
+        return EmptyColor;
+    }
+    if (m_cellsPerColumn == 1) {
+        return column.color;
+    }
+
+    // The square root keeps sparse columns visible
+    const double density = std::min(1.0, static_cast<double>(column.written) / m_cellsPerColumn);
+    return mix(EmptyColor, WrittenColor, std::sqrt(density));
+}
+
+void SpaceTimeWidget::zoomIn()
+{
+    zoomAt(QPointF(width() / 2.0, height() / 2.0), ZoomStep);
+}
+
+void SpaceTimeWidget::zoomOut()
+{
+    zoomAt(QPointF(width() / 2.0, height() / 2.0), 1.0 / ZoomStep);
+}
+
+void SpaceTimeWidget::fitToView()
+{
+    m_fit = true;
+    scheduleRepaint();
+}
+
+void SpaceTimeWidget::zoomAt(const QPointF& point, double factor)
+{
+    updateFit();
+    m_fit = false;
+
+    // Keep the image point under the cursor where it is
+    const QPointF anchor(m_offset.x() + point.x() / m_scaleX, m_offset.y() + point.y() / m_scaleY);
+    m_scaleX = std::clamp(m_scaleX * factor, MinScale, MaxScale);
+    m_scaleY = std::clamp(m_scaleY * factor, MinScale, MaxScale);
+    m_offset = QPointF(anchor.x() - point.x() / m_scaleX, anchor.y() - point.y() / m_scaleY);
+    update();
+}
+
+void SpaceTimeWidget::updateFit()
+{
+    if (!m_fit || width() <= 0 || height() <= 0) return;
+
+    // The used columns across the width, rows at most as high as a cell is wide
+    const int columns = m_usedLast - m_usedFirst + 1;
+    m_scaleX = std::min(MaxScale, static_cast<double>(width()) / columns);
+    m_scaleY = std::min(m_scaleX, static_cast<double>(height()) / (m_rows + 1));
+    m_offset = QPointF(m_usedFirst - (width() / m_scaleX - columns) / 2, 0.0);
+}
+
+void SpaceTimeWidget::scheduleRepaint()
+{
+    if (!m_repaintPending) {
+        m_repaintPending = true;
+        update();
+    }
+}
+
+void SpaceTimeWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    m_repaintPending = false;
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+    if (!m_tape) return;
+
+    // The row in progress shows the tape as it is now
+    refreshLine();
+    writeRow(m_rows);
+    updateFit();
+
+    const QRectF visible(m_offset, QSizeF(width() / m_scaleX, height() / m_scaleY));
+    const QRectF source = visible.intersected(QRectF(0, 0, Columns, m_rows + 1));
+    if (!source.isEmpty()) {
+        const QRectF target((source.x() - m_offset.x()) * m_scaleX, (source.y() - m_offset.y()) * m_scaleY,
+                            source.width() * m_scaleX, source.height() * m_scaleY);
+        painter.drawImage(target, m_image, source);
+    }
+
+    const uint64_t lastStep = m_firstStep + m_rows * m_stepsPerRow + m_rowSteps;
+    const QString info = tr("Steps %1 to %2, %3 per row, %4 cells per column")
+                             .arg(m_firstStep).arg(lastStep).arg(m_stepsPerRow).arg(m_cellsPerColumn);
+    const QRect infoRect = painter.fontMetrics().boundingRect(info).adjusted(-4, -2, 4, 2);
+    painter.fillRect(infoRect.translated(-infoRect.topLeft() + QPoint(4, 4)), QColor(255, 255, 255, 200));
+    painter.drawText(infoRect.translated(-infoRect.topLeft() + QPoint(4, 4)), Qt::AlignCenter, info);
+}
+
+void SpaceTimeWidget::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        updateFit();
+        m_dragStart = event->pos();
+        m_dragOffset = m_offset;
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void SpaceTimeWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    if (event->buttons() & Qt::LeftButton) {
+        const QPoint delta = event->pos() - m_dragStart;
+        m_fit = false;
+        m_offset = QPointF(m_dragOffset.x() - delta.x() / m_scaleX, m_dragOffset.y() - delta.y() / m_scaleY);
+        update();
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void SpaceTimeWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    fitToView();
+    QWidget::mouseDoubleClickEvent(event);
+}
+
+void SpaceTimeWidget::wheelEvent(QWheelEvent* event)
+{
+    zoomAt(event->position(), event->angleDelta().y() > 0 ? ZoomStep : 1.0 / ZoomStep);
+    event->accept();
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QImage>
+#include <QPointF>
+#include <QWidget>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../model/ExecutionObserver.h"
+
+class QPaintEvent;
+class QMouseEvent;
+class QWheelEvent;
+class Tape;
+
+/**
+ * Space-time diagram of a run: the tape from left to right, one row per
+ * step below the previous one. Rows are written straight into the scanlines
+ * of a fixed size image as the machine steps, from a line of column colours
+ * kept up to date one written cell at a time, so no snapshots of the tape
+ * are taken. Once the rows fill the image, pairs of rows are merged and
+ * each row covers twice the steps; once the tape outgrows the columns,
+ * pairs of columns are merged and each covers twice the cells.
+ */
+class SpaceTimeWidget : public QWidget, public ExecutionObserver
+{
+    Q_OBJECT
+
+public:
+    // Size of the diagram, about a screen's worth in each direction
+    static constexpr int Columns = 1024;
+    static constexpr int MaxRows = 2048;
+
+    explicit SpaceTimeWidget(QWidget* parent = nullptr);
+    ~SpaceTimeWidget() override;
+
+    void setTape(const Tape* tape);
+    void setMachine(TuringMachine* machine);
+
+    // ExecutionObserver
+    void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                const Transition& transition) override;
+    void onJump(const TuringMachine& machine) override;
+    void onReplaced(TuringMachine& replacement) override;
+
+public slots:
+    // Start over from the tape as it is now
+    void restart();
+
+    void zoomIn();
+    void zoomOut();
+    void fitToView();  // Show the whole diagram and keep showing it as it grows
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+
+private:
+    struct Column {
+        uint32_t written;  // Written cells
+        QRgb color;        // Of the symbol, while columns are single cells
+    };
+
+    const Tape* m_tape;
+    TuringMachine* m_machine;
+
+    // Rows recorded so far, plus one for the row in progress
+    QImage m_image;
+    int m_rows;
+
+    // The tape now, as the row in progress will show it
+    std::vector<Column> m_line;
+    bool m_lineStale;          // Rebuilt from the tape before it is used next
+    int64_t m_origin;          // First cell of column 0
+    int64_t m_cellsPerColumn;  // A power of two
+    int m_usedFirst;           // Columns written or visited by the head
+    int m_usedLast;
+
+    uint64_t m_firstStep;      // Step the first row starts after
+    uint64_t m_stepsPerRow;    // A power of two
+    uint64_t m_rowSteps;       // Steps in the row in progress
+    int m_headFirst;           // Columns the head visited during it
+    int m_headLast;
+
+    std::unordered_map<std::string, QRgb> m_symbolColors;
+
+    // View, in widget pixels per image pixel and the image point at the top left
+    bool m_fit;
+    double m_scaleX;
+    double m_scaleY;
+    QPointF m_offset;
+    QPoint m_dragStart;
+    QPointF m_dragOffset;
+    bool m_repaintPending;
+
+    void rebuildLine();
+    void refreshLine();
+    void cover(int64_t cell);
+    void widen(bool toLeft);
+    void halveRows();
+    void writeRow(int row);
+    int columnOf(int64_t cell) const { return static_cast<int>((cell - m_origin) / m_cellsPerColumn); }
+    void markUsed(int column);
+    QRgb symbolColor(const std::string& symbols);
+    QRgb columnColor(const Column& column) const;
+    void zoomAt(const QPointF& point, double factor);
+    void updateFit();
+    void scheduleRepaint();
+};
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "StateGraphItem.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const QColor EdgeColor(110, 110, 120);
+const QColor LabelColor(60, 60, 70);
+const QColor CurrentColor(255, 190, 80);
+
+// Levels of detail, device pixels per scene unit, from which each part is drawn
+constexpr qreal ArrowDetail = 0.4;       // Arrowheads, loops, accept rings and antialiasing
+constexpr qreal NodeLabelDetail = 0.6;
+constexpr qreal EdgeLabelDetail = 0.9;
+
+// Below this, edges are left out and nodes drawn as dots
+constexpr qreal MinEdgePixels = 2.0;
+constexpr qreal MinNodePixels = 2.0;
+
+// More edges than this in view and none is labelled, or has an arrowhead
+// and antialiasing
+constexpr size_t MaxEdgeLabels = 300;
+constexpr size_t MaxDetailedEdges = 5000;
+
+constexpr qreal ArrowLength = 9.0;
+constexpr qreal ArrowWidth = 4.0;
+constexpr qreal ReverseOffset = 5.0;  // Apart from the edge the other way
+constexpr qreal LoopRadius = 10.0;
+
+// Room around the nodes for loops, start markers and labels
+constexpr qreal Margin = 4 * StateGraphItem::NodeRadius;
+
+QColor nodeColor(StateType type)
+{
+    switch (type) {
+        case StateType::START:
+            return QColor(190, 235, 190);
+        case StateType::ACCEPT:
+            return QColor(150, 215, 150);
+        case StateType::REJECT:
+            return QColor(240, 170, 170);
+        default:
+            return QColor(205, 220, 250);
+    }
+}
+
+QRectF loopRect(const QPointF& pos)
+{
+    const QPointF center = pos - QPointF(0, StateGraphItem::NodeRadius + LoopRadius / 2);
+    return QRectF(center - QPointF(LoopRadius, LoopRadius), center + QPointF(LoopRadius, LoopRadius));
+}
+
+} // namespace
+
+StateGraphItem::StateGraphItem()
+    : m_current(-1), m_detail(1.0)
+{
+}
+
+void StateGraphItem::setGraph(std::vector<Node> nodes, std::vector<Edge> edges)
+{
+    prepareGeometryChange();
+    m_nodes = std::move(nodes);
+    m_edges = std::move(edges);
+    m_current = -1;
+    updateBounds();
+    update();
+}
+
+void StateGraphItem::setPositions(const std::vector<float>& positions)
+{
+    prepareGeometryChange();
+    const size_t count = std::min(m_nodes.size(), positions.size() / 2);
+    for (size_t i = 0; i < count; ++i) {
+        m_nodes[i].pos = QPointF(positions[2 * i], positions[2 * i + 1]);
+    }
+    updateBounds();
+    update();
+}
+
+void StateGraphItem::setNodePosition(int node, const QPointF& pos)
+{
+    if (node < 0 || node >= static_cast<int>(m_nodes.size())) return;
+
+    prepareGeometryChange();
+    m_nodes[node].pos = pos;
+    updateBounds();
+    update();
+}
+
+int StateGraphItem::nodeAt(const QPointF& pos) const
+{
+    // The last one drawn is on top
+    for (int i = static_cast<int>(m_nodes.size()) - 1; i >= 0; --i) {
+        const QPointF offset = m_nodes[i].pos - pos;
+        if (QPointF::dotProduct(offset, offset) <= NodeRadius * NodeRadius) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QRectF StateGraphItem::nodeRect(int node) const
+{
+    if (node < 0 || node >= static_cast<int>(m_nodes.size())) return QRectF();
+
+    // With its loop above, the start marker to the left and a few pixels
+    // more for pens and the highlight of a dot
+    const QPointF pos = m_nodes[node].pos;
+    const qreal pixels = 6 / m_detail;
+    return QRectF(pos.x() - 2 * NodeRadius, pos.y() - 2 * NodeRadius - LoopRadius,
+                  4 * NodeRadius, 3 * NodeRadius + LoopRadius).adjusted(-pixels, -pixels, pixels, pixels);
+}
+
+void StateGraphItem::setCurrentNode(int node)
+{
+    if (node == m_current) return;
+
+    update(nodeRect(m_current));
+    m_current = node;
+    update(nodeRect(m_current));
+}
+
+QRectF StateGraphItem::boundingRect() const
+{
+    return m_bounds;
+}
+
+void StateGraphItem::updateBounds()
+{
+    if (m_nodes.empty()) {
+        m_bounds = QRectF();
+        return;
+    }
+
+    qreal left = m_nodes[0].pos.x(), right = left;
+    qreal top = m_nodes[0].pos.y(), bottom = top;
+    for (const Node& node : m_nodes) {
+        left = std::min(left, node.pos.x());
+        right = std::max(right, node.pos.x());
+        top = std::min(top, node.pos.y());
+        bottom = std::max(bottom, node.pos.y());
+    }
+    m_bounds = QRectF(QPointF(left, top), QPointF(right, bottom)).adjusted(-Margin, -Margin, Margin, Margin);
+}
+
+void StateGraphItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(widget);
+
+    const qreal detail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    m_detail = detail;
+    painter->setRenderHint(QPainter::Antialiasing, detail >= ArrowDetail);
+    painter->setRenderHint(QPainter::TextAntialiasing, detail >= ArrowDetail);
+
+    paintEdges(painter, option->exposedRect, detail);
+    paintNodes(painter, option->exposedRect, detail);
+}
+
+void StateGraphItem::paintEdges(QPainter* painter, const QRectF& exposed, qreal detail) const
+{
+    const bool arrows = detail >= ArrowDetail;
+    const qreal minLength = MinEdgePixels / detail;
+    const QRectF area = exposed.adjusted(-NodeRadius, -NodeRadius, NodeRadius, NodeRadius);
+
+    std::vector<QLineF> lines;
+    std::vector<size_t> shown;  // Edges drawn, by index, for their labels
+    std::vector<QRectF> loops;
+
+    for (size_t i = 0; i < m_edges.size(); ++i) {
+        const Edge& edge = m_edges[i];
+        const QPointF from = m_nodes[edge.from].pos;
+        const QPointF to = m_nodes[edge.to].pos;
+
+        if (edge.from == edge.to) {
+            if (arrows && area.intersects(loopRect(from))) {
+                loops.push_back(loopRect(from));
+                shown.push_back(i);
+            }
+            continue;
+        }
+
+        // Left out when it misses the exposed area, or would be a few pixels long
+        if (std::max(from.x(), to.x()) < area.left() || std::min(from.x(), to.x()) > area.right() ||
+            std::max(from.y(), to.y()) < area.top() || std::min(from.y(), to.y()) > area.bottom()) {
+            continue;
+        }
+        const QPointF delta = to - from;
+        if (std::abs(delta.x()) + std::abs(delta.y()) < minLength) continue;
+
+        if (!arrows) {
+            lines.emplace_back(from, to);
+            continue;
+        }
+
+        // From rim to rim, beside the edge the other way if there is one
+        const qreal length = std::sqrt(QPointF::dotProduct(delta, delta));
+        if (length <= 2 * NodeRadius) continue;
+        const QPointF unit = delta / length;
+        const QPointF normal(-unit.y(), unit.x());
+        const QPointF offset = edge.hasReverse ? normal * ReverseOffset : QPointF();
+        const QPointF start = from + unit * NodeRadius + offset;
+        const QPointF end = to - unit * NodeRadius + offset;
+        lines.emplace_back(start, end);
+        shown.push_back(i);
+    }
+
+    const bool detailed = arrows && lines.size() <= MaxDetailedEdges;
+    painter->setRenderHint(QPainter::Antialiasing, detailed);
+
+    QPen pen(EdgeColor, 0);
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawLines(lines.data(), static_cast<int>(lines.size()));
+    for (const QRectF& loop : loops) {
+        painter->drawEllipse(loop);
+    }
+
+    if (detailed && !lines.empty()) {
+        QPainterPath heads;
+        for (const QLineF& line : lines) {
+            const QPointF end = line.p2();
+            const QPointF unit = (end - line.p1()) / line.length();
+            const QPointF normal(-unit.y(), unit.x());
+            const QPointF base = end - unit * ArrowLength;
+            heads.addPolygon(QPolygonF({end, base + normal * ArrowWidth, base - normal * ArrowWidth, end}));
+        }
+        painter->fillPath(heads, EdgeColor);
+    }
+    painter->setRenderHint(QPainter::Antialiasing, detail >= ArrowDetail);
+
+    if (detail < EdgeLabelDetail || shown.size() > MaxEdgeLabels) return;
+
+    painter->setPen(LabelColor);
+    for (size_t i : shown) {
+        const Edge& edge = m_edges[i];
+        const QString label = QString::fromStdString(edge.label);
+        QPointF anchor;
+        if (edge.from == edge.to) {
+            anchor = loopRect(m_nodes[edge.from].pos).center() - QPointF(0, LoopRadius);
+        } else {
+            const QPointF from = m_nodes[edge.from].pos;
+            const QPointF to = m_nodes[edge.to].pos;
+            anchor = (from + to) / 2;
+            if (edge.hasReverse) {
+                const QPointF delta = to - from;
+                const qreal length = std::sqrt(QPointF::dotProduct(delta, delta));
+                anchor += QPointF(-delta.y(), delta.x()) / length * (3 * ReverseOffset);
+            }
+        }
+
+        QRectF box = painter->fontMetrics().boundingRect(QRect(), Qt::AlignCenter, label);
+        if (edge.from == edge.to) {
+            box.moveBottom(anchor.y());
+            box.moveLeft(anchor.x() - box.width() / 2);
+        } else {
+            box.moveCenter(anchor);
+        }
+        painter->drawText(box, Qt::AlignCenter, label);
+    }
+}
+
+void StateGraphItem::paintNodes(QPainter* painter, const QRectF& exposed, qreal detail) const
+{
+    const QRectF area = exposed.adjusted(-2 * NodeRadius, -NodeRadius, NodeRadius, NodeRadius);
+
+    if (NodeRadius * detail < MinNodePixels) {
+        // Dots, one batch per type
+        std::vector<QPointF> dots[4];
+        for (const Node& node : m_nodes) {
+            if (area.contains(node.pos)) {
+                dots[static_cast<int>(node.type)].push_back(node.pos);
+            }
+        }
+        for (int type = 0; type < 4; ++type) {
+            QPen pen(nodeColor(static_cast<StateType>(type)).darker(130), 3);
+            pen.setCosmetic(true);
+            painter->setPen(pen);
+            painter->drawPoints(dots[type].data(), static_cast<int>(dots[type].size()));
+        }
+    } else {
+        const bool labels = detail >= NodeLabelDetail;
+        const bool rings = detail >= ArrowDetail;
+        const int labelWidth = static_cast<int>(2 * NodeRadius - 6);
+
+        painter->setPen(QPen(Qt::black, 0));
+        for (const Node& node : m_nodes) {
+            if (!area.contains(node.pos)) continue;
+
+            painter->setBrush(nodeColor(node.type));
+            painter->drawEllipse(node.pos, NodeRadius, NodeRadius);
+
+            if (rings && node.type == StateType::ACCEPT) {
+                painter->setBrush(Qt::NoBrush);
+                painter->drawEllipse(node.pos, NodeRadius - 4, NodeRadius - 4);
+            }
+            if (rings && node.type == StateType::START) {
+                const QPointF tip = node.pos - QPointF(NodeRadius, 0);
+                painter->drawLine(tip - QPointF(NodeRadius, 0), tip);
+                painter->drawLine(tip, tip - QPointF(ArrowLength / 2, ArrowWidth));
+                painter->drawLine(tip, tip - QPointF(ArrowLength / 2, -ArrowWidth));
+            }
+            if (labels) {
+                const QString text = painter->fontMetrics().elidedText(
+                    QString::fromStdString(node.id), Qt::ElideRight, labelWidth);
+                painter->drawText(QRectF(node.pos.x() - NodeRadius, node.pos.y() - NodeRadius,
+                                         2 * NodeRadius, 2 * NodeRadius), Qt::AlignCenter, text);
+            }
+        }
+    }
+
+    // The current state stands out at any size
+    if (m_current >= 0 && area.contains(m_nodes[m_current].pos)) {
+        const qreal radius = std::max(NodeRadius, 3 / detail);
+        QPen pen(CurrentColor.darker(150), 3);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->setBrush(CurrentColor);
+        painter->drawEllipse(m_nodes[m_current].pos, radius, radius);
+
+        if (detail >= NodeLabelDetail) {
+            painter->setPen(Qt::black);
+            const QString text = painter->fontMetrics().elidedText(
+                QString::fromStdString(m_nodes[m_current].id), Qt::ElideRight,
+                static_cast<int>(2 * NodeRadius - 6));
+            painter->drawText(QRectF(m_nodes[m_current].pos - QPointF(NodeRadius, NodeRadius),
+                                     QSizeF(2 * NodeRadius, 2 * NodeRadius)), Qt::AlignCenter, text);
+        }
+    }
+}
\ No newline at end of file
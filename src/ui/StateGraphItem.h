@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QGraphicsItem>
+#include <string>
+#include <vector>
+
+#include "../model/State.h"
+
+/**
+ * Paints a whole state graph as one item, so the scene holds no item per
+ * state or transition. Only nodes and edges crossing the exposed area are
+ * drawn, and detail is left out as the view zooms out: first labels, then
+ * arrowheads and loops, then edges shorter than a couple of pixels, until
+ * nodes are single dots.
+ */
+class StateGraphItem : public QGraphicsItem
+{
+public:
+    struct Node {
+        std::string id;
+        StateType type;
+        QPointF pos;
+    };
+
+    // All transitions from one state to another
+    struct Edge {
+        int from;
+        int to;
+        bool hasReverse;    // Drawn bent, apart from the edge the other way
+        std::string label;  // One line per transition
+    };
+
+    // Scene units, the layout spaces nodes a few of these apart
+    static constexpr qreal NodeRadius = 18.0;
+
+    StateGraphItem();
+
+    void setGraph(std::vector<Node> nodes, std::vector<Edge> edges);
+    const std::vector<Node>& nodes() const { return m_nodes; }
+    const std::vector<Edge>& edges() const { return m_edges; }
+
+    // Positions as x, y pairs in node order
+    void setPositions(const std::vector<float>& positions);
+    void setNodePosition(int node, const QPointF& pos);
+
+    // The node under a scene position, -1 if none
+    int nodeAt(const QPointF& pos) const;
+    QRectF nodeRect(int node) const;
+
+    // Highlighted as the machine's current state, -1 for none
+    int currentNode() const { return m_current; }
+    void setCurrentNode(int node);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<Edge> m_edges;
+    QRectF m_bounds;
+    int m_current;
+    qreal m_detail;  // Of the last paint, for the area a node covers
+
+    void updateBounds();
+    void paintEdges(QPainter* painter, const QRectF& exposed, qreal detail) const;
+    void paintNodes(QPainter* painter, const QRectF& exposed, qreal detail) const;
+};
\ No newline at end of file
@@ -0,0 +1,487 @@
+#include "StateGraphWidget.h"
+
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QMouseEvent>
+#include <QThread>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "GraphLayout.h"
+#include "StateGraphItem.h"
+#include "../model/TuringMachine.h"
+
+namespace {
+
+// Scene units between states joined by a transition, once laid out
+constexpr float EdgeLength = 6 * StateGraphItem::NodeRadius;
+
+// How often the layout shows its progress, and the frames picking it up
+constexpr int PublishInterval = 30;  // ms
+constexpr int FrameInterval = 30;    // ms
+
+// Lines of an edge label, after which the rest are counted
+constexpr int MaxLabelLines = 4;
+
+// Device pixels per scene unit, as far as zooming goes either way
+constexpr double MinScale = 1.0 / 256;
+constexpr double MaxScale = 8.0;
+
+constexpr double ZoomStep = 1.25;
+
+constexpr float GoldenAngle = 2.39996323f;
+
+} // namespace
+
+StateGraphWidget::StateGraphWidget(QWidget* parent)
+    : QGraphicsView(parent), m_machine(nullptr), m_item(new StateGraphItem()),
+      m_currentStale(false), m_fit(true), m_dragNode(-1),
+      m_layoutThread(nullptr), m_stopLayout(false), m_layoutIteration(0), m_layoutPublished(false)
+{
+    // A single item, nothing for the scene to index
+    QGraphicsScene* scene = new QGraphicsScene(this);
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    scene->addItem(m_item);
+    setScene(scene);
+
+    setDragMode(QGraphicsView::ScrollHandDrag);
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
+    setOptimizationFlags(QGraphicsView::DontSavePainterState);
+    setBackgroundBrush(QColor(250, 250, 250));
+    setMinimumSize(200, 150);
+    setToolTip(tr("Drag to pan, wheel to zoom, drag a state to move it, double-click to fit"));
+
+    m_frameTimer.setInterval(FrameInterval);
+    connect(&m_frameTimer, &QTimer::timeout, this, &StateGraphWidget::onFrame);
+}
+
+StateGraphWidget::~StateGraphWidget()
+{
+    if (m_layoutThread) {
+        m_stopLayout = true;
+        m_layoutThread->wait();
+        delete m_layoutThread;
+    }
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+}
+
+void StateGraphWidget::setMachine(TuringMachine* machine)
+{
+    if (machine != m_machine) {
+        if (m_machine) {
+            m_machine->removeObserver(this);
+        }
+        m_machine = machine;
+        if (m_machine) {
+            m_machine->addObserver(this);
+        }
+    }
+    rebuild();
+}
+
+void StateGraphWidget::onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                              const Transition& transition)
+{
+    Q_UNUSED(machine);
+    Q_UNUSED(position);
+    Q_UNUSED(readSymbol);
+    Q_UNUSED(transition);
+
+    // Looked up once per frame rather than on every step
+    m_currentStale = true;
+}
+
+void StateGraphWidget::onJump(const TuringMachine& machine)
+{
+    Q_UNUSED(machine);
+    m_currentStale = true;
+}
+
+void StateGraphWidget::onReplaced(TuringMachine& replacement)
+{
+    // The graph is rebuilt once the new code is shown
+    m_machine = &replacement;
+    m_currentStale = true;
+}
+
+void StateGraphWidget::rebuild()
+{
+    // Positions stay with states that are still there, by id
+    stopLayout();
+    std::unordered_map<std::string, QPointF> previous;
+    previous.reserve(m_item->nodes().size());
+    for (const StateGraphItem::Node& node : m_item->nodes()) {
+        previous.emplace(node.id, node.pos);
+    }
+
+    std::vector<StateGraphItem::Node> nodes;
+    std::vector<bool> placed;
+    m_nodeIndex.clear();
+
+    if (m_machine) {
+        emit aboutToStorePositions();
+        nodes.reserve(m_machine->getStateCount());
+        m_nodeIndex.reserve(m_machine->getStateCount());
+        m_machine->forEachState([&](State* state) {
+            StateGraphItem::Node node{state->getId(), state->getType(), QPointF()};
+            const Point2D pos = state->getPosition();
+            bool hasPosition = pos.x() != 0.0f || pos.y() != 0.0f;
+            if (hasPosition) {
+                node.pos = QPointF(pos.x(), pos.y());
+            } else {
+                auto it = previous.find(node.id);
+                if (it != previous.end()) {
+                    // A recompiled machine has new states
+                    node.pos = it->second;
+                    state->setPosition(Point2D(node.pos.x(), node.pos.y()));
+                    hasPosition = true;
+                }
+            }
+            m_nodeIndex.emplace(node.id, static_cast<int>(nodes.size()));
+            nodes.push_back(std::move(node));
+            placed.push_back(hasPosition);
+        });
+    }
+
+    // One edge per pair of states, labelled with all its transitions
+    std::vector<StateGraphItem::Edge> edges;
+    std::vector<int> labelLines;
+    std::unordered_map<uint64_t, int> edgeIndex;
+    auto keyOf = [](int from, int to) {
+        return (static_cast<uint64_t>(from) << 32) | static_cast<uint32_t>(to);
+    };
+
+    if (m_machine) {
+        edgeIndex.reserve(m_machine->getTransitionCount());
+        m_machine->forEachTransition([&](Transition* transition) {
+            auto from = m_nodeIndex.find(transition->getFromState());
+            auto to = m_nodeIndex.find(transition->getToState());
+            if (from == m_nodeIndex.end() || to == m_nodeIndex.end()) return;
+
+            auto inserted = edgeIndex.emplace(keyOf(from->second, to->second), static_cast<int>(edges.size()));
+            if (inserted.second) {
+                edges.push_back(StateGraphItem::Edge{from->second, to->second, false, std::string()});
+                labelLines.push_back(0);
+            }
+
+            const int edge = inserted.first->second;
+            if (++labelLines[edge] <= MaxLabelLines) {
+                std::string& label = edges[edge].label;
+                if (!label.empty()) label += '\n';
+                label += transition->getDisplayText();
+            }
+        });
+    }
+
+    m_layoutEdges.clear();
+    m_layoutEdges.reserve(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        StateGraphItem::Edge& edge = edges[i];
+        edge.hasReverse = edge.from != edge.to && edgeIndex.count(keyOf(edge.to, edge.from)) > 0;
+        if (labelLines[i] > MaxLabelLines) {
+            edge.label += '\n' + tr("(%1 more)").arg(labelLines[i] - MaxLabelLines).toStdString();
+        }
+        if (edge.from != edge.to) {
+            m_layoutEdges.emplace_back(edge.from, edge.to);
+        }
+    }
+
+    // States without a position start on a spiral around those with one,
+    // from where the layout takes them
+    QPointF center;
+    int placedCount = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (placed[i]) {
+            center += nodes[i].pos;
+            ++placedCount;
+        }
+    }
+    if (placedCount > 0) {
+        center /= placedCount;
+    }
+
+    int unplaced = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!placed[i]) {
+            const int turn = placedCount + unplaced++;
+            const float radius = EdgeLength * std::sqrt(static_cast<float>(turn));
+            nodes[i].pos = center + QPointF(radius * std::cos(GoldenAngle * turn),
+                                            radius * std::sin(GoldenAngle * turn));
+        }
+    }
+
+    m_item->setGraph(std::move(nodes), std::move(edges));
+    updateSceneRect();
+    updateCurrentState();
+    fitToView();
+
+    if (unplaced > 0) {
+        startLayout(placed);
+    }
+}
+
+void StateGraphWidget::relayout()
+{
+    stopLayout();
+    startLayout(std::vector<bool>(m_item->nodes().size(), false));
+    fitToView();
+}
+
+void StateGraphWidget::startLayout(const std::vector<bool>& pinned)
+{
+    const std::vector<StateGraphItem::Node>& nodes = m_item->nodes();
+    if (nodes.empty()) return;
+
+    std::vector<float> positions;
+    positions.reserve(2 * nodes.size());
+    for (const StateGraphItem::Node& node : nodes) {
+        positions.push_back(static_cast<float>(node.pos.x()));
+        positions.push_back(static_cast<float>(node.pos.y()));
+    }
+
+    // Owned by the worker from here on
+    auto layout = std::make_shared<GraphLayout>(std::move(positions), m_layoutEdges, EdgeLength);
+    for (size_t i = 0; i < pinned.size(); ++i) {
+        layout->setPinned(static_cast<int>(i), pinned[i]);
+    }
+
+    m_stopLayout = false;
+    m_layoutPublished = false;
+    QThread* thread = QThread::create([this, layout]() {
+        QElapsedTimer sincePublished;
+        sincePublished.start();
+        while (!m_stopLayout && layout->step()) {
+            if (sincePublished.elapsed() >= PublishInterval) {
+                publishLayout(*layout);
+                sincePublished.restart();
+            }
+        }
+        publishLayout(*layout);
+    });
+    m_layoutThread = thread;
+
+    // A layout stopped by stopLayout() has already been finished
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        if (thread == m_layoutThread) {
+            finishLayout();
+        }
+    });
+
+    thread->start(QThread::LowPriority);
+    emit layoutStarted();
+}
+
+void StateGraphWidget::stopLayout()
+{
+    if (!m_layoutThread) return;
+
+    m_stopLayout = true;
+    m_layoutThread->wait();
+    finishLayout();
+}
+
+void StateGraphWidget::publishLayout(const GraphLayout& layout)
+{
+    std::lock_guard<std::mutex> lock(m_layoutMutex);
+    m_layoutPositions = layout.getPositions();
+    m_layoutIteration = layout.getIteration();
+    m_layoutPublished = true;
+}
+
+bool StateGraphWidget::takeLayoutPositions()
+{
+    std::vector<float> positions;
+    {
+        std::lock_guard<std::mutex> lock(m_layoutMutex);
+        if (!m_layoutPublished) return false;
+        m_layoutPublished = false;
+        positions.swap(m_layoutPositions);
+    }
+
+    m_item->setPositions(positions);
+    updateSceneRect();
+    if (m_fit) {
+        fitInView(m_item->boundingRect(), Qt::KeepAspectRatio);
+    }
+    return true;
+}
+
+void StateGraphWidget::finishLayout()
+{
+    m_layoutThread->deleteLater();
+    m_layoutThread = nullptr;
+
+    takeLayoutPositions();
+    storePositions();
+    emit layoutFinished();
+}
+
+void StateGraphWidget::storePositions()
+{
+    emit aboutToStorePositions();
+    bool changed = false;
+    for (size_t i = 0; i < m_item->nodes().size(); ++i) {
+        changed |= storePosition(static_cast<int>(i));
+    }
+    if (changed) {
+        emit positionsChanged();
+    }
+}
+
+bool StateGraphWidget::storePosition(int node)
+{
+    if (!m_machine) return false;
+
+    const StateGraphItem::Node& item = m_item->nodes()[node];
+    State* state = m_machine->getState(item.id);
+    if (!state) return false;
+
+    const Point2D position(static_cast<float>(item.pos.x()), static_cast<float>(item.pos.y()));
+    if (state->getPosition().x() == position.x() && state->getPosition().y() == position.y()) {
+        return false;
+    }
+    state->setPosition(position);
+    return true;
+}
+
+void StateGraphWidget::updateSceneRect()
+{
+    scene()->setSceneRect(m_item->boundingRect());
+}
+
+void StateGraphWidget::onFrame()
+{
+    if (m_layoutThread && takeLayoutPositions()) {
+        int iteration;
+        {
+            std::lock_guard<std::mutex> lock(m_layoutMutex);
+            iteration = m_layoutIteration;
+        }
+        emit layoutProgress(iteration);
+    }
+
+    if (m_currentStale) {
+        m_currentStale = false;
+        updateCurrentState();
+    }
+}
+
+void StateGraphWidget::updateCurrentState()
+{
+    int node = -1;
+    if (m_machine) {
+        auto it = m_nodeIndex.find(m_machine->getCurrentState());
+        if (it != m_nodeIndex.end()) {
+            node = it->second;
+        }
+    }
+    m_item->setCurrentNode(node);
+}
+
+void StateGraphWidget::zoomIn()
+{
+    zoomBy(ZoomStep);
+}
+
+void StateGraphWidget::zoomOut()
+{
+    zoomBy(1.0 / ZoomStep);
+}
+
+void StateGraphWidget::zoomBy(double factor)
+{
+    const double current = transform().m11();
+    const double target = std::clamp(current * factor, MinScale, MaxScale);
+    m_fit = false;
+    scale(target / current, target / current);
+}
+
+void StateGraphWidget::fitToView()
+{
+    m_fit = true;
+    if (!m_item->nodes().empty()) {
+        fitInView(m_item->boundingRect(), Qt::KeepAspectRatio);
+    }
+}
+
+void StateGraphWidget::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        const int node = m_item->nodeAt(mapToScene(event->pos()));
+        if (node >= 0) {
+            // The layout would move it back
+            stopLayout();
+            m_dragNode = node;
+            event->accept();
+            return;
+        }
+        m_fit = false;
+    }
+    QGraphicsView::mousePressEvent(event);
+}
+
+void StateGraphWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    if (m_dragNode >= 0) {
+        m_item->setNodePosition(m_dragNode, mapToScene(event->pos()));
+        event->accept();
+        return;
+    }
+    QGraphicsView::mouseMoveEvent(event);
+}
+
+void StateGraphWidget::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (m_dragNode >= 0 && event->button() == Qt::LeftButton) {
+        emit aboutToStorePositions();
+        if (storePosition(m_dragNode)) {
+            emit positionsChanged();
+        }
+        m_dragNode = -1;
+        updateSceneRect();
+        event->accept();
+        return;
+    }
+    QGraphicsView::mouseReleaseEvent(event);
+}
+
+void StateGraphWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    Q_UNUSED(event);
+    fitToView();
+}
+
+void StateGraphWidget::wheelEvent(QWheelEvent* event)
+{
+    const int delta = event->angleDelta().y();
+    if (delta != 0) {
+        zoomBy(std::pow(ZoomStep, delta / 120.0));
+    }
+    event->accept();
+}
+
+void StateGraphWidget::resizeEvent(QResizeEvent* event)
+{
+    QGraphicsView::resizeEvent(event);
+    if (m_fit) {
+        fitToView();
+    }
+}
+
+void StateGraphWidget::showEvent(QShowEvent* event)
+{
+    QGraphicsView::showEvent(event);
+    m_frameTimer.start();
+    onFrame();
+}
+
+void StateGraphWidget::hideEvent(QHideEvent* event)
+{
+    QGraphicsView::hideEvent(event);
+    m_frameTimer.stop();
+}
\ No newline at end of file
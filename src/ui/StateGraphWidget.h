@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QGraphicsView>
+#include <QTimer>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../model/ExecutionObserver.h"
+
+class GraphLayout;
+class QThread;
+class StateGraphItem;
+
+/**
+ * The states of a machine as a graph, with one edge for all transitions
+ * from one state to another and the current state highlighted. States are
+ * laid out by GraphLayout on a worker thread while the view follows it
+ * settle; the positions it ends with are stored in the states, which keep
+ * them when the graph is built again. States that have a position are
+ * pinned there while the ones added since are placed around them.
+ *
+ * Drag to pan, wheel to zoom, drag a state to move it, which stops a
+ * layout that is running.
+ */
+class StateGraphWidget : public QGraphicsView, public ExecutionObserver
+{
+    Q_OBJECT
+
+public:
+    explicit StateGraphWidget(QWidget* parent = nullptr);
+    ~StateGraphWidget() override;
+
+    void setMachine(TuringMachine* machine);
+
+    bool isLayoutRunning() const { return m_layoutThread != nullptr; }
+
+    // ExecutionObserver
+    void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                const Transition& transition) override;
+    void onJump(const TuringMachine& machine) override;
+    void onReplaced(TuringMachine& replacement) override;
+
+public slots:
+    // Read the machine's states and transitions again
+    void rebuild();
+
+    // Lay out all states again, starting from where they are
+    void relayout();
+    void stopLayout();
+
+    void zoomIn();
+    void zoomOut();
+    void fitToView();  // Show the whole graph and keep showing it while it is laid out
+
+signals:
+    void layoutStarted();
+    void layoutProgress(int iteration);
+    void layoutFinished();
+    void aboutToStorePositions();  // Before positions are written to the machine's states
+    void positionsChanged();       // After a layout or a drag moved any of them
+
+protected:
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    TuringMachine* m_machine;
+    StateGraphItem* m_item;
+    std::unordered_map<std::string, int> m_nodeIndex;  // By state id
+    std::vector<std::pair<int, int>> m_layoutEdges;    // Between different nodes
+
+    // Picks up layout progress and the current state once per frame
+    QTimer m_frameTimer;
+    bool m_currentStale;
+
+    bool m_fit;
+    int m_dragNode;
+
+    // Layout worker and the positions it publishes
+    QThread* m_layoutThread;
+    std::atomic<bool> m_stopLayout;
+    std::mutex m_layoutMutex;
+    std::vector<float> m_layoutPositions;
+    int m_layoutIteration;
+    bool m_layoutPublished;
+
+    void startLayout(const std::vector<bool>& pinned);
+    void publishLayout(const GraphLayout& layout);
+    bool takeLayoutPositions();
+    void finishLayout();
+    void storePositions();
+    bool storePosition(int node);  // False if the state was already there
+
+    void updateSceneRect();
+    void onFrame();
+    void updateCurrentState();
+    void zoomBy(double factor);
+};
\ No newline at end of file
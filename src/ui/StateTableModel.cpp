@@ -0,0 +1,199 @@
+#include "StateTableModel.h"
+
+#include <QColor>
+#include <QIcon>
+
+#include "../model/TuringMachine.h"
+
+StateTableModel::StateTableModel(TuringMachine* machine, QObject* parent)
+    : MachineTableModel<State>(parent), m_machine(machine)
+{
+    refresh();
+}
+
+void StateTableModel::setMachine(TuringMachine* machine)
+{
+    m_machine = machine;
+    refresh();
+}
+
+void StateTableModel::addState(const std::string& id, const std::string& name, StateType type)
+{
+    if (!m_machine || m_machine->getState(id)) return;
+
+    if (type == StateType::START) {
+        demoteStartState(nullptr);
+    }
+
+    m_machine->addState(id, name, type);
+    if (type == StateType::START) {
+        m_machine->setStartState(id);
+    }
+    insertRowFor(m_machine->getState(id));
+}
+
+void StateTableModel::updateState(State* state, const std::string& name, StateType type)
+{
+    if (!m_machine || !state) return;
+
+    if (type == StateType::START) {
+        demoteStartState(state);
+    }
+
+    editItem(state, [&]() {
+        state->setName(name);
+        if (type != state->getType()) {
+            state->setType(type);
+            if (type == StateType::START) {
+                m_machine->setStartState(state->getId());
+            }
+        }
+    });
+}
+
+void StateTableModel::removeState(State* state)
+{
+    if (!m_machine || !state) return;
+
+    removeRowAt(rowOf(state));
+    m_machine->removeState(state->getId());
+}
+
+void StateTableModel::setCurrentState(const std::string& stateId)
+{
+    if (stateId == m_currentState) return;
+
+    const std::string previous = m_currentState;
+    m_currentState = stateId;
+    updateRow(previous);
+    updateRow(m_currentState);
+}
+
+int StateTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant StateTableModel::data(const QModelIndex& index, int role) const
+{
+    const State* state = itemAt(index.row());
+    if (!state) {
+        return QVariant();
+    }
+
+    if (role == Qt::BackgroundRole) {
+        return state->getId() == m_currentState ? QVariant(QColor(255, 235, 185)) : QVariant();
+    }
+
+    if (role == Qt::DecorationRole && index.column() == IdColumn) {
+        switch (state->getType()) {
+            case StateType::START:
+                return QIcon::fromTheme("media-playback-start");
+            case StateType::ACCEPT:
+                return QIcon::fromTheme("dialog-ok");
+            case StateType::REJECT:
+                return QIcon::fromTheme("dialog-cancel");
+            default:
+                return QVariant();
+        }
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case IdColumn:
+            return QString::fromStdString(state->getId());
+        case NameColumn:
+            return QString::fromStdString(state->getName());
+        case TypeColumn:
+            return typeText(state->getType());
+        default:
+            return QVariant();
+    }
+}
+
+QVariant StateTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+        case IdColumn:
+            return tr("State");
+        case NameColumn:
+            return tr("Name");
+        case TypeColumn:
+            return tr("Type");
+        default:
+            return QVariant();
+    }
+}
+
+void StateTableModel::collect(std::vector<State*>& items) const
+{
+    if (!m_machine) return;
+
+    items.reserve(m_machine->getStateCount());
+    m_machine->forEachState([&items](State* state) {
+        items.push_back(state);
+    });
+}
+
+int StateTableModel::compare(const State* a, const State* b, int column) const
+{
+    switch (column) {
+        case NameColumn:
+            return a->getName().compare(b->getName());
+        case TypeColumn:
+            return static_cast<int>(a->getType()) - static_cast<int>(b->getType());
+        default:
+            return 0;  // The key is the id
+    }
+}
+
+int StateTableModel::compareKeys(const State* a, const State* b) const
+{
+    return a->getId().compare(b->getId());
+}
+
+bool StateTableModel::matches(const State* state) const
+{
+    return contains(state->getId()) || contains(state->getName()) ||
+           contains(typeText(state->getType()).toStdString());
+}
+
+void StateTableModel::demoteStartState(const State* newStart)
+{
+    // There is one start state; the machine makes the old one a normal state
+    State* start = m_machine->getState(m_machine->getStartState());
+    if (start && start != newStart) {
+        editItem(start, [start]() {
+            start->setType(StateType::NORMAL);
+        });
+    }
+}
+
+void StateTableModel::updateRow(const std::string& stateId)
+{
+    const int row = stateId.empty() || !m_machine ? -1 : rowOf(m_machine->getState(stateId));
+    if (row >= 0) {
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1), {Qt::BackgroundRole});
+    }
+}
+
+QString StateTableModel::typeText(StateType type)
+{
+    switch (type) {
+        case StateType::START:
+            return tr("Start");
+        case StateType::ACCEPT:
+            return tr("Accept");
+        case StateType::REJECT:
+            return tr("Reject");
+        default:
+            return tr("Normal");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "MachineTableModel.h"
+#include "../model/State.h"
+
+class TuringMachine;
+
+/**
+ * States of a machine as a table, see MachineTableModel. The state the
+ * machine is in can be highlighted.
+ */
+class StateTableModel : public MachineTableModel<State>
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn,
+        NameColumn,
+        TypeColumn,
+        ColumnCount
+    };
+
+    explicit StateTableModel(TuringMachine* machine, QObject* parent = nullptr);
+
+    void setMachine(TuringMachine* machine);
+
+    // Edits made on the machine, one row at a time. Making a state the start
+    // state also updates the row of the one that was.
+    void addState(const std::string& id, const std::string& name, StateType type);
+    void updateState(State* state, const std::string& name, StateType type);
+    void removeState(State* state);
+
+    void setCurrentState(const std::string& stateId);
+
+    // QAbstractTableModel
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    void collect(std::vector<State*>& items) const override;
+    int compare(const State* a, const State* b, int column) const override;
+    int compareKeys(const State* a, const State* b) const override;
+    bool matches(const State* state) const override;
+
+private:
+    TuringMachine* m_machine;
+    std::string m_currentState;
+
+    void demoteStartState(const State* newStart);
+    void updateRow(const std::string& stateId);
+    static QString typeText(StateType type);
+};
\ No newline at end of file
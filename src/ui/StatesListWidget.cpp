@@ -1,63 +1,35 @@
 #include "StatesListWidget.h"
 
 // Qt includes
-#include <QListWidget>
+#include <QTableView>
+#include <QHeaderView>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
-#include <QIcon>
 #include <QMessageBox>
 
 // Project includes
 #include "../model/TuringMachine.h"
 #include "StateDialog.h"
+#include "StateTableModel.h"
 
 StatesListWidget::StatesListWidget(TuringMachine* machine, QWidget *parent)
     : QWidget(parent), machine(machine)
 {
     setupUI();
-    refreshStatesList();
 }
 
 void StatesListWidget::setMachine(TuringMachine* newMachine)
 {
     machine = newMachine;
-    refreshStatesList();
+    statesModel->setMachine(machine);
+    updateButtons();
 }
 
 void StatesListWidget::refreshStatesList()
 {
-    statesList->clear();
-
-    if (!machine) {
-        return;
-    }
-
-    auto states = machine->getAllStates();
-    for (auto state : states) {
-        QString displayText = QString::fromStdString(state->getId());
-        if (!state->getName().empty()) {
-            displayText += " (" + QString::fromStdString(state->getName()) + ")";
-        }
-
-        QListWidgetItem* item = new QListWidgetItem(displayText, statesList);
-        item->setData(Qt::UserRole, QString::fromStdString(state->getId()));
-
-        switch (state->getType()) {
-            case StateType::START:
-                item->setIcon(QIcon::fromTheme("media-playback-start"));
-                break;
-            case StateType::ACCEPT:
-                item->setIcon(QIcon::fromTheme("dialog-ok"));
-                break;
-            case StateType::REJECT:
-                item->setIcon(QIcon::fromTheme("dialog-cancel"));
-                break;
-            default:
-                break;
-        }
-    }
-
+    statesModel->refresh();
     updateButtons();
 }
 
@@ -79,15 +51,11 @@ void StatesListWidget::addState()
             return;
         }
 
-        machine->addState(stateId,
-                          dialog.getStateName().toStdString(),
-                          dialog.getStateType());
+        emit aboutToEdit();
+        statesModel->addState(stateId,
+                              dialog.getStateName().toStdString(),
+                              dialog.getStateType());
 
-        if (dialog.getStateType() == StateType::START) {
-            machine->setStartState(stateId);
-        }
-
-        refreshStatesList();
         emit stateAdded(stateId);
     }
 }
@@ -96,10 +64,29 @@ void StatesListWidget::setupUI()
 {
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
-    statesList = new QListWidget(this);
-    connect(statesList, &QListWidget::itemSelectionChanged, this, &StatesListWidget::updateButtons);
-    connect(statesList, &QListWidget::itemDoubleClicked, this, &StatesListWidget::editState);
-    mainLayout->addWidget(statesList);
+    filterEdit = new QLineEdit(this);
+    filterEdit->setPlaceholderText(tr("Filter"));
+    filterEdit->setClearButtonEnabled(true);
+    mainLayout->addWidget(filterEdit);
+
+    // Rows come from the model as they scroll into view, all the same height
+    statesModel = new StateTableModel(machine, this);
+    statesTable = new QTableView(this);
+    statesTable->setModel(statesModel);
+
+    statesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    statesTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    statesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    statesTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    statesTable->verticalHeader()->hide();
+    statesTable->horizontalHeader()->setSortIndicator(StateTableModel::IdColumn, Qt::AscendingOrder);
+    statesTable->setSortingEnabled(true);
+
+    connect(filterEdit, &QLineEdit::textChanged, statesModel, &StateTableModel::setFilterText);
+    connect(statesModel, &QAbstractItemModel::modelReset, this, &StatesListWidget::updateButtons);
+    connect(statesTable, &QTableView::doubleClicked, this, &StatesListWidget::editState);
+    mainLayout->addWidget(statesTable);
 
     QHBoxLayout* buttonsLayout = new QHBoxLayout();
 
@@ -119,42 +106,33 @@ void StatesListWidget::setupUI()
 
     updateButtons();
 
-    connect(statesList, &QListWidget::itemSelectionChanged, this, &StatesListWidget::onStateSelectionChanged);
+    connect(statesTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+        this, &StatesListWidget::updateButtons);
+    connect(statesTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+        this, &StatesListWidget::onStateSelectionChanged);
 }
 
 void StatesListWidget::editState()
 {
-    QListWidgetItem* item = statesList->currentItem();
-    if (!item) return;
-
-    std::string stateId = item->data(Qt::UserRole).toString().toStdString();
-    State* state = machine->getState(stateId);
+    State* state = getSelectedState();
     if (!state) return;
 
+    std::string stateId = state->getId();
+
     StateDialog dialog(this, state);
     if (dialog.exec() == QDialog::Accepted) {
-        state->setName(dialog.getStateName().toStdString());
-
-        StateType newType = dialog.getStateType();
-        if (newType != state->getType()) {
-            state->setType(newType);
-
-            if (newType == StateType::START) {
-                machine->setStartState(stateId);
-            }
-        }
-
-        refreshStatesList();
+        emit aboutToEdit();
+        statesModel->updateState(state, dialog.getStateName().toStdString(), dialog.getStateType());
         emit stateEdited(stateId);
     }
 }
 
 void StatesListWidget::removeState()
 {
-    QListWidgetItem* item = statesList->currentItem();
-    if (!item) return;
+    State* state = getSelectedState();
+    if (!state) return;
 
-    std::string stateId = item->data(Qt::UserRole).toString().toStdString();
+    std::string stateId = state->getId();
 
     QMessageBox::StandardButton reply = QMessageBox::question(this, tr("Confirm Deletion"),
         tr("Are you sure you want to delete state '%1'?\nThis will also remove all transitions involving this state.")
@@ -162,40 +140,42 @@ void StatesListWidget::removeState()
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        std::string removedId = stateId;
-        machine->removeState(stateId);
-
-        refreshStatesList();
-        emit stateRemoved(removedId);
+        // Transitions of the state go with it, tables of them need a refresh
+        emit aboutToEdit();
+        statesModel->removeState(state);
+        emit stateRemoved(stateId);
     }
 }
 
 void StatesListWidget::updateButtons()
 {
-    bool hasSelection = statesList->currentItem() != nullptr;
+    bool hasSelection = getSelectedState() != nullptr;
     editButton->setEnabled(hasSelection);
     removeButton->setEnabled(hasSelection);
 }
 
 void StatesListWidget::highlightCurrentState(const std::string& currentStateId)
 {
-    for (int i = 0; i < statesList->count(); ++i) {
-        QListWidgetItem* item = statesList->item(i);
-        QString stateId = item->data(Qt::UserRole).toString();
-        if (stateId.toStdString() == currentStateId) {
-            statesList->setCurrentItem(item);
-            item->setBackground(QColor(255, 235, 185));
-        } else {
-            item->setBackground(Qt::transparent);
-        }
+    statesModel->setCurrentState(currentStateId);
+
+    const int row = statesModel->rowOf(machine ? machine->getState(currentStateId) : nullptr);
+    if (row >= 0) {
+        statesTable->selectRow(row);
     }
 }
 
 void StatesListWidget::onStateSelectionChanged()
 {
-    QListWidgetItem* item = statesList->currentItem();
-    if (item) {
-        std::string stateId = item->data(Qt::UserRole).toString().toStdString();
-        emit stateSelected(stateId);
+    State* state = getSelectedState();
+    if (state) {
+        emit stateSelected(state->getId());
     }
+}
+
+State* StatesListWidget::getSelectedState()
+{
+    QModelIndexList selection = statesTable->selectionModel()->selectedRows();
+    if (selection.isEmpty()) return nullptr;
+
+    return statesModel->itemAt(selection.first().row());
 }
\ No newline at end of file
@@ -4,11 +4,12 @@
 #include <string>
 
 // Forward declarations
-class QListWidget;
-class QListWidgetItem;
+class QTableView;
+class QLineEdit;
 class QPushButton;
-class QVBoxLayout;
 class TuringMachine;
+class State;
+class StateTableModel;
 
 class StatesListWidget : public QWidget
 {
@@ -26,6 +27,7 @@ public:
     void stateEdited(const std::string& stateId);
     void stateRemoved(const std::string& stateId);
     void stateSelected(const std::string& stateId);
+    void aboutToEdit();  // Before any change is made to the machine
 
     private slots:
         void addState();
@@ -37,10 +39,13 @@ public:
 private:
     TuringMachine* machine;
 
-    QListWidget* statesList;
+    StateTableModel* statesModel;
+    QTableView* statesTable;
+    QLineEdit* filterEdit;
     QPushButton* addButton;
     QPushButton* editButton;
     QPushButton* removeButton;
 
     void setupUI();
+    State* getSelectedState();
 };
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "TapeMinimap.h"
+
+#include <QImage>
+#include <QMouseEvent>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+
+#include "../model/Tape.h"
+#include "../model/Transition.h"
+#include "../model/TuringMachine.h"
+
+namespace {
+
+constexpr int MinimapHeight = 24;
+
+// Columns are shaded from empty to fully written between these
+const QColor EmptyColor(245, 245, 245);
+const QColor WrittenColor(30, 80, 170);
+
+} // namespace
+
+TapeMinimap::TapeMinimap(QWidget* parent)
+    : QWidget(parent), m_tape(nullptr), m_machine(nullptr), m_summaryStale(false),
+      m_repaintPending(false), m_viewportFirst(0), m_viewportCount(0)
+{
+    setFixedHeight(MinimapHeight);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setToolTip(tr("Whole tape, click to scroll there"));
+}
+
+TapeMinimap::~TapeMinimap()
+{
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+}
+
+void TapeMinimap::setTape(const Tape* tape)
+{
+    m_tape = tape;
+    tapeChanged();
+}
+
+void TapeMinimap::setMachine(TuringMachine* machine)
+{
+    if (machine == m_machine) return;
+
+    if (m_machine) {
+        m_machine->removeObserver(this);
+    }
+    m_machine = machine;
+    if (m_machine) {
+        m_machine->addObserver(this);
+    }
+}
+
+void TapeMinimap::tapeChanged()
+{
+    m_summaryStale = true;
+    scheduleRepaint();
+}
+
+void TapeMinimap::onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                         const Transition& transition)
+{
+    if (machine.getTape() != m_tape || !m_tape) return;
+
+    // A stale summary is rebuilt from the tape anyway
+    if (!m_summaryStale) {
+        const std::string blank = m_tape->getBlankSymbolAsString();
+        const std::string writeSymbol = transition.getWriteSymbol();
+        m_summary.cellChanged(position, !readSymbol.empty() && readSymbol != blank,
+                              !writeSymbol.empty() && writeSymbol != blank);
+    }
+
+    scheduleRepaint();
+}
+
+void TapeMinimap::onJump(const TuringMachine& machine)
+{
+    if (machine.getTape() == m_tape) {
+        tapeChanged();
+    }
+}
+
+void TapeMinimap::onReplaced(TuringMachine& replacement)
+{
+    m_machine = &replacement;
+}
+
+void TapeMinimap::setViewport(int firstCell, int cellCount)
+{
+    m_viewportFirst = firstCell;
+    m_viewportCount = cellCount;
+    scheduleRepaint();
+}
+
+void TapeMinimap::scheduleRepaint()
+{
+    if (!m_repaintPending) {
+        m_repaintPending = true;
+        update();
+    }
+}
+
+void TapeMinimap::shownRange(int64_t& first, int64_t& end) const
+{
+    const int head = m_tape->getHeadPosition();
+    first = std::min(m_tape->getLeftmostUsedPosition(), head);
+    end = static_cast<int64_t>(std::max(m_tape->getRightmostUsedPosition(), head)) + 1;
+}
+
+void TapeMinimap::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    m_repaintPending = false;
+
+    QPainter painter(this);
+    painter.fillRect(rect(), EmptyColor);
+    if (!m_tape || width() <= 0) return;
+
+    if (m_summaryStale) {
+        m_summary.rebuild(*m_tape);
+        m_summaryStale = false;
+    }
+
+    int64_t first, end;
+    shownRange(first, end);
+    const int64_t span = end - first;
+    const int w = width();
+
+    // One row of pixels, stretched to the height
+    QImage strip(w, 1, QImage::Format_RGB32);
+    QRgb* pixels = reinterpret_cast<QRgb*>(strip.scanLine(0));
+    for (int x = 0; x < w; ++x) {
+        const int64_t start = first + span * x / w;
+        const int64_t stop = std::max(start + 1, first + span * (x + 1) / w);
+
+        // The square root keeps sparse stretches visible
+        const double density = std::sqrt(std::min(1.0, m_summary.count(start, stop) / static_cast<double>(stop - start)));
+        pixels[x] = qRgb(EmptyColor.red() + qRound((WrittenColor.red() - EmptyColor.red()) * density),
+                         EmptyColor.green() + qRound((WrittenColor.green() - EmptyColor.green()) * density),
+                         EmptyColor.blue() + qRound((WrittenColor.blue() - EmptyColor.blue()) * density));
+    }
+    painter.drawImage(rect(), strip);
+
+    auto toX = [&](int64_t cell) {
+        return static_cast<int>((cell - first) * w / span);
+    };
+
+    // Cells shown in the tape widget, at least a few pixels wide to be found
+    if (m_viewportCount > 0) {
+        const int left = toX(m_viewportFirst);
+        const int right = std::max(left + 3, toX(static_cast<int64_t>(m_viewportFirst) + m_viewportCount));
+        painter.setPen(QPen(Qt::darkGray, 1));
+        painter.setBrush(QColor(255, 255, 255, 60));
+        painter.drawRect(left, 0, right - left - 1, height() - 1);
+    }
+
+    const int headX = toX(m_tape->getHeadPosition()) + static_cast<int>(std::max<int64_t>(0, w / span / 2));
+    painter.fillRect(headX - 1, 0, 2, height(), Qt::red);
+}
+
+void TapeMinimap::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton) {
+        clickAt(event->pos().x());
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void TapeMinimap::mouseMoveEvent(QMouseEvent* event)
+{
+    // Dragging scrolls along
+    if (event->buttons() & Qt::LeftButton) {
+        clickAt(event->pos().x());
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void TapeMinimap::clickAt(int x)
+{
+    if (!m_tape || width() <= 0) return;
+
+    int64_t first, end;
+    shownRange(first, end);
+    x = std::clamp(x, 0, width() - 1);
+    emit cellClicked(static_cast<int>(first + (end - first) * x / width()));
+}
\ No newline at end of file
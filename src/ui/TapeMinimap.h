@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QWidget>
+#include <cstdint>
+
+#include "../model/ExecutionObserver.h"
+#include "../model/TapeSummary.h"
+
+class QPaintEvent;
+class QMouseEvent;
+class Tape;
+
+/**
+ * Strip showing the whole used part of a tape at once, each pixel column
+ * shaded by how many of its cells are written, with the head and the cells
+ * the tape widget shows marked on it. Densities come from a TapeSummary,
+ * so painting costs O(width * log n) however long the tape is. Steps of the
+ * machine update the summary as they happen; any other change to the tape
+ * rebuilds it once, with the next paint.
+ */
+class TapeMinimap : public QWidget, public ExecutionObserver
+{
+    Q_OBJECT
+
+public:
+    explicit TapeMinimap(QWidget* parent = nullptr);
+    ~TapeMinimap() override;
+
+    void setTape(const Tape* tape);
+    void setMachine(TuringMachine* machine);
+
+    // The tape changed other than by a step of the machine
+    void tapeChanged();
+
+    // ExecutionObserver
+    void onStep(const TuringMachine& machine, int position, const std::string& readSymbol,
+                const Transition& transition) override;
+    void onJump(const TuringMachine& machine) override;
+    void onReplaced(TuringMachine& replacement) override;
+
+signals:
+    void cellClicked(int cellIndex);
+
+public slots:
+    void setViewport(int firstCell, int cellCount);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+private:
+    const Tape* m_tape;
+    TuringMachine* m_machine;
+    TapeSummary m_summary;
+    bool m_summaryStale;    // Rebuilt with the next paint
+    bool m_repaintPending;  // An update() is queued, further steps needn't queue another
+
+    int m_viewportFirst;
+    int m_viewportCount;
+
+    void scheduleRepaint();
+    void shownRange(int64_t& first, int64_t& end) const;  // Cells [first, end) across the width
+    void clickAt(int x);
+};
\ No newline at end of file
@@ -5,28 +5,43 @@
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QResizeEvent>
+#include <QShowEvent>
+#include <QScreen>
 #include <QTimer>
 #include <QPropertyAnimation>
 #include <QInputDialog>
 #include <QMenu>
 #include <QDebug>
 
+#include <algorithm>
+#include <cmath>
+
 // Project includes
 #include "../model/Tape.h"
 
+namespace {
+    // Heatmap shading, from a faint yellow for the coldest cells to red
+    constexpr int HeatMinAlpha = 40;
+    constexpr int HeatMaxAlpha = 160;
+}
+
 TapeWidget::TapeWidget(QWidget *parent)
     : QWidget(parent), m_tape(nullptr), m_visibleCells(15), m_cellSize(40),
       m_leftmostCell(0), m_headAnimOffset(0), m_headAnimation(0.0),
-      m_interactiveMode(true)
+      m_interactiveMode(true), m_followedHead(0), m_reportedFirst(0), m_reportedCount(0),
+      m_heatmap(nullptr), m_heatmapCount(TapeHeatmap::Count::VISITS),
+      m_repaintPending(false), m_digitWidths(), m_digitAscent(0),
+      m_paintCacheCellSize(0), m_paintCacheRatio(0.0)
 {
     setMinimumHeight(100);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setFocusPolicy(Qt::StrongFocus);
     setContextMenuPolicy(Qt::DefaultContextMenu);
 
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer, &QTimer::timeout, this, &TapeWidget::updateTapeDisplay);
-    m_updateTimer->start(100);
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &TapeWidget::repaintFrame);
 
     m_headAnimationObj = new QPropertyAnimation(this, "headAnimation");
     m_headAnimationObj->setDuration(300);
@@ -35,7 +50,7 @@ TapeWidget::TapeWidget(QWidget *parent)
 
 TapeWidget::~TapeWidget()
 {
-    m_updateTimer->stop();
+    m_frameTimer->stop();
     delete m_headAnimationObj;
 }
 
@@ -49,10 +64,29 @@ void TapeWidget::setTape(Tape* tape)
 
 void TapeWidget::updateTapeDisplay()
 {
-    if (m_tape) {
+    if (!m_tape) return;
+
+    m_repaintPending = true;
+    if (isVisible() && !m_frameTimer->isActive()) {
+        const qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+        m_frameTimer->start(qMax(1, qRound(1000.0 / qMax<qreal>(1.0, refreshRate))));
+    }
+}
+
+void TapeWidget::repaintFrame()
+{
+    // Changes made while hidden are painted once the widget is shown
+    if (!m_repaintPending || !m_tape || !isVisible()) return;
+
+    m_repaintPending = false;
+
+    // Follow the head only when it moved, so the view stays where the user
+    // scrolled it while the tape changes elsewhere
+    if (m_tape->getHeadPosition() != m_followedHead) {
+        m_followedHead = m_tape->getHeadPosition();
         ensureHeadVisible();
-        update();
     }
+    update();
 }
 
 void TapeWidget::animateHeadMovement(bool moveRight)
@@ -110,10 +144,21 @@ void TapeWidget::resetZoom()
     update();
 }
 
+void TapeWidget::centerOnCell(int cellIndex)
+{
+    m_leftmostCell = cellIndex - m_visibleCells / 2;
+    update();
+}
+
+void TapeWidget::setHeatmap(const TapeHeatmap* heatmap, TapeHeatmap::Count count)
+{
+    m_heatmap = heatmap;
+    m_heatmapCount = count;
+    update();
+}
+
 void TapeWidget::onStepExecuted()
 {
-    if (!m_tape) return;
-    ensureHeadVisible();
     updateTapeDisplay();
 }
 
@@ -122,29 +167,45 @@ void TapeWidget::paintEvent(QPaintEvent *event)
 {
     if (!m_tape) return;
 
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    painter.fillRect(rect(), QColor(245, 245, 245));
-    drawGrid(painter);
-
-    int start = m_leftmostCell;
-    int end = start + m_visibleCells;
+    updatePaintCache();
 
-    auto visibleCells = m_tape->getVisiblePortion(start, end - start);
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_gridLayer);
 
-    for (const auto& cellPair : visibleCells) {
-        int cellIndex = cellPair.first;
-        const std::string& symbols = cellPair.second;
+    const int start = m_leftmostCell;
+    const int end = start + m_visibleCells;
+    const QRect exposed = event->rect();
 
-        QRect cellRect = getCellRect(cellIndex);
-
-        if (cellRect.intersects(event->rect())) {
-            drawCell(painter, cellIndex, cellRect, symbols);
+    auto drawCells = [&](int first, int last, const QPixmap* cellGlyph) {
+        for (int cellIndex = first; cellIndex < last; ++cellIndex) {
+            QRect cellRect = getCellRect(cellIndex);
+            if (cellRect.intersects(exposed)) {
+                drawCell(painter, cellIndex, cellRect, cellGlyph);
+            }
         }
+    };
+
+    // Written cells come as runs of the same symbols, cells between them are blank
+    int next = start;
+    m_tape->forEachRunInRange(start, end, [&](int runStart, int length, const std::string& symbols) {
+        drawCells(next, runStart, nullptr);
+        drawCells(runStart, runStart + length, &glyph(symbols));
+        next = runStart + length;
+    });
+    drawCells(next, end, nullptr);
+
+    if (m_heatmap) {
+        drawHeatmap(painter, exposed);
     }
 
+    painter.setRenderHint(QPainter::Antialiasing);
     drawHead(painter);
+
+    if (m_leftmostCell != m_reportedFirst || m_visibleCells != m_reportedCount) {
+        m_reportedFirst = m_leftmostCell;
+        m_reportedCount = m_visibleCells;
+        emit viewportChanged(m_leftmostCell, m_visibleCells);
+    }
 }
 
 void TapeWidget::mousePressEvent(QMouseEvent *event)
@@ -259,6 +320,12 @@ void TapeWidget::resizeEvent(QResizeEvent *event)
     updateCellSize();
 }
 
+void TapeWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    repaintFrame();
+}
+
 // Helper methods
 int TapeWidget::xToCell(int x) const
 {
@@ -277,6 +344,7 @@ void TapeWidget::centerHeadPosition()
 
     int headPosition = m_tape->getHeadPosition();
     m_leftmostCell = headPosition - m_visibleCells / 2;
+    m_followedHead = headPosition;
 
     updateTapeDisplay();
 }
@@ -362,47 +430,131 @@ void TapeWidget::moveHeadToCell(int cellIndex)
 }
 
 // Drawing methods
-void TapeWidget::drawCell(QPainter &painter, int cellIndex, const QRect &rect, const std::string& symbols)
+void TapeWidget::updatePaintCache()
 {
-    if (cellIndex == m_tape->getHeadPosition()) {
-        painter.fillRect(rect, QColor(255, 235, 185));
-    } else {
-        painter.fillRect(rect, QColor(255, 255, 255));
+    const qreal ratio = devicePixelRatioF();
+    if (m_paintCacheSize == size() && m_paintCacheCellSize == m_cellSize &&
+        m_paintCacheRatio == ratio && !m_gridLayer.isNull()) {
+        return;
+    }
+    m_paintCacheSize = size();
+    m_paintCacheCellSize = m_cellSize;
+    m_paintCacheRatio = ratio;
+
+    renderGridLayer();
+
+    const QRect cellRect(0, 0, m_cellSize, height());
+    for (int highlighted = 0; highlighted < 2; ++highlighted) {
+        QPixmap& background = m_cellBackgrounds[highlighted];
+        background = QPixmap(cellRect.size() * ratio);
+        background.setDevicePixelRatio(ratio);
+
+        QPainter painter(&background);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.fillRect(cellRect, highlighted ? QColor(255, 235, 185) : QColor(255, 255, 255));
+        painter.setPen(QPen(QColor(180, 180, 180), 1));
+        painter.drawRect(cellRect);
     }
 
-    painter.setPen(QPen(QColor(180, 180, 180), 1));
-    painter.drawRect(rect);
-
-    // Draw the symbols
-    if (!symbols.empty() && symbols != m_tape->getBlankSymbolAsString()) {
-        painter.setPen(Qt::black);
-        QFont font = painter.font();
-        font.setPointSize(14);
-        painter.setFont(font);
-
-        QString symbolStr = QString::fromStdString(symbols);
-
-        QFontMetrics fm(font);
-        QRect textRect = fm.boundingRect(symbolStr);
-        painter.drawText(
-            rect.left() + (rect.width() - textRect.width()) / 2,
-            rect.top() + (rect.height() + fm.ascent() - fm.descent()) / 2,
-            symbolStr
-        );
+    m_glyphs.clear();
+    for (int digit = 0; digit < 11; ++digit) {
+        QString text = digit < 10 ? QString::number(digit) : QStringLiteral("-");
+        m_digits[digit] = renderText(text, 8, Qt::gray, &m_digitAscent);
+        m_digitWidths[digit] = qRound(m_digits[digit].width() / ratio);
+    }
+}
+
+QPixmap TapeWidget::renderText(const QString& text, int pointSize, const QColor& color, int* ascent) const
+{
+    QFont textFont = font();
+    textFont.setPointSize(pointSize);
+    QFontMetrics fm(textFont);
+
+    const qreal ratio = devicePixelRatioF();
+    QPixmap pixmap(QSize(qMax(1, fm.horizontalAdvance(text)), fm.height()) * ratio);
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setFont(textFont);
+    painter.setPen(color);
+    painter.drawText(0, fm.ascent(), text);
+
+    if (ascent) {
+        *ascent = fm.ascent();
+    }
+    return pixmap;
+}
+
+const QPixmap& TapeWidget::glyph(const std::string& symbols)
+{
+    auto it = m_glyphs.find(symbols);
+    if (it == m_glyphs.end()) {
+        // Tapes rarely use more symbols than this, a runaway machine can't grow the cache forever
+        if (m_glyphs.size() >= 1024) {
+            m_glyphs.clear();
+        }
+        it = m_glyphs.emplace(symbols, renderText(QString::fromStdString(symbols), 14, Qt::black)).first;
+    }
+    return it->second;
+}
+
+void TapeWidget::drawCell(QPainter &painter, int cellIndex, const QRect &rect, const QPixmap* cellGlyph)
+{
+    painter.drawPixmap(rect.topLeft(), m_cellBackgrounds[cellIndex == m_tape->getHeadPosition()]);
+
+    // Draw the symbols, centered
+    if (cellGlyph) {
+        const qreal ratio = cellGlyph->devicePixelRatio();
+        painter.drawPixmap(rect.left() + (rect.width() - qRound(cellGlyph->width() / ratio)) / 2,
+                           rect.top() + (rect.height() - qRound(cellGlyph->height() / ratio)) / 2,
+                           *cellGlyph);
+    }
+
+    // Draw cell index at the bottom, digit by digit
+    int digits[11];
+    int digitCount = 0;
+    int64_t value = cellIndex < 0 ? -static_cast<int64_t>(cellIndex) : cellIndex;
+    do {
+        digits[digitCount++] = static_cast<int>(value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (cellIndex < 0) {
+        digits[digitCount++] = 10;
+    }
+
+    int indexWidth = 0;
+    for (int i = 0; i < digitCount; ++i) {
+        indexWidth += m_digitWidths[digits[i]];
     }
 
-    // Draw cell index at the bottom
-    QFont smallFont = painter.font();
-    smallFont.setPointSize(8);
-    painter.setFont(smallFont);
-    painter.setPen(Qt::gray);
-    QString indexStr = QString::number(cellIndex);
-    QFontMetrics smallFm(smallFont);
-    painter.drawText(
-        rect.left() + (rect.width() - smallFm.horizontalAdvance(indexStr)) / 2,
-        rect.bottom() - 5,
-        indexStr
-    );
+    int x = rect.left() + (rect.width() - indexWidth) / 2;
+    const int y = rect.bottom() - 5 - m_digitAscent;
+    for (int i = digitCount - 1; i >= 0; --i) {
+        painter.drawPixmap(x, y, m_digits[digits[i]]);
+        x += m_digitWidths[digits[i]];
+    }
+}
+
+void TapeWidget::drawHeatmap(QPainter &painter, const QRect &exposed)
+{
+    const uint32_t max = m_heatmap->getMax(m_heatmapCount);
+    if (max == 0) return;
+
+    // Log scale, so cells the head keeps coming back to don't wash out the rest
+    const double scale = 1.0 / std::log1p(static_cast<double>(max));
+    for (int cellIndex = m_leftmostCell; cellIndex < m_leftmostCell + m_visibleCells; ++cellIndex) {
+        const uint32_t count = m_heatmap->get(cellIndex, m_heatmapCount);
+        if (count == 0) continue;
+
+        QRect cellRect = getCellRect(cellIndex);
+        if (!cellRect.intersects(exposed)) continue;
+
+        const double heat = std::min(1.0, std::log1p(static_cast<double>(count)) * scale);
+        painter.fillRect(cellRect, QColor(255, qRound(220 * (1.0 - heat)), 0,
+                                          HeatMinAlpha + qRound((HeatMaxAlpha - HeatMinAlpha) * heat)));
+    }
 }
 
 void TapeWidget::drawHead(QPainter &painter)
@@ -430,8 +582,16 @@ void TapeWidget::drawHead(QPainter &painter)
     painter.drawLine(centerX, 0, centerX, 5);
 }
 
-void TapeWidget::drawGrid(QPainter &painter)
+void TapeWidget::renderGridLayer()
 {
+    const qreal ratio = devicePixelRatioF();
+    m_gridLayer = QPixmap(size() * ratio);
+    m_gridLayer.setDevicePixelRatio(ratio);
+
+    QPainter painter(&m_gridLayer);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(245, 245, 245));
+
     painter.setPen(QPen(QColor(220, 220, 220), 1, Qt::DotLine));
 
     for (int i = 0; i <= m_visibleCells; ++i) {
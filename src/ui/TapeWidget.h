@@ -1,6 +1,11 @@
 #pragma once
 
+#include <QPixmap>
 #include <QWidget>
+#include <string>
+#include <unordered_map>
+
+#include "../model/TapeHeatmap.h"
 
 // Forward declarations
 class QPainter;
@@ -11,6 +16,7 @@ class QMouseEvent;
 class QContextMenuEvent;
 class QWheelEvent;
 class QResizeEvent;
+class QShowEvent;
 class Tape;
 
 class TapeWidget : public QWidget
@@ -25,6 +31,8 @@ public:
 
     // Core functionality
     void setTape(Tape* tape);
+    // The tape or head changed: repaint with the next display frame. Any
+    // number of changes within a frame cost one paint, none while hidden.
     void updateTapeDisplay();
     void animateHeadMovement(bool moveRight);
 
@@ -41,10 +49,17 @@ public:
     void zoomOut();
     void resetZoom();
 
+    // Scroll so that a cell is in the middle, without moving the head
+    void centerOnCell(int cellIndex);
+
+    // Shade cells by one count of a heatmap, null for none
+    void setHeatmap(const TapeHeatmap* heatmap, TapeHeatmap::Count count = TapeHeatmap::Count::VISITS);
+
 signals:
     void cellValueChanged(int position, const std::string& newValue); // Changed to std::string
     void headPositionChanged(int newPosition);
     void tapeModified();
+    void viewportChanged(int firstCell, int cellCount);  // Cells shown, after a paint that scrolled or zoomed
 
 public slots:
     void onStepExecuted();
@@ -58,6 +73,7 @@ protected:
     void mouseMoveEvent(QMouseEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 
 private:
     // Data
@@ -68,12 +84,19 @@ private:
     int m_headAnimOffset;
     qreal m_headAnimation;
     bool m_interactiveMode;
+    int m_followedHead;    // Head position last scrolled into view
+    int m_reportedFirst;   // Viewport last reported with viewportChanged
+    int m_reportedCount;
+    const TapeHeatmap* m_heatmap;
+    TapeHeatmap::Count m_heatmapCount;
 
     // UI components
-    QTimer* m_updateTimer;
+    QTimer* m_frameTimer;  // Single shot, running while a repaint is pending
+    bool m_repaintPending;
     QPropertyAnimation* m_headAnimationObj;
 
     // Helper methods
+    void repaintFrame();
     int xToCell(int x) const;
     QRect getCellRect(int cellIndex) const;
     void centerHeadPosition();
@@ -83,8 +106,24 @@ private:
     void editCellValue(int cellIndex);
     void moveHeadToCell(int cellIndex);
 
+    // Pre-rendered pieces of a paint, rebuilt when the zoom, height or
+    // pixel ratio changes, so painting a cell is a few pixmap blits
+    QPixmap m_gridLayer;
+    QPixmap m_cellBackgrounds[2];                     // Plain and under the head
+    std::unordered_map<std::string, QPixmap> m_glyphs;  // Symbols as drawn in a cell
+    QPixmap m_digits[11];                             // 0-9 and '-' for cell indices
+    int m_digitWidths[11];
+    int m_digitAscent;
+    QSize m_paintCacheSize;                           // Widget size, cell size and pixel
+    int m_paintCacheCellSize;                         // ratio the pieces were made for
+    qreal m_paintCacheRatio;
+
     // Drawing methods
-    void drawCell(QPainter &painter, int cellIndex, const QRect &rect, const std::string& symbols); // Changed to std::string
+    void updatePaintCache();
+    QPixmap renderText(const QString& text, int pointSize, const QColor& color, int* ascent = nullptr) const;
+    const QPixmap& glyph(const std::string& symbols);
+    void drawCell(QPainter &painter, int cellIndex, const QRect &rect, const QPixmap* cellGlyph);
     void drawHead(QPainter &painter);
-    void drawGrid(QPainter &painter);
+    void drawHeatmap(QPainter &painter, const QRect &exposed);
+    void renderGridLayer();
 };
\ No newline at end of file
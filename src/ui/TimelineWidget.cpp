@@ -0,0 +1,141 @@
+#include "TimelineWidget.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTimer>
+#include <algorithm>
+
+#include "../model/RunTimeline.h"
+
+namespace {
+
+constexpr int TimelineHeight = 22;
+constexpr int Margin = 4;        // Keeps the handle at either end whole
+constexpr int FrameInterval = 16;
+
+const QColor TrackColor(225, 225, 225);
+const QColor PlayedColor(150, 180, 225);
+const QColor AcceptColor(40, 160, 60);
+const QColor RejectColor(200, 40, 40);
+const QColor MarkedColor(230, 140, 20);
+
+} // namespace
+
+TimelineWidget::TimelineWidget(QWidget* parent)
+    : QWidget(parent), m_timeline(nullptr), m_scrubbing(false), m_scrubStep(0)
+{
+    setFixedHeight(TimelineHeight);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setToolTip(tr("Run so far, drag to go through its steps"));
+
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, [this]() {
+        if (m_scrubbing) {
+            emit scrubbed(m_scrubStep);
+        }
+    });
+}
+
+TimelineWidget::~TimelineWidget() = default;
+
+void TimelineWidget::setTimeline(const RunTimeline* timeline)
+{
+    m_timeline = timeline;
+    update();
+}
+
+void TimelineWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    const int track = height() / 2 - 3;
+    painter.fillRect(Margin, track, width() - 2 * Margin, 6, TrackColor);
+    if (!m_timeline || m_timeline->isEmpty() || width() <= 2 * Margin) return;
+
+    const uint64_t position = m_scrubbing ? m_scrubStep : m_timeline->getPosition();
+    const int positionX = xOf(position);
+    painter.fillRect(Margin, track, positionX - Margin, 6, PlayedColor);
+
+    // The last event in each column, a halt is always the last of its column
+    const std::vector<RunTimeline::Event>& events = m_timeline->getEvents();
+    if (!events.empty()) {
+        auto byStep = [](const RunTimeline::Event& event, uint64_t step) { return event.step < step; };
+        for (int x = Margin; x < width() - Margin; ++x) {
+            const uint64_t start = stepAt(x);
+            const uint64_t end = std::max(start + 1, stepAt(x + 1));
+            auto it = std::lower_bound(events.begin(), events.end(), end, byStep);
+            if (it == events.begin() || (it - 1)->step < start) continue;
+
+            const RunTimeline::EventType type = (it - 1)->type;
+            const QColor& color = type == RunTimeline::EventType::ACCEPT ? AcceptColor
+                                : type == RunTimeline::EventType::REJECT ? RejectColor : MarkedColor;
+            painter.fillRect(x, 2, 1, height() - 4, color);
+        }
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(Qt::darkGray, 1));
+    painter.setBrush(Qt::white);
+    painter.drawRoundedRect(QRectF(positionX - 3.5, 1.5, 7, height() - 3), 2, 2);
+}
+
+void TimelineWidget::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton && m_timeline && !m_timeline->isEmpty()) {
+        m_scrubbing = true;
+        scrubTo(event->pos().x());
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void TimelineWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    if (m_scrubbing) {
+        scrubTo(event->pos().x());
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void TimelineWidget::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton && m_scrubbing) {
+        scrubTo(event->pos().x());
+        m_scrubbing = false;
+        m_frameTimer->stop();
+        emit released(m_scrubStep);
+        update();
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void TimelineWidget::scrubTo(int x)
+{
+    m_scrubStep = stepAt(x);
+    update();
+
+    // Mouse moves come faster than frames, the latest step is reported with the next one
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start(FrameInterval);
+    }
+}
+
+uint64_t TimelineWidget::stepAt(int x) const
+{
+    const uint64_t first = m_timeline->getFirstStep();
+    const uint64_t span = m_timeline->getLastStep() - first;
+    const int w = std::max(1, width() - 2 * Margin - 1);
+    const int clamped = std::clamp(x - Margin, 0, w);
+    return first + static_cast<uint64_t>(static_cast<double>(span) * clamped / w + 0.5);
+}
+
+int TimelineWidget::xOf(uint64_t step) const
+{
+    const uint64_t first = m_timeline->getFirstStep();
+    const uint64_t span = m_timeline->getLastStep() - first;
+    const int w = std::max(1, width() - 2 * Margin - 1);
+    if (span == 0) return Margin;
+    return Margin + static_cast<int>(static_cast<double>(std::clamp(step, first, first + span) - first) * w / span + 0.5);
+}
\ No newline at end of file
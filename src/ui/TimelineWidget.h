@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QWidget>
+#include <cstdint>
+
+class QMouseEvent;
+class QPaintEvent;
+class QTimer;
+class RunTimeline;
+
+/**
+ * Slider over the steps of the run on a tape, from where the run started
+ * to the furthest step reached, with the steps that entered accept, reject
+ * or marked states ticked on it. Dragging reports the step under the mouse
+ * at most once per display frame, releasing reports the step to stay at.
+ * Ticks are found per pixel column by binary search, so painting costs
+ * O(width * log n) however many events the run has.
+ */
+class TimelineWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TimelineWidget(QWidget* parent = nullptr);
+    ~TimelineWidget() override;
+
+    void setTimeline(const RunTimeline* timeline);
+    bool isScrubbing() const { return m_scrubbing; }
+
+signals:
+    void scrubbed(quint64 step);  // While dragging, to preview
+    void released(quint64 step);  // At the end of a drag, to seek to
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+private:
+    const RunTimeline* m_timeline;
+    bool m_scrubbing;
+    uint64_t m_scrubStep;
+    QTimer* m_frameTimer;  // Single shot, running while a scrubbed step waits to be reported
+
+    void scrubTo(int x);
+    uint64_t stepAt(int x) const;
+    int xOf(uint64_t step) const;
+};
\ No newline at end of file
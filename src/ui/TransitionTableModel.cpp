@@ -0,0 +1,151 @@
+#include "TransitionTableModel.h"
+
+#include "../model/TuringMachine.h"
+
+TransitionTableModel::TransitionTableModel(TuringMachine* machine, QObject* parent)
+    : MachineTableModel<Transition>(parent), m_machine(machine)
+{
+    refresh();
+}
+
+void TransitionTableModel::setMachine(TuringMachine* machine)
+{
+    m_machine = machine;
+    refresh();
+}
+
+void TransitionTableModel::addTransition(const std::string& fromState, const std::string& readSymbol,
+                                         const std::string& toState, const std::string& writeSymbol,
+                                         Direction direction)
+{
+    if (!m_machine) return;
+
+    // The machine replaces a transition with the same key
+    removeRowAt(rowOf(m_machine->getTransition(fromState, readSymbol)));
+
+    m_machine->addTransition(fromState, readSymbol, toState, writeSymbol, direction);
+    insertRowFor(m_machine->getTransition(fromState, readSymbol));
+}
+
+void TransitionTableModel::updateTransition(Transition* transition, const std::string& toState,
+                                            const std::string& writeSymbol, Direction direction)
+{
+    editItem(transition, [&]() {
+        transition->setToState(toState);
+        transition->setWriteSymbol(writeSymbol);
+        transition->setDirection(direction);
+    });
+}
+
+void TransitionTableModel::removeTransition(Transition* transition)
+{
+    if (!m_machine || !transition) return;
+
+    removeRowAt(rowOf(transition));
+    m_machine->removeTransition(transition->getFromState(), transition->getReadSymbol());
+}
+
+int TransitionTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TransitionTableModel::data(const QModelIndex& index, int role) const
+{
+    const Transition* transition = itemAt(index.row());
+    if (!transition || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case FromColumn:
+            return QString::fromStdString(transition->getFromState());
+        case ReadColumn:
+            return QString::fromStdString(transition->getReadSymbol());
+        case ToColumn:
+            return QString::fromStdString(transition->getToState());
+        case WriteColumn:
+            return QString::fromStdString(transition->getWriteSymbol());
+        case MoveColumn:
+            return directionText(transition->getDirection());
+        default:
+            return QVariant();
+    }
+}
+
+QVariant TransitionTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+        case FromColumn:
+            return tr("From State");
+        case ReadColumn:
+            return tr("Read");
+        case ToColumn:
+            return tr("To State");
+        case WriteColumn:
+            return tr("Write");
+        case MoveColumn:
+            return tr("Move");
+        default:
+            return QVariant();
+    }
+}
+
+void TransitionTableModel::collect(std::vector<Transition*>& items) const
+{
+    if (!m_machine) return;
+
+    items.reserve(m_machine->getTransitionCount());
+    m_machine->forEachTransition([&items](Transition* transition) {
+        items.push_back(transition);
+    });
+}
+
+int TransitionTableModel::compare(const Transition* a, const Transition* b, int column) const
+{
+    switch (column) {
+        case ReadColumn:
+            return a->getReadSymbol().compare(b->getReadSymbol());
+        case ToColumn:
+            return a->getToState().compare(b->getToState());
+        case WriteColumn:
+            return a->getWriteSymbol().compare(b->getWriteSymbol());
+        case MoveColumn:
+            return static_cast<int>(a->getDirection()) - static_cast<int>(b->getDirection());
+        default:
+            return 0;  // The key starts with the from state
+    }
+}
+
+int TransitionTableModel::compareKeys(const Transition* a, const Transition* b) const
+{
+    int result = a->getFromState().compare(b->getFromState());
+    if (result == 0) {
+        result = a->getReadSymbol().compare(b->getReadSymbol());
+    }
+    return result;
+}
+
+bool TransitionTableModel::matches(const Transition* transition) const
+{
+    return contains(transition->getFromState()) || contains(transition->getReadSymbol()) ||
+           contains(transition->getToState()) || contains(transition->getWriteSymbol()) ||
+           contains(directionText(transition->getDirection()).toStdString());
+}
+
+QString TransitionTableModel::directionText(Direction direction)
+{
+    switch (direction) {
+        case Direction::LEFT:
+            return tr("Left");
+        case Direction::RIGHT:
+            return tr("Right");
+        case Direction::STAY:
+            return tr("Stay");
+    }
+    return QString();
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "MachineTableModel.h"
+#include "../model/Transition.h"
+
+class TuringMachine;
+
+/**
+ * Transitions of a machine as a table, see MachineTableModel
+ */
+class TransitionTableModel : public MachineTableModel<Transition>
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        FromColumn,
+        ReadColumn,
+        ToColumn,
+        WriteColumn,
+        MoveColumn,
+        ColumnCount
+    };
+
+    explicit TransitionTableModel(TuringMachine* machine, QObject* parent = nullptr);
+
+    void setMachine(TuringMachine* machine);
+
+    // Edits made on the machine, one row at a time
+    void addTransition(const std::string& fromState, const std::string& readSymbol,
+                       const std::string& toState, const std::string& writeSymbol,
+                       Direction direction);
+    void updateTransition(Transition* transition, const std::string& toState,
+                          const std::string& writeSymbol, Direction direction);
+    void removeTransition(Transition* transition);
+
+    // QAbstractTableModel
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    void collect(std::vector<Transition*>& items) const override;
+    int compare(const Transition* a, const Transition* b, int column) const override;
+    int compareKeys(const Transition* a, const Transition* b) const override;
+    bool matches(const Transition* transition) const override;
+
+private:
+    TuringMachine* m_machine;
+
+    static QString directionText(Direction direction);
+};
\ No newline at end of file
@@ -1,83 +1,35 @@
 #include "TransitionsListWidget.h"
 
 // Qt includes
-#include <QTableWidget>
+#include <QTableView>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QHeaderView>
 #include <QMessageBox>
-#include <QVariant>
 
 // Project includes
 #include "../model/TuringMachine.h"
 #include "TransitionDialog.h"
+#include "TransitionTableModel.h"
 
 TransitionsListWidget::TransitionsListWidget(TuringMachine* machine, QWidget *parent)
     : QWidget(parent), machine(machine)
 {
     setupUI();
-    refreshTransitionsList();
 }
 
 void TransitionsListWidget::setMachine(TuringMachine* newMachine)
 {
     machine = newMachine;
-    refreshTransitionsList();
+    transitionsModel->setMachine(machine);
+    updateButtons();
 }
 
 void TransitionsListWidget::refreshTransitionsList()
 {
-    transitionsTable->clearContents();
-
-    if (!machine) {
-        transitionsTable->setRowCount(0);
-        updateButtons();
-        return;
-    }
-
-    auto transitions = machine->getAllTransitions();
-    transitionsTable->setRowCount(transitions.size());
-
-    for (size_t i = 0; i < transitions.size(); ++i) {
-        Transition* transition = transitions[i];
-
-        transitionsTable->setItem(i, 0, new QTableWidgetItem(
-            QString::fromStdString(transition->getFromState())));
-
-        transitionsTable->setItem(i, 1, new QTableWidgetItem(
-            QString::fromStdString(transition->getReadSymbol())));
-
-        transitionsTable->setItem(i, 2, new QTableWidgetItem(
-            QString::fromStdString(transition->getToState())));
-
-        transitionsTable->setItem(i, 3, new QTableWidgetItem(
-            QString::fromStdString(transition->getWriteSymbol())));
-
-        QString dirText;
-        switch (transition->getDirection()) {
-            case Direction::LEFT:
-                dirText = tr("Left");
-                break;
-            case Direction::RIGHT:
-                dirText = tr("Right");
-                break;
-            case Direction::STAY:
-                dirText = tr("Stay");
-                break;
-        }
-        transitionsTable->setItem(i, 4, new QTableWidgetItem(dirText));
-
-        // Store the transition key in user data
-        QStringList data;
-        data << QString::fromStdString(transition->getFromState())
-             << QString::fromStdString(transition->getReadSymbol());
-
-        for (int col = 0; col < 5; ++col) {
-            transitionsTable->item(i, col)->setData(Qt::UserRole, data);
-        }
-    }
-
+    transitionsModel->refresh();
     updateButtons();
 }
 
@@ -89,7 +41,7 @@ void TransitionsListWidget::addTransition()
         return;
     }
 
-    if (machine->getAllStates().empty()) {
+    if (machine->getStateCount() == 0) {
         QMessageBox::warning(this, tr("No States"),
             tr("You need to create at least one state before adding transitions."));
         return;
@@ -108,7 +60,8 @@ void TransitionsListWidget::addTransition()
             return;
         }
 
-        machine->addTransition(
+        emit aboutToEdit();
+        transitionsModel->addTransition(
             fromState,
             readSymbol,
             dialog.getToState().toStdString(),
@@ -116,7 +69,6 @@ void TransitionsListWidget::addTransition()
             dialog.getDirection()
         );
 
-        refreshTransitionsList();
         emit transitionAdded();
     }
 }
@@ -125,18 +77,28 @@ void TransitionsListWidget::setupUI()
 {
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
-    transitionsTable = new QTableWidget(this);
-    transitionsTable->setColumnCount(5);
-    transitionsTable->setHorizontalHeaderLabels(
-        QStringList() << tr("From State") << tr("Read") << tr("To State") << tr("Write") << tr("Move"));
+    filterEdit = new QLineEdit(this);
+    filterEdit->setPlaceholderText(tr("Filter"));
+    filterEdit->setClearButtonEnabled(true);
+    mainLayout->addWidget(filterEdit);
+
+    // Rows come from the model as they scroll into view, all the same height
+    transitionsModel = new TransitionTableModel(machine, this);
+    transitionsTable = new QTableView(this);
+    transitionsTable->setModel(transitionsModel);
 
     transitionsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     transitionsTable->setSelectionMode(QAbstractItemView::SingleSelection);
     transitionsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     transitionsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    transitionsTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    transitionsTable->verticalHeader()->hide();
+    transitionsTable->horizontalHeader()->setSortIndicator(TransitionTableModel::FromColumn, Qt::AscendingOrder);
+    transitionsTable->setSortingEnabled(true);
 
-    connect(transitionsTable, &QTableWidget::itemSelectionChanged, this, &TransitionsListWidget::updateButtons);
-    connect(transitionsTable, &QTableWidget::cellDoubleClicked, this, &TransitionsListWidget::handleCellDoubleClick);
+    connect(filterEdit, &QLineEdit::textChanged, transitionsModel, &TransitionTableModel::setFilterText);
+    connect(transitionsModel, &QAbstractItemModel::modelReset, this, &TransitionsListWidget::updateButtons);
+    connect(transitionsTable, &QTableView::doubleClicked, this, &TransitionsListWidget::handleDoubleClick);
 
     mainLayout->addWidget(transitionsTable);
 
@@ -158,6 +120,8 @@ void TransitionsListWidget::setupUI()
 
     updateButtons();
 
+    connect(transitionsTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+        this, &TransitionsListWidget::updateButtons);
     connect(transitionsTable->selectionModel(), &QItemSelectionModel::selectionChanged,
         this, &TransitionsListWidget::onTransitionSelectionChanged);
 }
@@ -169,29 +133,23 @@ void TransitionsListWidget::editTransition()
 
     TransitionDialog dialog(machine, this, transition);
     if (dialog.exec() == QDialog::Accepted) {
-        transition->setToState(dialog.getToState().toStdString());
-        transition->setWriteSymbol(dialog.getWriteSymbol().toStdString());
-        transition->setDirection(dialog.getDirection());
+        emit aboutToEdit();
+        transitionsModel->updateTransition(transition,
+                                           dialog.getToState().toStdString(),
+                                           dialog.getWriteSymbol().toStdString(),
+                                           dialog.getDirection());
 
-        refreshTransitionsList();
         emit transitionEdited();
     }
 }
 
 void TransitionsListWidget::removeTransition()
 {
-    QModelIndexList selection = transitionsTable->selectionModel()->selectedRows();
-    if (selection.isEmpty()) return;
-
-    int row = selection.first().row();
-    QTableWidgetItem* item = transitionsTable->item(row, 0);
-    if (!item) return;
-
-    QStringList data = item->data(Qt::UserRole).toStringList();
-    if (data.size() < 2) return;
+    Transition* transition = getSelectedTransition();
+    if (!transition) return;
 
-    std::string fromState = data[0].toStdString();
-    std::string readSymbol = data[1].toStdString();
+    std::string fromState = transition->getFromState();
+    std::string readSymbol = transition->getReadSymbol();
 
     QMessageBox::StandardButton reply = QMessageBox::question(this, tr("Confirm Deletion"),
         tr("Are you sure you want to delete the transition from state '%1' on symbol '%2'?")
@@ -200,8 +158,8 @@ void TransitionsListWidget::removeTransition()
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        machine->removeTransition(fromState, readSymbol);
-        refreshTransitionsList();
+        emit aboutToEdit();
+        transitionsModel->removeTransition(transition);
         emit transitionRemoved();
     }
 }
@@ -213,10 +171,9 @@ void TransitionsListWidget::updateButtons()
     removeButton->setEnabled(hasSelection);
 }
 
-void TransitionsListWidget::handleCellDoubleClick(int row, int column)
+void TransitionsListWidget::handleDoubleClick(const QModelIndex& index)
 {
-    Q_UNUSED(row);
-    Q_UNUSED(column);
+    Q_UNUSED(index);
     editTransition();
 }
 
@@ -225,33 +182,13 @@ Transition* TransitionsListWidget::getSelectedTransition()
     QModelIndexList selection = transitionsTable->selectionModel()->selectedRows();
     if (selection.isEmpty()) return nullptr;
 
-    int row = selection.first().row();
-    QTableWidgetItem* item = transitionsTable->item(row, 0);
-    if (!item) return nullptr;
-
-    QStringList data = item->data(Qt::UserRole).toStringList();
-    if (data.size() < 2) return nullptr;
-
-    std::string fromState = data[0].toStdString();
-    std::string readSymbol = data[1].toStdString();
-
-    return machine->getTransition(fromState, readSymbol);
+    return transitionsModel->itemAt(selection.first().row());
 }
 
 void TransitionsListWidget::onTransitionSelectionChanged()
 {
-    QModelIndexList selection = transitionsTable->selectionModel()->selectedRows();
-    if (selection.isEmpty()) return;
-
-    int row = selection.first().row();
-    QTableWidgetItem* item = transitionsTable->item(row, 0);
-    if (!item) return;
-
-    QStringList data = item->data(Qt::UserRole).toStringList();
-    if (data.size() < 2) return;
-
-    std::string fromState = data[0].toStdString();
-    std::string readSymbol = data[1].toStdString();
-
-    emit transitionSelected(fromState, readSymbol);
+    Transition* transition = getSelectedTransition();
+    if (transition) {
+        emit transitionSelected(transition->getFromState(), transition->getReadSymbol());
+    }
 }
\ No newline at end of file
@@ -4,10 +4,13 @@
 #include <string>
 
 // Forward declarations
-class QTableWidget;
+class QTableView;
+class QLineEdit;
 class QPushButton;
+class QModelIndex;
 class TuringMachine;
 class Transition;
+class TransitionTableModel;
 
 class TransitionsListWidget : public QWidget
 {
@@ -24,19 +27,22 @@ public:
     void transitionEdited();
     void transitionRemoved();
     void transitionSelected(const std::string& fromState, const std::string& readSymbol);  // Changed to use std::string
+    void aboutToEdit();  // Before any change is made to the machine
 
     private slots:
         void addTransition();
     void editTransition();
     void removeTransition();
     void updateButtons();
-    void handleCellDoubleClick(int row, int column);
+    void handleDoubleClick(const QModelIndex& index);
     void onTransitionSelectionChanged();
 
 private:
     TuringMachine* machine;
 
-    QTableWidget* transitionsTable;
+    TransitionTableModel* transitionsModel;
+    QTableView* transitionsTable;
+    QLineEdit* filterEdit;
     QPushButton* addButton;
     QPushButton* editButton;
     QPushButton* removeButton;
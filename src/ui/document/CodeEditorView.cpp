@@ -1,7 +1,8 @@
 #include "CodeEditorView.h"
 #include "../../document/CodeDocument.h"
 #include "../../project/Project.h"
-#include <QTextEdit>
+#include "../CodeHighlighter.h"
+#include <QPlainTextEdit>
 #include <QPushButton>
 #include <QLabel>
 #include <QVBoxLayout>
@@ -15,10 +16,18 @@
 CodeEditorView::CodeEditorView(CodeDocument* document, QWidget* parent)
     : DocumentView(document, parent),
       m_codeDocument(document),
-      m_ignoreTextChanges(false)
+      m_highlighter(nullptr),
+      m_ignoreTextChanges(false),
+      m_applyingChanges(false)
 {
     setupUI();
     updateFromDocument();
+
+    // Pick up code that was loaded into the document from elsewhere
+    if (m_codeDocument) {
+        connect(m_codeDocument, &CodeDocument::codeChanged,
+                this, &CodeEditorView::onDocumentCodeChanged);
+    }
 }
 
 CodeEditorView::~CodeEditorView()
@@ -38,11 +47,18 @@ void CodeEditorView::setupUI()
     mainLayout->addWidget(headerLabel);
 
     // Code editor
-    m_codeEditor = new QTextEdit(this);
+    m_codeEditor = new QPlainTextEdit(this);
     QFont codeFont("Courier New", 10);
     m_codeEditor->setFont(codeFont);
+    m_codeEditor->setLineWrapMode(QPlainTextEdit::NoWrap);
     mainLayout->addWidget(m_codeEditor);
 
+    // Lines are highlighted lazily as they scroll into view
+    m_highlighter = new CodeHighlighter(m_codeEditor->document());
+    connect(m_codeEditor, &QPlainTextEdit::updateRequest, this, [this]() {
+        m_highlighter->highlightVisibleBlocks(m_codeEditor);
+    });
+
     // Bottom controls
     QHBoxLayout* bottomLayout = new QHBoxLayout();
 
@@ -68,7 +84,7 @@ void CodeEditorView::setupUI()
     mainLayout->addLayout(bottomLayout);
 
     // Connect signals
-    connect(m_codeEditor, &QTextEdit::textChanged, this, &CodeEditorView::onTextChanged);
+    connect(m_codeEditor, &QPlainTextEdit::textChanged, this, &CodeEditorView::onTextChanged);
 
     // Initial state
     m_applyButton->setEnabled(false);
@@ -80,7 +96,10 @@ void CodeEditorView::updateFromDocument()
     if (!m_codeDocument) return;
 
     m_ignoreTextChanges = true;
+    // Leave every block pending, the visible ones are picked up on the next repaint
+    m_highlighter->setVisibleRange(0, -1);
     m_codeEditor->setPlainText(QString::fromStdString(m_codeDocument->getCode()));
+    m_highlighter->highlightVisibleBlocks(m_codeEditor);
     m_ignoreTextChanges = false;
 
     m_applyButton->setEnabled(false);
@@ -98,17 +117,35 @@ void CodeEditorView::onTextChanged()
     setStatusMessage(tr("Modified - click Apply to update the machine"));
 }
 
+void CodeEditorView::onDocumentCodeChanged()
+{
+    // Changes applied from this view are already in the editor
+    if (m_applyingChanges) return;
+
+    updateFromDocument();
+}
+
 void CodeEditorView::applyChanges()
 {
     if (!m_codeDocument) return;
 
     std::string newCode = m_codeEditor->toPlainText().toStdString();
+    m_applyingChanges = true;
     m_codeDocument->setCode(newCode);
+    m_applyingChanges = false;
 
     m_applyButton->setEnabled(false);
     m_resetButton->setEnabled(false);
 
-    setStatusMessage(tr("Changes applied successfully"));
+    const auto& diagnostics = m_codeDocument->getDiagnostics();
+    if (diagnostics.empty()) {
+        setStatusMessage(tr("Changes applied successfully"));
+    } else {
+        setStatusMessage(tr("Applied with %1 problem(s), first on line %2: %3")
+                         .arg(diagnostics.size())
+                         .arg(diagnostics.front().line)
+                         .arg(QString::fromStdString(diagnostics.front().message)), true);
+    }
     emit viewModified();
 }
 
@@ -4,7 +4,8 @@
 #include <memory>
 
 class CodeDocument;
-class QTextEdit;
+class QPlainTextEdit;
+class CodeHighlighter;
 class QPushButton;
 class QLabel;
 
@@ -24,6 +25,7 @@ public:
 
     private slots:
         void onTextChanged();
+    void onDocumentCodeChanged();
     void applyChanges();
     void resetChanges();
     void createNewTape();
@@ -32,13 +34,15 @@ private:
     CodeDocument* m_codeDocument;
 
     // UI components
-    QTextEdit* m_codeEditor;
+    QPlainTextEdit* m_codeEditor;
+    CodeHighlighter* m_highlighter;
     QPushButton* m_applyButton;
     QPushButton* m_resetButton;
     QPushButton* m_newTapeButton;
     QLabel* m_statusLabel;
 
     bool m_ignoreTextChanges;
+    bool m_applyingChanges;
 
     void setupUI();
     void setStatusMessage(const QString& message, bool isError = false);
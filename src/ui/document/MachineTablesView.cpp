@@ -0,0 +1,100 @@
+#include "MachineTablesView.h"
+#include "../../document/CodeDocument.h"
+#include "../../model/TuringMachine.h"
+#include "../../parser/MachineNotation.h"
+#include "../../project/Project.h"
+#include "../../project/ProjectSaver.h"
+#include "../StatesListWidget.h"
+#include "../TransitionsListWidget.h"
+#include <QLabel>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+MachineTablesView::MachineTablesView(CodeDocument* document, QWidget* parent)
+    : DocumentView(document, parent),
+      m_codeDocument(document)
+{
+    setupUI();
+
+    // The machine is compiled again whenever its code changes
+    if (m_codeDocument) {
+        connect(m_codeDocument, &CodeDocument::codeChanged, this, [this](const std::string&) {
+            updateFromDocument();
+        });
+    }
+
+    updateFromDocument();
+}
+
+MachineTablesView::~MachineTablesView()
+{
+}
+
+void MachineTablesView::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // Header label
+    m_headerLabel = new QLabel(this);
+    QFont headerFont = m_headerLabel->font();
+    headerFont.setBold(true);
+    headerFont.setPointSize(headerFont.pointSize() + 1);
+    m_headerLabel->setFont(headerFont);
+    mainLayout->addWidget(m_headerLabel);
+
+    // Tables side by side
+    QSplitter* splitter = new QSplitter(Qt::Horizontal, this);
+
+    m_states = new StatesListWidget(nullptr, splitter);
+    connect(m_states, &StatesListWidget::aboutToEdit, this, &MachineTablesView::onAboutToEdit);
+    connect(m_states, &StatesListWidget::stateAdded, this, &MachineTablesView::onMachineEdited);
+    connect(m_states, &StatesListWidget::stateEdited, this, &MachineTablesView::onMachineEdited);
+    connect(m_states, &StatesListWidget::stateRemoved, this, [this](const std::string&) {
+        // Transitions of the state went with it
+        m_transitions->refreshTransitionsList();
+        onMachineEdited();
+    });
+    splitter->addWidget(m_states);
+
+    m_transitions = new TransitionsListWidget(nullptr, splitter);
+    connect(m_transitions, &TransitionsListWidget::aboutToEdit, this, &MachineTablesView::onAboutToEdit);
+    connect(m_transitions, &TransitionsListWidget::transitionAdded, this, &MachineTablesView::onMachineEdited);
+    connect(m_transitions, &TransitionsListWidget::transitionEdited, this, &MachineTablesView::onMachineEdited);
+    connect(m_transitions, &TransitionsListWidget::transitionRemoved, this, &MachineTablesView::onMachineEdited);
+    splitter->addWidget(m_transitions);
+
+    mainLayout->addWidget(splitter, 1);
+}
+
+void MachineTablesView::updateFromDocument()
+{
+    if (!m_codeDocument) return;
+
+    Project* project = m_codeDocument->getProject();
+    m_headerLabel->setText(tr("States and Transitions: %1")
+        .arg(QString::fromStdString(project ? project->getName() : m_codeDocument->getName())));
+
+    TuringMachine* machine = project ? project->getMachine() : nullptr;
+    m_states->setMachine(machine);
+    m_transitions->setMachine(machine);
+}
+
+void MachineTablesView::onAboutToEdit()
+{
+    // A background save reads the machine in place
+    Project* project = m_codeDocument ? m_codeDocument->getProject() : nullptr;
+    if (project) {
+        project->getSaver()->waitForCurrentSave();
+    }
+}
+
+void MachineTablesView::onMachineEdited()
+{
+    Project* project = m_codeDocument ? m_codeDocument->getProject() : nullptr;
+    if (!project) return;
+
+    // The code follows the edit, or the next compile would undo it and the
+    // machine would be cached and saved under code it wasn't built from
+    m_codeDocument->restoreCode(MachineNotation::toCode(*project->getMachine()));
+    project->setMachineModified();
+}
\ No newline at end of file
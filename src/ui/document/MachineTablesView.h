@@ -0,0 +1,38 @@
+#pragma once
+
+#include "DocumentView.h"
+
+class CodeDocument;
+class StatesListWidget;
+class TransitionsListWidget;
+class QLabel;
+
+/**
+ * View listing the states and transitions of a project's machine as
+ * tables, in a tab of its own next to the code it is compiled from
+ */
+class MachineTablesView : public DocumentView
+{
+    Q_OBJECT
+
+public:
+    MachineTablesView(CodeDocument* document, QWidget* parent = nullptr);
+    ~MachineTablesView() override;
+
+    // Update view from document
+    void updateFromDocument() override;
+
+private slots:
+    void onAboutToEdit();
+    void onMachineEdited();
+
+private:
+    CodeDocument* m_codeDocument;
+
+    // UI components
+    QLabel* m_headerLabel;
+    StatesListWidget* m_states;
+    TransitionsListWidget* m_transitions;
+
+    void setupUI();
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "SpaceTimeView.h"
+#include "../../document/TapeDocument.h"
+#include "../../project/Project.h"
+#include "../SpaceTimeWidget.h"
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+SpaceTimeView::SpaceTimeView(TapeDocument* document, QWidget* parent)
+    : DocumentView(document, parent),
+      m_tapeDocument(document)
+{
+    setupUI();
+
+    // Record from the moment the tab opens, shown or not
+    updateFromDocument();
+}
+
+SpaceTimeView::~SpaceTimeView()
+{
+}
+
+void SpaceTimeView::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // Header label
+    m_headerLabel = new QLabel(this);
+    QFont headerFont = m_headerLabel->font();
+    headerFont.setBold(true);
+    headerFont.setPointSize(headerFont.pointSize() + 1);
+    m_headerLabel->setFont(headerFont);
+    mainLayout->addWidget(m_headerLabel);
+
+    // Diagram
+    m_diagram = new SpaceTimeWidget(this);
+    mainLayout->addWidget(m_diagram, 1);
+
+    // View controls
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+
+    QPushButton* zoomInButton = new QPushButton(tr("+"), this);
+    connect(zoomInButton, &QPushButton::clicked, m_diagram, &SpaceTimeWidget::zoomIn);
+    buttonLayout->addWidget(zoomInButton);
+
+    QPushButton* zoomOutButton = new QPushButton(tr("-"), this);
+    connect(zoomOutButton, &QPushButton::clicked, m_diagram, &SpaceTimeWidget::zoomOut);
+    buttonLayout->addWidget(zoomOutButton);
+
+    QPushButton* fitButton = new QPushButton(tr("Fit"), this);
+    fitButton->setToolTip(tr("Show the whole run and follow it as it grows"));
+    connect(fitButton, &QPushButton::clicked, m_diagram, &SpaceTimeWidget::fitToView);
+    buttonLayout->addWidget(fitButton);
+
+    buttonLayout->addStretch();
+
+    QPushButton* restartButton = new QPushButton(tr("Start Over"), this);
+    restartButton->setToolTip(tr("Clear the diagram and record from the current step"));
+    connect(restartButton, &QPushButton::clicked, m_diagram, &SpaceTimeWidget::restart);
+    buttonLayout->addWidget(restartButton);
+
+    mainLayout->addLayout(buttonLayout);
+}
+
+void SpaceTimeView::updateFromDocument()
+{
+    if (!m_tapeDocument) return;
+
+    m_headerLabel->setText(tr("Space-Time Diagram: %1").arg(QString::fromStdString(m_tapeDocument->getName())));
+
+    TuringMachine* machine = m_tapeDocument->getProject() ? m_tapeDocument->getProject()->getMachine() : nullptr;
+    m_diagram->setTape(m_tapeDocument->getTape());
+    m_diagram->setMachine(machine);
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "DocumentView.h"
+
+class TapeDocument;
+class SpaceTimeWidget;
+class QLabel;
+
+/**
+ * View showing a tape's run as a space-time diagram, in a tab of its own
+ * next to the tape's TapeVisualizationView
+ */
+class SpaceTimeView : public DocumentView
+{
+    Q_OBJECT
+
+public:
+    SpaceTimeView(TapeDocument* document, QWidget* parent = nullptr);
+    ~SpaceTimeView() override;
+
+    // Update view from document
+    void updateFromDocument() override;
+
+private:
+    TapeDocument* m_tapeDocument;
+
+    // UI components
+    QLabel* m_headerLabel;
+    SpaceTimeWidget* m_diagram;
+
+    void setupUI();
+};
\ No newline at end of file
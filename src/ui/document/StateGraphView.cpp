@@ -0,0 +1,143 @@
+#include "StateGraphView.h"
+#include "../../document/CodeDocument.h"
+#include "../../model/TuringMachine.h"
+#include "../../project/Project.h"
+#include "../../project/ProjectSaver.h"
+#include "../StateGraphWidget.h"
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+StateGraphView::StateGraphView(CodeDocument* document, QWidget* parent)
+    : DocumentView(document, parent),
+      m_codeDocument(document)
+{
+    setupUI();
+
+    // The machine is compiled again whenever its code changes
+    if (m_codeDocument) {
+        connect(m_codeDocument, &CodeDocument::codeChanged, this, [this](const std::string&) {
+            updateFromDocument();
+        });
+    }
+
+    updateFromDocument();
+}
+
+StateGraphView::~StateGraphView()
+{
+}
+
+void StateGraphView::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    // Header label
+    m_headerLabel = new QLabel(this);
+    QFont headerFont = m_headerLabel->font();
+    headerFont.setBold(true);
+    headerFont.setPointSize(headerFont.pointSize() + 1);
+    m_headerLabel->setFont(headerFont);
+    mainLayout->addWidget(m_headerLabel);
+
+    // Graph
+    m_graph = new StateGraphWidget(this);
+    connect(m_graph, &StateGraphWidget::layoutStarted, this, &StateGraphView::onLayoutStarted);
+    connect(m_graph, &StateGraphWidget::layoutProgress, this, &StateGraphView::onLayoutProgress);
+    connect(m_graph, &StateGraphWidget::layoutFinished, this, &StateGraphView::onLayoutFinished);
+    connect(m_graph, &StateGraphWidget::aboutToStorePositions, this, [this]() {
+        // A background save reads the states in place
+        Project* project = m_codeDocument ? m_codeDocument->getProject() : nullptr;
+        if (project) {
+            project->getSaver()->waitForCurrentSave();
+        }
+    });
+    connect(m_graph, &StateGraphWidget::positionsChanged, this, [this]() {
+        // The journal only replays code, so the layout is saved with the whole file
+        Project* project = m_codeDocument ? m_codeDocument->getProject() : nullptr;
+        if (project) {
+            project->setMachineModified();
+        }
+    });
+    mainLayout->addWidget(m_graph, 1);
+
+    // View controls
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+
+    QPushButton* zoomInButton = new QPushButton(tr("+"), this);
+    connect(zoomInButton, &QPushButton::clicked, m_graph, &StateGraphWidget::zoomIn);
+    buttonLayout->addWidget(zoomInButton);
+
+    QPushButton* zoomOutButton = new QPushButton(tr("-"), this);
+    connect(zoomOutButton, &QPushButton::clicked, m_graph, &StateGraphWidget::zoomOut);
+    buttonLayout->addWidget(zoomOutButton);
+
+    QPushButton* fitButton = new QPushButton(tr("Fit"), this);
+    fitButton->setToolTip(tr("Show the whole graph"));
+    connect(fitButton, &QPushButton::clicked, m_graph, &StateGraphWidget::fitToView);
+    buttonLayout->addWidget(fitButton);
+
+    m_statusLabel = new QLabel(this);
+    buttonLayout->addWidget(m_statusLabel, 1);
+
+    m_layoutButton = new QPushButton(tr("Lay Out Again"), this);
+    m_layoutButton->setToolTip(tr("Lay out all states again, starting from where they are"));
+    connect(m_layoutButton, &QPushButton::clicked, m_graph, &StateGraphWidget::relayout);
+    buttonLayout->addWidget(m_layoutButton);
+
+    m_stopButton = new QPushButton(tr("Stop"), this);
+    m_stopButton->setToolTip(tr("Keep the states where they are now"));
+    m_stopButton->setEnabled(false);
+    connect(m_stopButton, &QPushButton::clicked, m_graph, &StateGraphWidget::stopLayout);
+    buttonLayout->addWidget(m_stopButton);
+
+    mainLayout->addLayout(buttonLayout);
+}
+
+void StateGraphView::updateFromDocument()
+{
+    if (!m_codeDocument) return;
+
+    Project* project = m_codeDocument->getProject();
+    m_headerLabel->setText(tr("State Graph: %1")
+        .arg(QString::fromStdString(project ? project->getName() : m_codeDocument->getName())));
+
+    m_graph->setMachine(project ? project->getMachine() : nullptr);
+    if (!m_graph->isLayoutRunning()) {
+        showGraphSize();
+    }
+}
+
+void StateGraphView::onLayoutStarted()
+{
+    m_layoutButton->setEnabled(false);
+    m_stopButton->setEnabled(true);
+    m_statusLabel->setText(tr("Laying out..."));
+}
+
+void StateGraphView::onLayoutProgress(int iteration)
+{
+    m_statusLabel->setText(tr("Laying out... iteration %1").arg(iteration));
+}
+
+void StateGraphView::onLayoutFinished()
+{
+    m_layoutButton->setEnabled(true);
+    m_stopButton->setEnabled(false);
+    showGraphSize();
+}
+
+void StateGraphView::showGraphSize()
+{
+    Project* project = m_codeDocument ? m_codeDocument->getProject() : nullptr;
+    TuringMachine* machine = project ? project->getMachine() : nullptr;
+    if (!machine) {
+        m_statusLabel->clear();
+        return;
+    }
+
+    m_statusLabel->setText(tr("%1 states, %2 transitions")
+        .arg(machine->getStateCount())
+        .arg(machine->getTransitionCount()));
+}
\ No newline at end of file
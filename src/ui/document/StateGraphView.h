@@ -0,0 +1,42 @@
+#pragma once
+
+#include "DocumentView.h"
+
+class CodeDocument;
+class StateGraphWidget;
+class QLabel;
+class QPushButton;
+
+/**
+ * View showing the states and transitions of a project's machine as a
+ * graph, in a tab of its own next to the code it is compiled from
+ */
+class StateGraphView : public DocumentView
+{
+    Q_OBJECT
+
+public:
+    StateGraphView(CodeDocument* document, QWidget* parent = nullptr);
+    ~StateGraphView() override;
+
+    // Update view from document
+    void updateFromDocument() override;
+
+private slots:
+    void onLayoutStarted();
+    void onLayoutProgress(int iteration);
+    void onLayoutFinished();
+
+private:
+    CodeDocument* m_codeDocument;
+
+    // UI components
+    QLabel* m_headerLabel;
+    StateGraphWidget* m_graph;
+    QLabel* m_statusLabel;
+    QPushButton* m_layoutButton;
+    QPushButton* m_stopButton;
+
+    void setupUI();
+    void showGraphSize();
+};
\ No newline at end of file
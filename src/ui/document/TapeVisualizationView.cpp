@@ -1,8 +1,13 @@
 #include "TapeVisualizationView.h"
 #include "../../document/TapeDocument.h"
 #include "../../project/Project.h"
+#include "../../project/ProjectManager.h"
 #include "../TapeWidget.h"
+#include "../TapeMinimap.h"
+#include "../TimelineWidget.h"
 #include "../../model/TuringMachine.h"
+#include "../../model/TapeHeatmap.h"
+#include "../../model/RunTimeline.h"
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QPushButton>
@@ -12,14 +17,44 @@
 #include <QGroupBox>
 #include <QTimer>
 #include <QSlider>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QScreen>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QAction>
+#include <QSaveFile>
+#include <QSignalBlocker>
+#include <QShowEvent>
+#include <algorithm>
+
+namespace {
+
+// Of each frame's time, turbo spends this much stepping and leaves the rest for painting
+constexpr qint64 TurboStepBudgetNs = 10 * 1000 * 1000;
+
+constexpr uint64_t TurboInitialBatch = 1000;
+
+// The batch may grow this much from one frame to the next
+constexpr uint64_t TurboMaxGrowth = 4;
+
+// Achieved steps per second are shown every this many milliseconds
+constexpr qint64 RateInterval = 500;
+
+} // namespace
 
 TapeVisualizationView::TapeVisualizationView(TapeDocument* document, QWidget* parent)
     : DocumentView(document, parent),
       m_tapeDocument(document),
-      m_simulationSpeed(500) // Default speed: 500ms
+      m_simulationSpeed(500), // Default speed: 500ms
+      m_shown(false),
+      m_previewing(false),
+      m_turboBatch(TurboInitialBatch),
+      m_turboCredit(0.0),
+      m_rateSteps(0)
 {
+    // Tabs of a project with many stored tapes open without reading them
     setupUI();
-    updateFromDocument();
 
     // Create simulation timer
     m_simulationTimer = new QTimer(this);
@@ -55,11 +90,11 @@ void TapeVisualizationView::setupUI()
     headerLabel->setFont(headerFont);
     mainLayout->addWidget(headerLabel);
 
-    // Tape widget
+    // Whole tape overview and the tape widget
+    m_minimap = new TapeMinimap(this);
+    mainLayout->addWidget(m_minimap);
+
     m_tapeWidget = new TapeWidget(this);
-    if (m_tapeDocument) {
-        m_tapeWidget->setTape(m_tapeDocument->getTape());
-    }
     m_tapeWidget->setMinimumHeight(150);
     mainLayout->addWidget(m_tapeWidget, 1);
 
@@ -102,6 +137,19 @@ void TapeVisualizationView::setupUI()
     connect(resetZoomButton, &QPushButton::clicked, m_tapeWidget, &TapeWidget::resetZoom);
     buttonLayout->addWidget(resetZoomButton);
 
+    buttonLayout->addWidget(new QLabel(tr("Heatmap:"), this));
+    m_heatmapCombo = new QComboBox(this);
+    m_heatmapCombo->addItem(tr("Off"));
+    m_heatmapCombo->addItem(tr("Visits"));
+    m_heatmapCombo->addItem(tr("Writes"));
+    m_heatmapCombo->setToolTip(tr("Shade cells by how often the head visited them, or changed their symbol, during this run"));
+    connect(m_heatmapCombo, &QComboBox::currentIndexChanged, this, &TapeVisualizationView::onHeatmapModeChanged);
+    buttonLayout->addWidget(m_heatmapCombo);
+
+    m_exportHeatmapButton = new QPushButton(tr("Export Heatmap..."), this);
+    connect(m_exportHeatmapButton, &QPushButton::clicked, this, &TapeVisualizationView::exportHeatmap);
+    buttonLayout->addWidget(m_exportHeatmapButton);
+
     contentLayout->addLayout(buttonLayout);
     mainLayout->addWidget(contentGroup);
 
@@ -128,6 +176,17 @@ void TapeVisualizationView::setupUI()
     m_stepBackwardButton->setEnabled(false);
     controlsLayout->addWidget(m_stepBackwardButton);
 
+    m_traceButton = new QPushButton(tr("Record Trace"), this);
+    m_traceButton->setCheckable(true);
+    m_traceButton->setToolTip(tr("Record every step to a trace file for later analysis"));
+    connect(m_traceButton, &QPushButton::toggled, this, &TapeVisualizationView::toggleTraceRecording);
+    controlsLayout->addWidget(m_traceButton);
+
+    m_saveRunButton = new QPushButton(tr("Save Run"), this);
+    m_saveRunButton->setToolTip(tr("Save the project with the run so far, reopening it resumes the run"));
+    connect(m_saveRunButton, &QPushButton::clicked, this, &TapeVisualizationView::saveRunState);
+    controlsLayout->addWidget(m_saveRunButton);
+
     simulationLayout->addLayout(controlsLayout);
 
     // Speed slider
@@ -146,8 +205,47 @@ void TapeVisualizationView::setupUI()
             [speedValueLabel](int value) { speedValueLabel->setText(QString::number(value) + " ms"); });
     speedLayout->addWidget(speedValueLabel);
 
+    m_turboCheck = new QCheckBox(tr("Turbo"), this);
+    m_turboCheck->setToolTip(tr("Run as many steps per frame as the machine manages, showing only each frame's last step"));
+    connect(m_turboCheck, &QCheckBox::toggled, this, &TapeVisualizationView::onTurboToggled);
+    speedLayout->addWidget(m_turboCheck);
+
+    m_rateLimitSpin = new QSpinBox(this);
+    m_rateLimitSpin->setRange(0, 1000000000);
+    m_rateLimitSpin->setSingleStep(1000);
+    m_rateLimitSpin->setSuffix(tr(" steps/s"));
+    m_rateLimitSpin->setSpecialValueText(tr("No limit"));
+    m_rateLimitSpin->setToolTip(tr("Highest turbo rate"));
+    m_rateLimitSpin->setEnabled(false);
+    speedLayout->addWidget(m_rateLimitSpin);
+
+    m_rateLabel = new QLabel(this);
+    speedLayout->addWidget(m_rateLabel);
+
     simulationLayout->addLayout(speedLayout);
 
+    // Timeline of the run, drag to go back and forth through it
+    QHBoxLayout* timelineLayout = new QHBoxLayout();
+    m_timelineWidget = new TimelineWidget(this);
+    m_timelineWidget->setTimeline(m_tapeDocument ? m_tapeDocument->getTimeline() : nullptr);
+    m_timelineWidget->setContextMenuPolicy(Qt::ActionsContextMenu);
+    connect(m_timelineWidget, &TimelineWidget::scrubbed, this, &TapeVisualizationView::onTimelineScrubbed);
+    connect(m_timelineWidget, &TimelineWidget::released, this, &TapeVisualizationView::onTimelineReleased);
+    timelineLayout->addWidget(m_timelineWidget, 1);
+
+    QAction* markAction = new QAction(tr("Mark State..."), m_timelineWidget);
+    connect(markAction, &QAction::triggered, this, &TapeVisualizationView::markState);
+    m_timelineWidget->addAction(markAction);
+
+    QAction* clearMarksAction = new QAction(tr("Clear Marked States"), m_timelineWidget);
+    connect(clearMarksAction, &QAction::triggered, this, &TapeVisualizationView::clearMarkedStates);
+    m_timelineWidget->addAction(clearMarksAction);
+
+    m_timelineLabel = new QLabel(this);
+    timelineLayout->addWidget(m_timelineLabel);
+
+    simulationLayout->addLayout(timelineLayout);
+
     mainLayout->addWidget(simulationGroup);
 
     // Status label
@@ -156,11 +254,13 @@ void TapeVisualizationView::setupUI()
 
     // Connect tape signals
     connect(m_tapeWidget, &TapeWidget::tapeModified, this, &TapeVisualizationView::onTapeContentChanged);
+    connect(m_tapeWidget, &TapeWidget::viewportChanged, m_minimap, &TapeMinimap::setViewport);
+    connect(m_minimap, &TapeMinimap::cellClicked, m_tapeWidget, &TapeWidget::centerOnCell);
 }
 
 void TapeVisualizationView::updateFromDocument()
 {
-    if (!m_tapeDocument) return;
+    if (!m_tapeDocument || !m_shown) return;
 
     // Update header label
     QString headerText = tr("Tape: %1").arg(QString::fromStdString(m_tapeDocument->getName()));
@@ -175,6 +275,7 @@ void TapeVisualizationView::updateFromDocument()
     // Update the tape widget with the document's tape
     m_tapeWidget->setTape(m_tapeDocument->getTape());
     m_tapeWidget->updateTapeDisplay();
+    m_minimap->setTape(m_tapeDocument->getTape());
 
     // Update the content edit with the tape's content
     m_contentEdit->setText(QString::fromStdString(m_tapeDocument->getTape()->getCurrentContent()));
@@ -185,7 +286,24 @@ void TapeVisualizationView::updateFromDocument()
     // Update simulation controls
     updateSimulationControls();
 
-    setStatusMessage(tr("Tape loaded from document"));
+    // A reopened project continues a saved run
+    TuringMachine* machine = m_tapeDocument->getProject() ? m_tapeDocument->getProject()->getMachine() : nullptr;
+    m_minimap->setMachine(machine);
+    if (machine && machine->getStepCount() > 0) {
+        setStatusMessage(tr("Run at step %1").arg(machine->getStepCount()));
+    } else {
+        setStatusMessage(tr("Tape loaded from document"));
+    }
+}
+
+void TapeVisualizationView::showEvent(QShowEvent* event)
+{
+    DocumentView::showEvent(event);
+
+    if (!m_shown) {
+        m_shown = true;
+        updateFromDocument();
+    }
 }
 
 void TapeVisualizationView::setTapeContent()
@@ -240,7 +358,7 @@ void TapeVisualizationView::runSimulation()
     m_tapeDocument->run();
 
     // Start the timer to execute steps
-    m_simulationTimer->start(m_simulationSpeed);
+    startSimulationTimer();
 
     // Update UI
     m_runButton->setEnabled(false);
@@ -275,40 +393,36 @@ void TapeVisualizationView::stepForward()
     bool success = m_tapeDocument->step();
 
     if (success) {
-        m_tapeWidget->onStepExecuted();
-
-        // Ensure controls are updated AFTER step execution
-        QTimer::singleShot(0, this, &TapeVisualizationView::updateSimulationControls);
-
+        // The tape and controls follow with the document's next update
         setStatusMessage(tr("Step executed"));
-
-        // Make sure run button is enabled after a successful step
-        m_runButton->setEnabled(true);
-        m_stepForwardButton->setEnabled(true);
     } else {
         // Step failed, machine might have halted
         updateSimulationControls();
+        showHaltStatus();
+    }
+}
 
-        if (m_tapeDocument->getProject() && m_tapeDocument->getProject()->getMachine()) {
-            auto status = m_tapeDocument->getProject()->getMachine()->getStatus();
-
-            switch (status) {
-                case ExecutionStatus::HALTED_ACCEPT:
-                    setStatusMessage(tr("Machine halted: Accept state reached"));
-                break;
-                case ExecutionStatus::HALTED_REJECT:
-                    setStatusMessage(tr("Machine halted: Reject state reached"));
-                break;
-                case ExecutionStatus::ERROR:
-                    setStatusMessage(tr("Machine halted: No valid transition"), true);
-                break;
-                default:
-                    setStatusMessage(tr("Machine halted"), true);
-                break;
-            }
-        } else {
-            setStatusMessage(tr("Step execution failed"), true);
+void TapeVisualizationView::showHaltStatus()
+{
+    if (m_tapeDocument->getProject() && m_tapeDocument->getProject()->getMachine()) {
+        auto status = m_tapeDocument->getProject()->getMachine()->getStatus();
+
+        switch (status) {
+            case ExecutionStatus::HALTED_ACCEPT:
+                setStatusMessage(tr("Machine halted: Accept state reached"));
+            break;
+            case ExecutionStatus::HALTED_REJECT:
+                setStatusMessage(tr("Machine halted: Reject state reached"));
+            break;
+            case ExecutionStatus::ERROR:
+                setStatusMessage(tr("Machine halted: No valid transition"), true);
+            break;
+            default:
+                setStatusMessage(tr("Machine halted"), true);
+            break;
         }
+    } else {
+        setStatusMessage(tr("Step execution failed"), true);
     }
 }
 
@@ -318,11 +432,6 @@ void TapeVisualizationView::stepBackward()
 
     // Execute a backward step
     if (m_tapeDocument->stepBackward()) {
-        m_tapeWidget->onStepExecuted();
-
-        // Update UI based on execution state
-        updateSimulationControls();
-
         setStatusMessage(tr("Step undone"));
     } else {
         // Step back failed
@@ -333,8 +442,15 @@ void TapeVisualizationView::stepBackward()
 
 void TapeVisualizationView::onTapeContentChanged()
 {
+    // An edited tape is not where the run's keyframes lead any more
+    if (m_tapeDocument) {
+        m_tapeDocument->getTimeline()->clear();
+        updateTimeline();
+    }
+
     // Update tape display
     m_tapeWidget->updateTapeDisplay();
+    m_minimap->tapeChanged();
 
     // Mark as modified
     emit viewModified();
@@ -344,7 +460,7 @@ void TapeVisualizationView::onSimulationSpeed(int value)
 {
     m_simulationSpeed = value;
 
-    if (m_simulationTimer->isActive()) {
+    if (m_simulationTimer->isActive() && !m_turboCheck->isChecked()) {
         m_simulationTimer->setInterval(m_simulationSpeed);
     }
 
@@ -353,6 +469,11 @@ void TapeVisualizationView::onSimulationSpeed(int value)
 
 void TapeVisualizationView::onSimulationTimerTick()
 {
+    if (m_turboCheck->isChecked()) {
+        runTurboFrame();
+        return;
+    }
+
     // Execute a step during automatic simulation
     stepForward();
 
@@ -367,10 +488,317 @@ void TapeVisualizationView::onSimulationTimerTick()
     }
 }
 
-void TapeVisualizationView::onExecutionStateChanged()
+void TapeVisualizationView::startSimulationTimer()
+{
+    if (m_turboCheck->isChecked()) {
+        const qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+        m_simulationTimer->start(qMax(1, qRound(1000.0 / qMax<qreal>(1.0, refreshRate))));
+        m_turboBatch = TurboInitialBatch;
+        m_turboCredit = 0.0;
+        m_turboClock.start();
+        m_rateClock.start();
+        m_rateSteps = 0;
+    } else {
+        m_simulationTimer->start(m_simulationSpeed);
+        m_rateLabel->clear();
+    }
+}
+
+void TapeVisualizationView::onTurboToggled(bool enabled)
+{
+    m_rateLimitSpin->setEnabled(enabled);
+
+    // A running simulation switches over right away
+    if (m_simulationTimer->isActive()) {
+        startSimulationTimer();
+    }
+}
+
+void TapeVisualizationView::runTurboFrame()
+{
+    if (!m_tapeDocument) return;
+
+    uint64_t steps = m_turboBatch;
+
+    const int rateLimit = m_rateLimitSpin->value();
+    if (rateLimit > 0) {
+        // Steps owed since the last frame, never saving up more than a frame's worth
+        const double frameSteps = rateLimit * m_simulationTimer->interval() / 1000.0;
+        m_turboCredit = std::min(m_turboCredit + rateLimit * m_turboClock.restart() / 1000.0, frameSteps + 1.0);
+        steps = std::min(steps, static_cast<uint64_t>(m_turboCredit));
+        m_turboCredit -= static_cast<double>(steps);
+    }
+
+    QElapsedTimer frame;
+    frame.start();
+    const uint64_t taken = m_tapeDocument->runSteps(steps);
+    const qint64 elapsed = std::max<qint64>(1, frame.nsecsElapsed());
+
+    // Size the next batch to fill the budget at the rate these steps ran
+    if (taken == steps && steps > 0) {
+        const uint64_t fitting = static_cast<uint64_t>(static_cast<double>(steps) * TurboStepBudgetNs / elapsed);
+        m_turboBatch = std::clamp<uint64_t>(fitting, 1, m_turboBatch * TurboMaxGrowth);
+    }
+
+    m_rateSteps += taken;
+    if (m_rateClock.elapsed() >= RateInterval) {
+        m_rateLabel->setText(tr("%L1 steps/s").arg(qRound64(m_rateSteps * 1000.0 / m_rateClock.restart())));
+        m_rateSteps = 0;
+    }
+
+    if (taken < steps) {
+        m_simulationTimer->stop();
+        updateSimulationControls();
+        showHaltStatus();
+    }
+}
+
+void TapeVisualizationView::onExecutionStateChanged(const ExecutionDelta& delta)
 {
+    // All steps since the last update at once, only the last of them is painted
+    if ((delta.stepsTaken > 0 || delta.jumped) && !m_previewing) {
+        m_tapeWidget->onStepExecuted();
+    }
+
     // Update the UI based on the current execution state
     updateSimulationControls();
+    updateTimeline();
+}
+
+void TapeVisualizationView::toggleTraceRecording(bool enabled)
+{
+    if (!m_tapeDocument) return;
+
+    if (!enabled) {
+        uint64_t steps = m_tapeDocument->getTracedStepCount();
+        if (m_tapeDocument->stopTrace()) {
+            setStatusMessage(tr("Trace saved: %1 steps").arg(steps));
+        } else {
+            setStatusMessage(tr("Failed to write the trace file"), true);
+        }
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        tr("Record Trace"),
+        QString::fromStdString(m_tapeDocument->getName()),
+        tr("Execution Traces (*.tmtrace)")
+    );
+
+    // Add extension if missing
+    if (!filePath.isEmpty() && !filePath.endsWith(".tmtrace")) {
+        filePath += ".tmtrace";
+    }
+
+    if (filePath.isEmpty() || !m_tapeDocument->startTrace(filePath.toStdString())) {
+        QSignalBlocker blocker(m_traceButton);
+        m_traceButton->setChecked(false);
+        if (!filePath.isEmpty()) {
+            setStatusMessage(tr("Failed to start recording to %1").arg(filePath), true);
+        }
+        return;
+    }
+
+    setStatusMessage(tr("Recording trace to %1").arg(filePath));
+}
+
+void TapeVisualizationView::saveRunState()
+{
+    if (!m_tapeDocument || !m_tapeDocument->getProject()) return;
+
+    Project* project = m_tapeDocument->getProject();
+    if (project->getFilePath().empty()) {
+        QString filePath = QFileDialog::getSaveFileName(
+            this,
+            tr("Save Run"),
+            QString::fromStdString(project->getName()),
+            tr("Turing Machine Projects (*.tmproj)")
+        );
+
+        if (filePath.isEmpty()) return;
+
+        // Add extension if missing
+        if (!filePath.endsWith(".tmproj")) {
+            filePath += ".tmproj";
+        }
+
+        ProjectManager::getInstance().saveProjectAs(project, filePath.toStdString());
+    } else {
+        ProjectManager::getInstance().saveProject(project);
+    }
+
+    // The save works from a snapshot in the background, a running simulation keeps going
+    setStatusMessage(tr("Saving the run at step %1...").arg(project->getMachine()->getStepCount()));
+}
+
+void TapeVisualizationView::onHeatmapModeChanged(int index)
+{
+    Q_UNUSED(index);
+    applyHeatmap();
+}
+
+void TapeVisualizationView::applyHeatmap()
+{
+    if (!m_tapeDocument) return;
+
+    const int mode = m_heatmapCombo->currentIndex();
+    if (mode == 0) {
+        m_tapeWidget->setHeatmap(nullptr);
+        return;
+    }
+
+    const TapeHeatmap* heatmap = m_previewing ? m_tapeDocument->getTimeline()->getPreviewHeatmap()
+                                              : m_tapeDocument->getHeatmap();
+    m_tapeWidget->setHeatmap(heatmap, mode == 1 ? TapeHeatmap::Count::VISITS : TapeHeatmap::Count::WRITES);
+}
+
+void TapeVisualizationView::onTimelineScrubbed(quint64 step)
+{
+    if (!m_tapeDocument) return;
+
+    if (m_simulationTimer->isActive()) {
+        pauseSimulation();
+    }
+
+    RunTimeline* timeline = m_tapeDocument->getTimeline();
+    if (!timeline->preview(step)) return;
+
+    if (!m_previewing) {
+        m_previewing = true;
+        m_tapeWidget->setInteractiveMode(false);
+        m_tapeWidget->setTape(timeline->getPreviewTape());
+        applyHeatmap();
+    }
+    m_tapeWidget->updateTapeDisplay();
+    m_timelineLabel->setText(tr("Step %1 of %2").arg(step).arg(timeline->getLastStep()));
+}
+
+void TapeVisualizationView::onTimelineReleased(quint64 step)
+{
+    if (!m_tapeDocument) return;
+
+    if (m_simulationTimer->isActive()) {
+        pauseSimulation();
+    }
+
+    endPreview();
+    if (m_tapeDocument->seek(step)) {
+        setStatusMessage(tr("Moved to step %1").arg(step));
+    } else {
+        setStatusMessage(tr("Cannot move to step %1").arg(step), true);
+    }
+}
+
+void TapeVisualizationView::endPreview()
+{
+    if (!m_previewing) return;
+
+    m_previewing = false;
+    m_tapeWidget->setTape(m_tapeDocument->getTape());
+    m_tapeWidget->setInteractiveMode(true);
+    applyHeatmap();
+}
+
+void TapeVisualizationView::updateTimeline()
+{
+    if (!m_tapeDocument || m_timelineWidget->isScrubbing()) return;
+
+    const RunTimeline* timeline = m_tapeDocument->getTimeline();
+    if (timeline->isEmpty()) {
+        m_timelineLabel->clear();
+    } else {
+        m_timelineLabel->setText(tr("Step %1 of %2").arg(timeline->getPosition()).arg(timeline->getLastStep()));
+    }
+    m_timelineWidget->update();
+}
+
+void TapeVisualizationView::markState()
+{
+    if (!m_tapeDocument || !m_tapeDocument->getProject() || !m_tapeDocument->getProject()->getMachine()) return;
+
+    QStringList states;
+    m_tapeDocument->getProject()->getMachine()->forEachState([&states](const State* state) {
+        states.append(QString::fromStdString(state->getId()));
+    });
+    if (states.isEmpty()) return;
+
+    bool ok = false;
+    const QString chosen = QInputDialog::getItem(this, tr("Mark State"),
+                                                 tr("Mark the steps entering this state, or unmark it:"),
+                                                 states, 0, true, &ok);
+    if (!ok || chosen.isEmpty()) return;
+
+    // Marking replays the run to find the state's entries
+    RunTimeline* timeline = m_tapeDocument->getTimeline();
+    std::set<std::string> marked = timeline->getMarkedStates();
+    const std::string id = chosen.toStdString();
+    if (!marked.erase(id)) {
+        marked.insert(id);
+    }
+    timeline->setMarkedStates(marked);
+    updateTimeline();
+
+    setStatusMessage(marked.count(id) ? tr("Marked state %1").arg(chosen) : tr("Unmarked state %1").arg(chosen));
+}
+
+void TapeVisualizationView::clearMarkedStates()
+{
+    if (!m_tapeDocument) return;
+
+    m_tapeDocument->getTimeline()->setMarkedStates({});
+    updateTimeline();
+}
+
+void TapeVisualizationView::exportHeatmap()
+{
+    if (!m_tapeDocument) return;
+
+    const TapeHeatmap* heatmap = m_tapeDocument->getHeatmap();
+    if (heatmap->isEmpty()) {
+        setStatusMessage(tr("No steps were run on this tape yet"), true);
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Heatmap"),
+        QString::fromStdString(m_tapeDocument->getName()) + "-heatmap.csv",
+        tr("CSV Files (*.csv)")
+    );
+
+    if (filePath.isEmpty()) return;
+
+    if (!filePath.endsWith(".csv")) {
+        filePath += ".csv";
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        setStatusMessage(tr("Failed to open %1 for writing").arg(filePath), true);
+        return;
+    }
+
+    // One row per visited cell, written in chunks rather than per row
+    QByteArray chunk("position,visits,writes\n");
+    qint64 rows = 0;
+    heatmap->forEachCell([&](int position, uint32_t visits, uint32_t writes) {
+        chunk += QByteArray::number(position) + ',' + QByteArray::number(visits) + ','
+                 + QByteArray::number(writes) + '\n';
+        ++rows;
+        if (chunk.size() >= 64 * 1024) {
+            file.write(chunk);
+            chunk.clear();
+        }
+    });
+    file.write(chunk);
+
+    if (!file.commit()) {
+        setStatusMessage(tr("Failed to write %1").arg(filePath), true);
+        return;
+    }
+
+    setStatusMessage(tr("Exported the heatmap of %1 cells").arg(rows));
 }
 
 void TapeVisualizationView::updateSimulationControls()
@@ -386,19 +814,21 @@ void TapeVisualizationView::updateSimulationControls()
     auto machine = m_tapeDocument->getProject()->getMachine();
     auto status = machine->getStatus();
 
-    qDebug() << "Machine status:" << static_cast<int>(status);
+    // The machine is paused between the steps of a run, the timer tells a run apart
+    bool running = status == ExecutionStatus::RUNNING || m_simulationTimer->isActive();
+    bool canStep = !running && (status == ExecutionStatus::READY || status == ExecutionStatus::PAUSED);
 
     // Always enable step forward for READY and PAUSED states
-    m_stepForwardButton->setEnabled(status == ExecutionStatus::READY || status == ExecutionStatus::PAUSED);
+    m_stepForwardButton->setEnabled(canStep);
 
     // Enable/disable Run button
-    m_runButton->setEnabled(status == ExecutionStatus::READY || status == ExecutionStatus::PAUSED);
+    m_runButton->setEnabled(canStep);
 
     // Enable/disable Pause button
-    m_pauseButton->setEnabled(status == ExecutionStatus::RUNNING);
+    m_pauseButton->setEnabled(running);
 
     // Enable/disable Step Backward button
-    m_stepBackwardButton->setEnabled(m_tapeDocument->canStepBackward());
+    m_stepBackwardButton->setEnabled(!running && m_tapeDocument->canStepBackward());
 }
 
 void TapeVisualizationView::setStatusMessage(const QString& message, bool isError)
@@ -1,15 +1,22 @@
 #pragma once
 
 #include "DocumentView.h"
+#include <cstdint>
 #include <memory>
+#include <QElapsedTimer>
 
 class TapeDocument;
+struct ExecutionDelta;
 class TapeWidget;
+class TapeMinimap;
+class TimelineWidget;
 class QPushButton;
 class QLineEdit;
 class QSpinBox;
 class QLabel;
 class QTimer;
+class QCheckBox;
+class QComboBox;
 
 /**
  * View for visualizing and running a tape
@@ -25,6 +32,10 @@ public:
     // Update view from document
     void updateFromDocument() override;
 
+protected:
+    // The tape is only read once the view is first shown
+    void showEvent(QShowEvent* event) override;
+
     private slots:
         void setTapeContent();
     void resetTape();
@@ -35,13 +46,23 @@ public:
     void onTapeContentChanged();
     void onSimulationSpeed(int value);
     void onSimulationTimerTick();
-    void onExecutionStateChanged();
+    void onTurboToggled(bool enabled);
+    void onExecutionStateChanged(const ExecutionDelta& delta);
+    void toggleTraceRecording(bool enabled);
+    void saveRunState();
+    void onHeatmapModeChanged(int index);
+    void exportHeatmap();
+    void onTimelineScrubbed(quint64 step);
+    void onTimelineReleased(quint64 step);
+    void markState();
+    void clearMarkedStates();
 
 private:
     TapeDocument* m_tapeDocument;
 
     // UI components
     TapeWidget* m_tapeWidget;
+    TapeMinimap* m_minimap;
     QLineEdit* m_contentEdit;
     QSpinBox* m_headPositionSpin;
     QPushButton* m_setButton;
@@ -50,11 +71,38 @@ private:
     QPushButton* m_pauseButton;
     QPushButton* m_stepForwardButton;
     QPushButton* m_stepBackwardButton;
+    QPushButton* m_traceButton;
+    QPushButton* m_saveRunButton;
+    QComboBox* m_heatmapCombo;
+    QPushButton* m_exportHeatmapButton;
     QLabel* m_statusLabel;
+
+    // Timeline of the run; while it is dragged the tape widget shows the
+    // timeline's preview of a step instead of the document's tape
+    TimelineWidget* m_timelineWidget;
+    QLabel* m_timelineLabel;
+    bool m_previewing;
     QTimer* m_simulationTimer;
     int m_simulationSpeed;
+    bool m_shown;
+
+    // Turbo runs as many steps per frame as fit in the frame's time budget
+    QCheckBox* m_turboCheck;
+    QSpinBox* m_rateLimitSpin;  // Steps per second, 0 for no limit
+    QLabel* m_rateLabel;
+    uint64_t m_turboBatch;      // Steps the next frame runs, adapted to how long steps take
+    double m_turboCredit;       // Steps the rate limit allows that were not run yet
+    QElapsedTimer m_turboClock;
+    QElapsedTimer m_rateClock;
+    uint64_t m_rateSteps;       // Steps since m_rateClock started
 
     void setupUI();
+    void startSimulationTimer();
+    void runTurboFrame();
+    void showHaltStatus();
+    void applyHeatmap();
+    void updateTimeline();
+    void endPreview();
     void updateSimulationControls();
     void setStatusMessage(const QString& message, bool isError = false);
 };
\ No newline at end of file